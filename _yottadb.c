@@ -2,7 +2,7 @@
  *                                                              *
  * Copyright (c) 2019-2021 Peter Goss All rights reserved.      *
  *                                                              *
- * Copyright (c) 2019-2025 YottaDB LLC and/or its subsidiaries. *
+ * Copyright (c) 2019-2026 YottaDB LLC and/or its subsidiaries. *
  * All rights reserved.                                         *
  *                                                              *
  *  This source code contains the intellectual property         *
@@ -14,10 +14,14 @@
 
 #define _POSIX_C_SOURCE 200809L // Provide access to strnlen, per https://man7.org/linux/man-pages/man7/feature_test_macros.7.html
 #include <string.h>
+#include <ctype.h>
 #include <assert.h>
 #include <stdbool.h>
 #include <stdarg.h>
 #include <pthread.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
 
@@ -51,6 +55,72 @@ typedef struct {
 // Initialize a global struct to store call-in information
 py_ci_name_descriptor ci_info = {.routine_name = NULL, .has_parm_types = FALSE, .ci_info = {.handle = NULL}};
 
+/* Key for a per-thread ydb_buffer_t that is reused across calls to receive single values from YottaDB,
+ * e.g. by get(). The buffer is grown to the largest value the thread has received so far, so that once
+ * warmed up each call makes a single YottaDB call instead of repeating it after YDB_ERR_INVSTRLEN.
+ * The buffer is allocated on first use by get_value_buffer() and freed by free_value_buffer() when the
+ * thread exits.
+ */
+static pthread_key_t value_buffer_key;
+
+/* Key for the per-thread YDBSubsBuffers that are reused across calls to receive subscripts from YottaDB,
+ * e.g. by node_next(). Like the value buffer, each subscript buffer keeps the largest size it has been grown
+ * to, so that once warmed up each call makes a single YottaDB call. Allocated on first use by get_subs_buffers()
+ * and freed by free_subs_buffers() when the thread exits.
+ */
+static pthread_key_t subs_buffers_key;
+
+/* Number of YottaDB calls repeated due to YDB_ERR_INVSTRLEN, i.e. because a result buffer was too short.
+ * Only updated while holding the GIL. Reported by buffer_stats().
+ */
+static unsigned long long invstrlen_retries = 0;
+
+/* Whether YottaDB is called through the threaded API, as selected by enable_threads(). YottaDB does not allow a process
+ * to use both the Simple API and the threaded API, so `simple_api_used` records whether it is too late to switch.
+ * Both are only accessed while holding the GIL.
+ */
+static bool threaded_api = FALSE;
+static bool simple_api_used = FALSE;
+
+/* Whether YottaDB calls are counted, as selected by enable_stats(), and the resulting counters for each operation, as
+ * reported by stats(). Like the above, these are only accessed while holding the GIL.
+ */
+static bool	  stats_enabled = FALSE;
+static YDBOpStats op_stats[YDBPY_NUM_OPS];
+
+/* Counters for the calls to tp() made while stats are enabled, one entry per transid, as reported by tp_stats().
+ * Only accessed while holding the GIL.
+ */
+static YDBTPStats * tp_stats_entries = NULL;
+static unsigned int tp_stats_used = 0;
+static unsigned int tp_stats_allocated = 0;
+
+/* Whether YottaDB calls slower than `trace_threshold_ns` are recorded, as selected by enable_trace(), in the ring buffer
+ * of `trace_size` entries drained by drain_trace(). `trace_next` is the index of the entry to fill next and `trace_used`
+ * the number of entries filled since the last drain, excluding the `trace_dropped` oldest ones that were overwritten.
+ * `trace_recorded` counts all entries ever filled, so that drain_trace() can tell which were filled while it ran.
+ * Rather than being lock-free, the ring buffer is serialized by the GIL, which is held whenever it is accessed.
+ */
+static bool		  trace_enabled = FALSE;
+static unsigned long long trace_threshold_ns;
+static YDBTraceEntry *	  trace_entries = NULL;
+static unsigned long	  trace_size = 0;
+static unsigned long	  trace_next = 0;
+static unsigned long	  trace_used = 0;
+static unsigned long long trace_dropped = 0;
+static unsigned long long trace_recorded = 0;
+
+/* Whether YottaDB calls are timed, i.e. either of the above is enabled. Tested by YDBPY_CALL_COUNTED() on each call. */
+static bool calls_timed = FALSE;
+
+#define YDBPY_OP_NAME(NAME) #NAME,
+static const char *op_names[YDBPY_NUM_OPS] = {YDBPY_FOR_EACH_OP(YDBPY_OP_NAME)};
+
+/* State of the calling thread for the threaded API. This holds no allocated storage, so unlike the reusable buffers
+ * above it needs no destructor and is simply thread-local.
+ */
+static __thread YDBThreadState thread_state = {.tptoken = YDB_NOTTP};
+
 /* Counts the total number of arguments between two integer bitmaps,
  * one representing input arguments and another representing output
  * arguments by bitwise ORing the two integers together and ANDing
@@ -121,29 +191,36 @@ static void raise_ValidationError(YDBPythonErrorType err_type, char *format_pref
 	}
 }
 
-/* Convert a PyObject referencing a Python `bytes` or `str` object to a ydb_buffer_t struct
- * and validate the size of resulting buffer to enforce YottaDB variable name and value limits.
+/* Point a ydb_buffer_t struct at the contents of a PyObject referencing a Python `bytes` or `str` object,
+ * without copying them, and validate the size of resulting buffer to enforce YottaDB variable name and value limits.
  * If set, the `is_varname` flag signals that the object should be validated as a variable,
  * otherwise the object will be validated as a value.
+ *
+ * On success, `owner` is set to a new reference to the bytes object holding the buffer contents: `object` itself
+ * for `bytes`, or the result of encoding `object` for `str`. The buffer is only valid for as long as this
+ * reference is held, so the caller must Py_DECREF `owner` once YottaDB no longer needs the buffer. Since the
+ * buffer belongs to an immutable Python object, it must only be passed to YottaDB as an input and never freed.
  */
-static int anystr_to_buffer(PyObject *object, ydb_buffer_t *buffer, bool is_varname) {
-	char *	     bytes;
-	bool	     decref_object;
+static int anystr_to_borrowed_buffer(PyObject *object, ydb_buffer_t *buffer, bool is_varname, PyObject **owner) {
 	Py_ssize_t   bytes_ssize;
 	unsigned int bytes_len;
-	int	     done;
+	char *	     bytes;
 
 	if (PyUnicode_Check(object)) {
 		// Convert Unicode object into Python bytes object
 		object = PyUnicode_AsEncodedString(object, "cp1251", "strict"); // New reference
 		if (NULL == object) {
-			PyErr_SetString(YDBPythonError, "failed to encode Unicode string to bytes object");
+			/* The cp1251 codec may run Python code, so a pending signal such as SIGINT can surface here.
+			 * Only report actual encoding failures as such, and let any other exception propagate.
+			 */
+			if (PyErr_ExceptionMatches(PyExc_UnicodeError)) {
+				PyErr_SetString(YDBPythonError, "failed to encode Unicode string to bytes object");
+			}
 			return !YDB_OK;
 		}
-		decref_object = TRUE;
 	} else if (PyBytes_Check(object)) {
 		// Object is a bytes object, no Unicode encoding needed
-		decref_object = FALSE;
+		Py_INCREF(object);
 	} else {
 		/* Object is not bytes or str (Unicode), but one of these types was expected.
 		 * So, raise an exception.
@@ -152,8 +229,7 @@ static int anystr_to_buffer(PyObject *object, ydb_buffer_t *buffer, bool is_varn
 		return !YDB_OK;
 	}
 
-	// Convert Python bytes object to C character string (char *)
-	bytes_ssize = PyBytes_Size(object);
+	bytes_ssize = PyBytes_GET_SIZE(object);
 	if (INT32_MAX < bytes_ssize) {
 		/* Python bytes objects may have more bytes than can be represented by a 32-bit unsigned integer.
 		 * If `object` is 1 more than INT32_MAX, `bytes_len` below would be set to 0, falsely indicating a
@@ -165,47 +241,103 @@ static int anystr_to_buffer(PyObject *object, ydb_buffer_t *buffer, bool is_varn
 		} else {
 			raise_ValidationError(YDBPython_ValueError, NULL, YDBPY_ERR_BYTES_TOO_LONG, bytes_ssize, YDB_MAX_STR);
 		}
-		if (decref_object) {
-			// Optionally cleanup new reference
-			Py_DECREF(object);
-		}
-		return !YDB_OK;
-	}
-	bytes_len = Py_SAFE_DOWNCAST(bytes_ssize, Py_ssize_t, unsigned int);
-	bytes = PyBytes_AsString(object);
-
-	// Allocate and populate YDB buffer
-	YDB_MALLOC_BUFFER(buffer, bytes_len + 1); // Null terminator used in some scenarios
-	YDB_COPY_BYTES_TO_BUFFER(bytes, bytes_len, buffer, done);
-	buffer->buf_addr[buffer->len_used] = '\0';
-
-	// Optionally cleanup new reference
-	if (decref_object) {
 		Py_DECREF(object);
-	}
-
-	// Defer error emission until after optional cleanup to reduce duplication
-	if (!done) {
-		PyErr_SetString(YDBPythonError, "failed to copy bytes object to buffer array");
-		YDB_FREE_BUFFER(buffer);
 		return !YDB_OK;
 	}
+	bytes_len = Py_SAFE_DOWNCAST(bytes_ssize, Py_ssize_t, unsigned int);
+	// Python bytes objects are always null terminated, so bytes[0] may be safely checked even for empty strings
+	bytes = PyBytes_AS_STRING(object);
 
 	/* Enforce variable name length limit, i.e. YDB_MAX_IDENT for locals and YDB_MAX_IDENT + 1 for globals.
 	 * YDB_MAX_IDENT + 1 is acceptable for global variable names, since '^' does not count toward variable
 	 * name length. If the variable name is too long, raise an exception.
 	 */
 	if (is_varname) {
-		if ((('^' == buffer->buf_addr[0]) && ((YDB_MAX_IDENT + 1) < buffer->len_used))
-		    || (('^' != buffer->buf_addr[0]) && ((YDB_MAX_IDENT) < buffer->len_used))) {
-			raise_ValidationError(YDBPython_ValueError, NULL, YDBPY_ERR_VARNAME_TOO_LONG, buffer->len_used,
-					      YDB_MAX_IDENT);
-			YDB_FREE_BUFFER(buffer);
+		if ((('^' == bytes[0]) && ((YDB_MAX_IDENT + 1) < bytes_len))
+		    || (('^' != bytes[0]) && ((YDB_MAX_IDENT) < bytes_len))) {
+			raise_ValidationError(YDBPython_ValueError, NULL, YDBPY_ERR_VARNAME_TOO_LONG, bytes_len, YDB_MAX_IDENT);
+			Py_DECREF(object);
 			return !YDB_OK;
 		}
-	} else if ((YDB_MAX_STR) < buffer->len_used) {
+	} else if ((YDB_MAX_STR) < bytes_len) {
 		// This is a value and not a variable, so accept up to YDB_MAX_STR length
-		raise_ValidationError(YDBPython_ValueError, NULL, YDBPY_ERR_VARNAME_TOO_LONG, buffer->len_used, YDB_MAX_IDENT);
+		raise_ValidationError(YDBPython_ValueError, NULL, YDBPY_ERR_BYTES_TOO_LONG, bytes_len, YDB_MAX_STR);
+		Py_DECREF(object);
+		return !YDB_OK;
+	}
+
+	buffer->buf_addr = bytes;
+	buffer->len_used = bytes_len;
+	buffer->len_alloc = bytes_len;
+	*owner = object;
+	return YDB_OK;
+}
+
+/* Point a ydb_buffer_t struct at the string form of an increment for ydb_incr_s(), as accepted by yottadb.incr().
+ * int and float increments are converted to their string form, and bytes increments are converted through float
+ * to guarantee a valid numeric value. A NULL `increment` results in the default increment of 1.
+ *
+ * On success, `owner` is set as by anystr_to_borrowed_buffer(), or to NULL for the default increment, and must be
+ * released with Py_XDECREF once the buffer is no longer needed. On failure, an exception is raised.
+ */
+static bool increment_to_borrowed_buffer(PyObject *increment, ydb_buffer_t *buffer, PyObject **owner) {
+	int	  status;
+	PyObject *increment_str;
+
+	if (NULL == increment) {
+		YDB_LITERAL_TO_BUFFER("1", buffer);
+		*owner = NULL;
+		return TRUE;
+	}
+	if (PyUnicode_Check(increment)) {
+		increment_str = increment;
+		Py_INCREF(increment_str);
+	} else if (PyBytes_Check(increment)) {
+		PyObject *increment_float;
+
+		increment_float = PyFloat_FromString(increment); // New Reference
+		if (NULL == increment_float) {
+			return FALSE;
+		}
+		increment_str = PyObject_Str(increment_float); // New Reference
+		Py_DECREF(increment_float);
+	} else if (PyLong_Check(increment) || PyFloat_Check(increment)) {
+		increment_str = PyObject_Str(increment); // New Reference
+	} else {
+		PyErr_SetString(PyExc_TypeError, YDBPY_ERR_INCR_TYPE);
+		return FALSE;
+	}
+	if (NULL == increment_str) {
+		return FALSE;
+	}
+	status = anystr_to_borrowed_buffer(increment_str, buffer, FALSE, owner);
+	Py_DECREF(increment_str);
+	return (YDB_OK == status);
+}
+
+/* Convert a PyObject referencing a Python `bytes` or `str` object to a newly allocated ydb_buffer_t struct,
+ * validated as described for anystr_to_borrowed_buffer() above. Used where the buffer must outlive the Python
+ * object or be modified; otherwise anystr_to_borrowed_buffer() avoids the allocation and copy. The caller must
+ * free the buffer with YDB_FREE_BUFFER.
+ */
+static int anystr_to_buffer(PyObject *object, ydb_buffer_t *buffer, bool is_varname) {
+	ydb_buffer_t borrowed;
+	PyObject *   owner;
+	int	     done;
+
+	if (YDB_OK != anystr_to_borrowed_buffer(object, &borrowed, is_varname, &owner)) {
+		return !YDB_OK;
+	}
+
+	// Allocate and populate YDB buffer
+	YDB_MALLOC_BUFFER(buffer, borrowed.len_used + 1); // Null terminator used in some scenarios
+	YDB_COPY_BYTES_TO_BUFFER(borrowed.buf_addr, borrowed.len_used, buffer, done);
+	buffer->buf_addr[buffer->len_used] = '\0';
+	Py_DECREF(owner);
+
+	// Defer error emission until after cleanup to reduce duplication
+	if (!done) {
+		PyErr_SetString(YDBPythonError, "failed to copy bytes object to buffer array");
 		YDB_FREE_BUFFER(buffer);
 		return !YDB_OK;
 	}
@@ -313,23 +445,428 @@ static int object_to_ydb_string_t(PyObject *object, ydb_string_t *buffer) {
 }
 
 /* Local Utility Functions */
-/* Routine to create an array of empty ydb_buffer_ts with num elements each with
- * an allocated length of len
+/* Destructor for the per-thread value buffer, called by pthreads on thread exit */
+static void free_value_buffer(void *value_buffer) {
+	YDB_FREE_BUFFER((ydb_buffer_t *)value_buffer);
+	free(value_buffer);
+}
+
+/* Returns the calling thread's reusable value buffer, allocating it on the first call in each thread.
+ * On failure, returns NULL with a Python exception raised.
  *
- * Parameters:
- *   num    - the number of buffers to allocate in the array
- *   len    - the length of the string to allocate for each of the the ydb_buffer_ts
+ * The buffer must only be used for the duration of a single call from Python, and never while
+ * Python code that may itself call into this module runs, e.g. a tp() callback.
+ */
+static ydb_buffer_t *get_value_buffer(void) {
+	ydb_buffer_t *value_buffer;
+	int	      status;
+
+	value_buffer = pthread_getspecific(value_buffer_key);
+	if (NULL == value_buffer) {
+		value_buffer = malloc(sizeof(ydb_buffer_t));
+		if (NULL == value_buffer) {
+			PyErr_NoMemory();
+			return NULL;
+		}
+		YDB_MALLOC_BUFFER(value_buffer, YDBPY_DEFAULT_VALUE_LEN);
+		status = pthread_setspecific(value_buffer_key, value_buffer);
+		if (0 != status) {
+			free_value_buffer(value_buffer);
+			raise_ValidationError(YDBPython_OSError, NULL, YDBPY_ERR_SYSCALL, "pthread_setspecific", status,
+					      strerror(status));
+			return NULL;
+		}
+	}
+	return value_buffer;
+}
+
+/* Grow a reusable buffer after YottaDB returned YDB_ERR_INVSTRLEN, in which case `len_used` holds the
+ * length that was needed. The new size is rounded up to the next power of two, so that a series of
+ * slightly longer values does not cause a retry for each one. Since YDB_MAX_STR is itself a power of
+ * two, this never exceeds the maximum length of a YottaDB string.
+ */
+static void grow_value_buffer(ydb_buffer_t *value_buffer) {
+	unsigned int len;
+
+	invstrlen_retries++;
+	len = YDBPY_DEFAULT_VALUE_LEN;
+	while (len < value_buffer->len_used) {
+		len *= 2;
+	}
+	YDB_FREE_BUFFER(value_buffer);
+	YDB_MALLOC_BUFFER(value_buffer, len);
+}
+
+/* Returns the calling thread's error string buffer for a call through the threaded API, emptied of any message left
+ * by a previous call.
+ */
+static ydb_buffer_t *reset_errstr(void) {
+	thread_state.errstr.buf_addr = thread_state.errstr_buf;
+	thread_state.errstr.len_alloc = YDB_MAX_ERRORMSG;
+	thread_state.errstr.len_used = 0;
+	return &thread_state.errstr;
+}
+
+/* Current time in nanoseconds, for timing YottaDB calls */
+static unsigned long long stats_clock(void) {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((unsigned long long)now.tv_sec * 1000000000ULL) + (unsigned long long)now.tv_nsec;
+}
+
+/* Index of the latency histogram bucket holding `elapsed_ns`. Values below YDBPY_STATS_SUB_BUCKETS each have a bucket,
+ * above which each power of two is split into YDBPY_STATS_SUB_BUCKETS buckets by the bits following the leading one.
+ */
+static unsigned int latency_bucket(unsigned long long elapsed_ns) {
+	unsigned int exponent, bucket;
+
+	if (YDBPY_STATS_SUB_BUCKETS > elapsed_ns)
+		return (unsigned int)elapsed_ns;
+	exponent = (sizeof(elapsed_ns) * 8) - 1 - __builtin_clzll(elapsed_ns);
+	bucket = ((exponent - YDBPY_STATS_SUB_BUCKET_BITS + 1) * YDBPY_STATS_SUB_BUCKETS)
+		 + ((elapsed_ns >> (exponent - YDBPY_STATS_SUB_BUCKET_BITS)) & (YDBPY_STATS_SUB_BUCKETS - 1));
+	return (YDBPY_STATS_LATENCY_BUCKETS > bucket) ? bucket : YDBPY_STATS_LATENCY_BUCKETS - 1;
+}
+
+/* Smallest number of nanoseconds held by latency histogram bucket `bucket`, the inverse of latency_bucket() */
+static unsigned long long latency_bucket_start(unsigned int bucket) {
+	unsigned int exponent;
+
+	if (YDBPY_STATS_SUB_BUCKETS > bucket)
+		return bucket;
+	exponent = (bucket / YDBPY_STATS_SUB_BUCKETS) + YDBPY_STATS_SUB_BUCKET_BITS - 1;
+	return (unsigned long long)(YDBPY_STATS_SUB_BUCKETS + (bucket % YDBPY_STATS_SUB_BUCKETS))
+	       << (exponent - YDBPY_STATS_SUB_BUCKET_BITS);
+}
+
+/* Record a call to YottaDB made for operation `op` in the counters reported by stats() */
+static void record_call_stats(YDBPyOp op, int status, unsigned long long elapsed_ns, unsigned long long bytes_in,
+			      unsigned long long bytes_out) {
+	YDBOpStats *stats;
+
+	stats = &op_stats[op];
+	stats->calls++;
+	stats->bytes_in += bytes_in;
+	stats->bytes_out += bytes_out;
+	stats->total_ns += elapsed_ns;
+	stats->latency[latency_bucket(elapsed_ns)]++;
+	if (YDB_OK == status)
+		return;
+	stats->errors++;
+	// Count the first few distinct error codes individually, which leaves any others only in the total
+	for (unsigned int i = 0; i < YDBPY_STATS_MAX_STATUSES; i++) {
+		if (0 == stats->status_counts[i]) {
+			stats->statuses[i] = status;
+		}
+		if (status == stats->statuses[i]) {
+			stats->status_counts[i]++;
+			break;
+		}
+	}
+}
+
+/* Record a call to YottaDB made for operation `op` on the node given by `varname`, `subs_used` and `subsarray`, if any,
+ * in the ring buffer drained by drain_trace(), overwriting the oldest entry if it is full.
+ */
+static void record_trace(YDBPyOp op, int status, unsigned long long elapsed_ns, ydb_buffer_t *varname, int subs_used,
+			 ydb_buffer_t *subsarray) {
+	YDBTraceEntry * entry;
+	struct timespec now;
+	unsigned int	len, subs_len;
+
+	entry = &trace_entries[trace_next];
+	trace_next = (trace_next + 1) % trace_size;
+	trace_recorded++;
+	if (trace_used < trace_size) {
+		trace_used++;
+	} else {
+		trace_dropped++;
+	}
+	clock_gettime(CLOCK_REALTIME, &now);
+	entry->op = op;
+	entry->status = status;
+	entry->duration_ns = elapsed_ns;
+	entry->time_ns = ((unsigned long long)now.tv_sec * 1000000000ULL) + (unsigned long long)now.tv_nsec;
+	entry->varname_len = 0;
+	entry->subs_used = 0;
+	entry->subs_truncated = FALSE;
+	if (NULL == varname)
+		return;
+	entry->varname_len = (sizeof(entry->varname) < varname->len_used) ? sizeof(entry->varname) : varname->len_used;
+	memcpy(entry->varname, varname->buf_addr, entry->varname_len);
+	// Keep as many subscripts as fit, the last of which may be cut short
+	subs_len = 0;
+	for (int i = 0; (i < subs_used) && (subs_len < YDBPY_TRACE_SUBS_LEN); i++) {
+		len = subsarray[i].len_used;
+		if (YDBPY_TRACE_SUBS_LEN - subs_len < len) {
+			len = YDBPY_TRACE_SUBS_LEN - subs_len;
+			entry->subs_truncated = TRUE;
+		}
+		memcpy(entry->subs + subs_len, subsarray[i].buf_addr, len);
+		entry->subs_lens[i] = len;
+		subs_len += len;
+		entry->subs_used++;
+	}
+	if (entry->subs_used < subs_used) {
+		entry->subs_truncated = TRUE;
+	}
+}
+
+/* Record a call to YottaDB timed by YDBPY_CALL_COUNTED() in the counters reported by stats() and, if it took at least the
+ * threshold set by enable_trace(), in the ring buffer drained by drain_trace(). Must be called while holding the GIL.
+ */
+static void record_call(YDBPyOp op, int status, unsigned long long elapsed_ns, unsigned long long bytes_in,
+			unsigned long long bytes_out, ydb_buffer_t *varname, int subs_used, ydb_buffer_t *subsarray) {
+	if (stats_enabled) {
+		record_call_stats(op, status, elapsed_ns, bytes_in, bytes_out);
+	}
+	if (trace_enabled && (trace_threshold_ns <= elapsed_ns)) {
+		record_trace(op, status, elapsed_ns, varname, subs_used, subsarray);
+	}
+}
+
+/* Call a variadic YottaDB function with the arguments in `arg_values`, using `threaded_func` in threaded mode. In that
+ * case, as for YDBPY_CALL(), the calling thread's tptoken and error string buffer are inserted ahead of the other
+ * arguments, for which `arg_values` must have room, and the GIL is released for the duration of the call. The call is
+ * counted under operation `op` by stats().
+ */
+static int call_variadic_plist_func(YDBPyOp op, ydb_vplist_func simple_func, ydb_vplist_func threaded_func,
+				    gparam_list *arg_values) {
+	int status;
+
+	if (threaded_api) {
+		assert(YDB_CALL_VARIADIC_MAX_ARGUMENTS >= (arg_values->n + YDBPY_THREADED_ARGS));
+		memmove(&arg_values->arg[YDBPY_THREADED_ARGS], &arg_values->arg[0], arg_values->n * sizeof(void *));
+		arg_values->arg[0] = (void *)(uintptr_t)thread_state.tptoken;
+		arg_values->n += YDBPY_THREADED_ARGS;
+	}
+	// The error string buffer is only reset by YDBPY_CALL_API(), so is passed as the second argument there
+	YDBPY_CALL_COUNTED(status, op, ydb_call_variadic_plist_func(threaded_func, (arg_values->arg[1] = errstr, arg_values)),
+			   ydb_call_variadic_plist_func(simple_func, arg_values), YDBPY_NO_BYTES, YDBPY_NO_KEY);
+	return status;
+}
+
+static void free_subs_buffers(void *subs_buffers) {
+	YDBSubsBuffers *buffers;
+
+	buffers = (YDBSubsBuffers *)subs_buffers;
+	for (int i = 0; i < 2; i++) {
+		for (int j = 0; j < YDB_MAX_SUBS; j++) {
+			YDB_FREE_BUFFER(&buffers->arrays[i][j]);
+		}
+	}
+	free(buffers);
+}
+
+/* Returns the calling thread's reusable subscript buffers, allocating them on the first call in each thread.
+ * On failure, returns NULL with a Python exception raised. The same restrictions apply as for get_value_buffer().
+ */
+static YDBSubsBuffers *get_subs_buffers(void) {
+	YDBSubsBuffers *subs_buffers;
+	int		status;
+
+	subs_buffers = pthread_getspecific(subs_buffers_key);
+	if (NULL == subs_buffers) {
+		subs_buffers = malloc(sizeof(YDBSubsBuffers));
+		if (NULL == subs_buffers) {
+			PyErr_NoMemory();
+			return NULL;
+		}
+		for (int i = 0; i < 2; i++) {
+			for (int j = 0; j < YDB_MAX_SUBS; j++) {
+				YDB_MALLOC_BUFFER(&subs_buffers->arrays[i][j], YDBPY_DEFAULT_SUBSCRIPT_LEN);
+			}
+		}
+		status = pthread_setspecific(subs_buffers_key, subs_buffers);
+		if (0 != status) {
+			free_subs_buffers(subs_buffers);
+			raise_ValidationError(YDBPython_OSError, NULL, YDBPY_ERR_SYSCALL, "pthread_setspecific", status,
+					      strerror(status));
+			return NULL;
+		}
+	}
+	return subs_buffers;
+}
+
+/* Convert a single argument passed to a METH_FASTCALL wrapper according to the format character
+ * `code`, storing the result at the location(s) taken from `vargs`. The supported codes are the
+ * subset of PyArg_ParseTupleAndKeywords() format units used by the wrappers in this file:
+ *     O  - PyObject *, borrowed reference
+ *     i  - int, with overflow checking
+ *     k  - unsigned long, without overflow checking
+ *     K  - unsigned long long, without overflow checking
+ *     p  - int, set to the truth value of the object
+ *     s  - const char *, from a str object without embedded NUL characters
+ *     s# - const char * and Py_ssize_t length, from a str or bytes object
+ *
+ * Returns TRUE on success, or FALSE with a Python exception raised.
+ */
+static bool convert_fastcall_arg(PyObject *object, const char *code, const char *fname, const char *argname, va_list *vargs) {
+	switch (*code) {
+	case 'O':
+		*va_arg(*vargs, PyObject **) = object;
+		break;
+	case 'i': {
+		long	  value;
+		PyObject *index;
+
+		index = PyNumber_Index(object); // New Reference
+		if (NULL == index) {
+			PyErr_Clear();
+			PyErr_Format(PyExc_TypeError, YDBPY_ERR_ARGUMENT_TYPE, fname, argname, "int", Py_TYPE(object)->tp_name);
+			return FALSE;
+		}
+		value = PyLong_AsLong(index);
+		Py_DECREF(index);
+		if ((-1 == value) && (NULL != PyErr_Occurred())) {
+			return FALSE;
+		}
+		if (INT_MAX < value) {
+			PyErr_SetString(PyExc_OverflowError, YDBPY_ERR_INT_TOO_LARGE);
+			return FALSE;
+		} else if (INT_MIN > value) {
+			PyErr_SetString(PyExc_OverflowError, YDBPY_ERR_INT_TOO_SMALL);
+			return FALSE;
+		}
+		*va_arg(*vargs, int *) = (int)value;
+		break;
+	}
+	case 'k':
+	case 'K':
+		if (!PyLong_Check(object)) {
+			PyErr_Format(PyExc_TypeError, YDBPY_ERR_ARGUMENT_TYPE, fname, argname, "int", Py_TYPE(object)->tp_name);
+			return FALSE;
+		}
+		if ('k' == *code) {
+			*va_arg(*vargs, unsigned long *) = PyLong_AsUnsignedLongMask(object);
+		} else {
+			*va_arg(*vargs, unsigned long long *) = PyLong_AsUnsignedLongLongMask(object);
+		}
+		break;
+	case 'p': {
+		int truth;
+
+		truth = PyObject_IsTrue(object);
+		if (-1 == truth) {
+			return FALSE;
+		}
+		*va_arg(*vargs, int *) = truth;
+		break;
+	}
+	case 's': {
+		const char *str;
+		Py_ssize_t  str_len;
+
+		if (PyUnicode_Check(object)) {
+			str = PyUnicode_AsUTF8AndSize(object, &str_len);
+			if (NULL == str) {
+				return FALSE;
+			}
+		} else if (('#' == code[1]) && PyBytes_Check(object)) {
+			str = PyBytes_AS_STRING(object);
+			str_len = PyBytes_GET_SIZE(object);
+		} else {
+			PyErr_Format(PyExc_TypeError, YDBPY_ERR_ARGUMENT_TYPE, fname, argname,
+				     ('#' == code[1]) ? "str or bytes" : "str", Py_TYPE(object)->tp_name);
+			return FALSE;
+		}
+		*va_arg(*vargs, const char **) = str;
+		if ('#' == code[1]) {
+			*va_arg(*vargs, Py_ssize_t *) = str_len;
+		} else if ((size_t)str_len != strlen(str)) {
+			PyErr_Format(PyExc_ValueError, YDBPY_ERR_EMBEDDED_NULL, fname, argname);
+			return FALSE;
+		}
+		break;
+	}
+	default:
+		// Only the above format units are used in this file, so we should never get here.
+		assert(FALSE);
+		PyErr_Format(YDBPythonError, "invalid argument format unit '%c' for %s()", *code, fname);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/* Parse the arguments passed to a METH_FASTCALL | METH_KEYWORDS wrapper. This is the equivalent of
+ * PyArg_ParseTupleAndKeywords() for the vectorcall calling convention: positional arguments are read
+ * directly from the `args` array and keyword arguments are matched against `kwlist` using the names
+ * in the `kwnames` tuple, so no argument tuple or keyword dictionary is ever built.
  *
- * free with FREE_BUFFER_ARRAY macro
+ * `format` uses the same syntax as PyArg_ParseTupleAndKeywords() (see convert_fastcall_arg() for the
+ * supported units), with a '|' marking the start of optional arguments. As with that function, the
+ * storage for optional arguments that were not passed is left untouched, so callers should initialize
+ * it to the default value beforehand.
+ *
+ * Returns TRUE on success, or FALSE with a Python exception raised.
  */
-static ydb_buffer_t *create_empty_buffer_array(int num, int len) {
-	int	      i;
-	ydb_buffer_t *return_buffer_array;
+static bool parse_fastcall_args(PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames, const char *format, const char *fname,
+				char **kwlist, ...) {
+	bool	    success, optional;
+	int	    cur_arg, num_kwlist;
+	Py_ssize_t  cur_kw, num_kwnames;
+	PyObject *  objects[YDBPY_MAX_FASTCALL_ARGS], *kwname;
+	const char *code;
+	va_list	    vargs;
+
+	for (num_kwlist = 0; NULL != kwlist[num_kwlist]; num_kwlist++) {
+		objects[num_kwlist] = NULL;
+	}
+	assert(YDBPY_MAX_FASTCALL_ARGS >= num_kwlist);
+	if (num_kwlist < nargs) {
+		PyErr_Format(PyExc_TypeError, YDBPY_ERR_TOO_MANY_ARGS, fname, num_kwlist, (1 == num_kwlist) ? "" : "s", nargs);
+		return FALSE;
+	}
+	for (cur_arg = 0; cur_arg < nargs; cur_arg++) {
+		objects[cur_arg] = args[cur_arg]; // Borrowed Reference
+	}
+	/* Keyword argument values immediately follow the positional arguments in `args` */
+	num_kwnames = (NULL == kwnames) ? 0 : PyTuple_GET_SIZE(kwnames);
+	for (cur_kw = 0; cur_kw < num_kwnames; cur_kw++) {
+		kwname = PyTuple_GET_ITEM(kwnames, cur_kw); // Borrowed Reference
+		for (cur_arg = 0; cur_arg < num_kwlist; cur_arg++) {
+			if (0 == PyUnicode_CompareWithASCIIString(kwname, kwlist[cur_arg])) {
+				break;
+			}
+		}
+		if (num_kwlist == cur_arg) {
+			PyErr_Format(PyExc_TypeError, YDBPY_ERR_INVALID_KEYWORD, kwname, fname);
+			return FALSE;
+		} else if (cur_arg < nargs) {
+			PyErr_Format(PyExc_TypeError, YDBPY_ERR_DUPLICATE_ARGUMENT, fname, kwlist[cur_arg], cur_arg + 1);
+			return FALSE;
+		}
+		objects[cur_arg] = args[nargs + cur_kw]; // Borrowed Reference
+	}
 
-	return_buffer_array = malloc(num * sizeof(ydb_buffer_t));
-	for (i = 0; i < num; i++)
-		YDB_MALLOC_BUFFER(&return_buffer_array[i], len);
-	return return_buffer_array;
+	/* Convert each argument according to its format unit */
+	success = TRUE;
+	optional = FALSE;
+	code = format;
+	va_start(vargs, kwlist);
+	for (cur_arg = 0; success && (cur_arg < num_kwlist); cur_arg++) {
+		if ('|' == *code) {
+			optional = TRUE;
+			code++;
+		}
+		assert('\0' != *code);
+		if (NULL != objects[cur_arg]) {
+			success = convert_fastcall_arg(objects[cur_arg], code, fname, kwlist[cur_arg], &vargs);
+		} else if (!optional) {
+			PyErr_Format(PyExc_TypeError, YDBPY_ERR_MISSING_ARGUMENT, fname, kwlist[cur_arg], cur_arg + 1);
+			success = FALSE;
+		} else {
+			/* Skip over the storage for an omitted optional argument */
+			(void)va_arg(vargs, void *);
+			if ('#' == code[1]) {
+				(void)va_arg(vargs, void *);
+			}
+		}
+		code += ('#' == code[1]) ? 2 : 1;
+	}
+	va_end(vargs);
+	return success;
 }
 
 /* Conversion Utilities */
@@ -508,34 +1045,35 @@ static bool is_valid_sequence(PyObject *object, YDBPythonSequenceType sequence_t
 	return TRUE;
 }
 
-/* Routine to convert a sequence of Python bytes objects into a C array of
- * ydb_buffer_ts. Routine assumes sequence was already validated with
- * 'is_valid_sequence' function or the special case macro
- * RETURN_IF_INVALID_SEQUENCE. The function creates a
- * copy of each Python bytes' data so the resulting array should be
- * freed by using the 'FREE_BUFFER_ARRAY' macro.
+/* Routine to point each of a C array of ydb_buffer_ts at the contents of the corresponding item
+ * of a sequence of Python bytes or str objects, as done by anystr_to_borrowed_buffer() for a single
+ * object. Routine assumes sequence was already validated with 'is_valid_sequence' function or the
+ * special case macro RETURN_IF_INVALID_SEQUENCE, so `buffer_array` and `owners` need only be as
+ * long as the maximum length enforced there. On success, the caller must release the references
+ * stored in `owners` with the RELEASE_BUFFER_OWNERS macro. On failure, no references are held.
  *
  * Parameters:
- *    sequence    - a Python Object that is expected to be a Python Sequence containing Strings.
+ *    sequence     - a Python Object that is expected to be a Python Sequence containing Strings.
+ *    sequence_len - the number of items in `sequence`.
+ *    buffer_array - the array of ydb_buffer_ts to populate.
+ *    owners       - the array in which to store the references to the bytes objects backing `buffer_array`.
  */
-int convert_py_sequence_to_ydb_buffer_array(PyObject *sequence, int sequence_len, ydb_buffer_t *buffer_array) {
-	PyObject *bytes, *seq;
+static int borrow_py_sequence_as_buffer_array(PyObject *sequence, int sequence_len, ydb_buffer_t *buffer_array,
+					      PyObject **owners) {
+	PyObject *item, *seq;
 	int	  status;
 
 	seq = PySequence_Fast(sequence, "argument must be iterable"); // New Reference
 	if (!seq) {
 		PyErr_SetString(YDBPythonError, "Can't convert none sequence to buffer array.");
-		FREE_BUFFER_ARRAY(buffer_array, 0);
 		return !YDB_OK;
 	}
 
 	for (int i = 0; i < sequence_len; i++) {
-
-		bytes = PySequence_GetItem(seq, i);			   // New reference
-		status = anystr_to_buffer(bytes, &buffer_array[i], FALSE); // Allocates buffer
-		Py_DECREF(bytes);
+		item = PySequence_Fast_GET_ITEM(seq, i); // Borrowed Reference
+		status = anystr_to_borrowed_buffer(item, &buffer_array[i], FALSE, &owners[i]);
 		if (YDB_OK != status) {
-			FREE_BUFFER_ARRAY(buffer_array, i);
+			RELEASE_BUFFER_OWNERS(owners, i);
 			Py_DECREF(seq);
 			return !YDB_OK;
 		}
@@ -545,24 +1083,6 @@ int convert_py_sequence_to_ydb_buffer_array(PyObject *sequence, int sequence_len
 	return YDB_OK;
 }
 
-int populate_subs_used_and_subsarray(PyObject *pysubs, int *ret_subs_used, ydb_buffer_t **subsarray) {
-	int status = YDB_OK;
-	int subs_used;
-
-	subs_used = 0;
-	(*subsarray) = NULL;
-	if (Py_None != pysubs) {
-		subs_used = PySequence_Length(pysubs);
-		(*subsarray) = malloc(subs_used * sizeof(ydb_buffer_t));
-		status = convert_py_sequence_to_ydb_buffer_array(pysubs, subs_used, (*subsarray));
-		if (YDB_OK != status) {
-			FREE_BUFFER_ARRAY((*subsarray), subs_used);
-		}
-	}
-	(*ret_subs_used) = subs_used;
-	return status;
-}
-
 /* converts an array of ydb_buffer_ts into a sequence (Tuple) of Python strings.
  *
  * Parameters:
@@ -579,76 +1099,62 @@ PyObject *convert_ydb_buffer_array_to_py_tuple(ydb_buffer_t *buffer_array, int l
 	return return_tuple;
 }
 
-/* This function will take an already allocated array of YDBKey structures and load it with the
- * data contained in the PyObject arguments.
+/* This function will load a YDBKey structure with the data contained in the PyObject arguments.
+ * No memory is allocated: the buffers in the YDBKey point into the Python objects themselves, to which
+ * the YDBKey holds references until released with 'free_YDBKey'. On failure, an exception is raised
+ * and no references are held.
  *
  * Parameters:
  *    dest       - pointer to the YDBKey to fill.
- *    varname    - Python bytes object representing the varname
- *    subsarray  - array of Python bytes objects representing the array of subscripts
- *                   Note: Because this function calls `convert_py_sequence_to_ydb_buffer_array`
+ *    varname    - Python bytes or str object representing the varname
+ *    subsarray  - sequence of Python bytes or str objects representing the array of subscripts, or None
+ *                   Note: Because this function calls `borrow_py_sequence_as_buffer_array`
  *                          subsarray should be validated with the
  *                          RETURN_IF_INVALID_SEQUENCE macro.
  */
 static bool load_YDBKey(YDBKey *dest, PyObject *varname, PyObject *subsarray) {
-	bool	      done;
-	Py_ssize_t    len_ssize, sequence_len_ssize;
-	unsigned int  len;
-	int	      status;
-	char *	      bytes_c;
-	ydb_buffer_t *varname_y, *subsarray_y;
+	int	  status;
+	PyObject *varname_bytes;
 
-	if (!PyBytes_Check(varname)) {
-		// Convert Unicode object to bytes object
-		varname = PyUnicode_AsEncodedString(varname, "utf-8", "strict"); // New reference
-		assert(PyBytes_Check(varname));
+	/* Unlike other strings, the varnames of keys are encoded as UTF-8, such that a varname that cp1251 cannot
+	 * encode is still passed to YottaDB, which reports it as invalid.
+	 */
+	if (PyUnicode_Check(varname)) {
+		varname_bytes = PyUnicode_AsUTF8String(varname); // New Reference
+		if (NULL == varname_bytes) {
+			PyErr_SetString(YDBPythonError, "failed to encode Unicode string to bytes object");
+			return false;
+		}
+		status = anystr_to_borrowed_buffer(varname_bytes, &dest->varname, TRUE, &dest->owners[0]);
+		Py_DECREF(varname_bytes);
+	} else {
+		status = anystr_to_borrowed_buffer(varname, &dest->varname, TRUE, &dest->owners[0]);
 	}
-
-	len_ssize = PyBytes_Size(varname);
-	len = Py_SAFE_DOWNCAST(len_ssize, Py_ssize_t, unsigned int);
-	bytes_c = PyBytes_AsString(varname);
-
-	varname_y = malloc(1 * sizeof(ydb_buffer_t));
-	YDB_MALLOC_BUFFER(varname_y, len);
-	YDB_COPY_BYTES_TO_BUFFER(bytes_c, len, varname_y, done);
-	if (!done) {
-		YDB_FREE_BUFFER(varname_y);
-		free(varname_y);
-		PyErr_SetString(YDBPythonError, "failed to copy bytes object to buffer");
+	if (YDB_OK != status) {
 		return false;
 	}
 
-	dest->varname = varname_y;
+	dest->subs_used = 0;
 	if (Py_None != subsarray) {
-		sequence_len_ssize = PySequence_Length(subsarray);
-		dest->subs_used = Py_SAFE_DOWNCAST(sequence_len_ssize, Py_ssize_t, unsigned int);
-		subsarray_y = malloc(dest->subs_used * sizeof(ydb_buffer_t));
-		status = convert_py_sequence_to_ydb_buffer_array(subsarray, dest->subs_used, subsarray_y);
-		if (YDB_OK == status) {
-			dest->subsarray = subsarray_y;
-		} else {
-			YDB_FREE_BUFFER(varname_y);
-			free(varname_y);
-			FREE_BUFFER_ARRAY(subsarray_y, dest->subs_used);
-			PyErr_SetString(YDBPythonError, "failed to covert sequence to buffer array");
+		dest->subs_used = Py_SAFE_DOWNCAST(PySequence_Length(subsarray), Py_ssize_t, int);
+		assert(YDB_MAX_SUBS >= dest->subs_used);
+		status = borrow_py_sequence_as_buffer_array(subsarray, dest->subs_used, dest->subsarray, &dest->owners[1]);
+		if (YDB_OK != status) {
+			Py_DECREF(dest->owners[0]);
 			return false;
 		}
-	} else {
-		dest->subs_used = 0;
-		dest->subsarray = NULL;
 	}
 	return true;
 }
 
-/* Routine to free a YDBKey structure.
+/* Routine to release the references held by a YDBKey structure.
  *
  * Parameters:
  *    key    - pointer to the YDBKey to free.
  */
 static void free_YDBKey(YDBKey *key) {
 	if (NULL != key) {
-		YDB_FREE_BUFFER((key->varname));
-		FREE_BUFFER_ARRAY(key->subsarray, key->subs_used);
+		RELEASE_BUFFER_OWNERS(key->owners, 1 + key->subs_used);
 	}
 }
 
@@ -770,9 +1276,24 @@ static int is_valid_key_sequence(PyObject *keys_sequence, int max_len) {
 	return TRUE;
 }
 
+/* Routine to release an array of YDBKeys as populated by below
+ * 'load_YDBKeys_from_key_sequence'. The array itself is not freed.
+ *
+ * Parameters:
+ *    keysarray    - the array that is to be released.
+ *    len          - the number of elements in keysarray.
+ */
+static void free_YDBKey_array(YDBKey *keysarray, int len) {
+	int i;
+	if (NULL != keysarray) {
+		for (i = 0; i < len; i++)
+			free_YDBKey(&keysarray[i]);
+	}
+}
+
 /* Takes an already validated (by 'validate_py_keys_sequence' above) PyObject sequence
  * that represents a series of keys loads that data into an already allocated array
- * of YDBKeys. (note: 'ret_keys' should later be freed by 'free_YDBKey_array' below)
+ * of YDBKeys. (note: 'ret_keys' should later be released by 'free_YDBKey_array' above)
  *
  * Parameters:
  *    sequence    - a Python object that has already been validated with 'validate_py_keys_sequence' or equivalent.
@@ -791,6 +1312,7 @@ static bool load_YDBKeys_from_key_sequence(PyObject *sequence, Py_ssize_t len_ke
 		key = PySequence_Fast_GET_ITEM(seq, i);			     // Borrowed Reference
 		key_seq = PySequence_Fast(key, "argument must be iterable"); // New Reference
 		if (NULL == key_seq) {
+			free_YDBKey_array(ret_keys, i);
 			Py_DECREF(seq);
 			return false;
 		}
@@ -803,34 +1325,21 @@ static bool load_YDBKeys_from_key_sequence(PyObject *sequence, Py_ssize_t len_ke
 		}
 		success = load_YDBKey(&ret_keys[i], varname, subsarray);
 		Py_DECREF(key_seq);
-		if (!success)
+		if (!success) {
+			// Release the keys loaded so far, so that nothing is held on failure
+			free_YDBKey_array(ret_keys, i);
 			break;
+		}
 	}
 	Py_DECREF(seq);
 	return success;
 }
 
-/* Routine to free an array of YDBKeys as returned by above
- * 'load_YDBKeys_from_key_sequence'.
+/* Routine to help raise a YDBError. The caller still needs to return NULL for
+ * the Exception to be raised.
  *
  * Parameters:
- *    keysarray    - the array that is to be freed.
- *    len          - the number of elements in keysarray.
- */
-static void free_YDBKey_array(YDBKey *keysarray, int len) {
-	int i;
-	if (NULL != keysarray) {
-		for (i = 0; i < len; i++)
-			free_YDBKey(&keysarray[i]);
-		free(keysarray);
-	}
-}
-
-/* Routine to help raise a YDBError. The caller still needs to return NULL for
- * the Exception to be raised.
- *
- * Parameters:
- *    status                 - the error code that is returned by the wrapped ydb_ function.
+ *    status                 - the error code that is returned by the wrapped ydb_ function.
  */
 static void raise_YDBError(int status) {
 	ydb_char_t   error_string[YDBPY_MAX_ERRORMSG];
@@ -852,7 +1361,7 @@ static void raise_YDBError(int status) {
 			error_buffer.buf_addr = error_string;
 			error_buffer.len_alloc = YDBPY_MAX_ERRORMSG;
 			error_buffer.len_used = 0;
-			zstatus = ydb_message(status, &error_buffer);
+			YDBPY_CALL_UTILITY(zstatus, message, status, &error_buffer);
 			assert(YDB_OK == zstatus);
 			error_buffer.buf_addr[error_buffer.len_used] = '\0';
 		}
@@ -886,6 +1395,27 @@ static void raise_YDBError(int status) {
 		} else {
 			assert(FALSE);
 		}
+	} else if (threaded_api) {
+		/* The threaded API reports the error message of each call in the error string buffer passed to it. The Simple API
+		 * ydb_zstatus() must not be called in threaded mode, so fall back to looking up the message for the error code
+		 * with ydb_message_t() in the rare case that the buffer was left empty.
+		 */
+		if (0 < thread_state.errstr.len_used) {
+			copied = snprintf(full_error_message, YDBPY_MAX_ERRORMSG, "%.*s", (int)thread_state.errstr.len_used,
+					  thread_state.errstr.buf_addr);
+		} else {
+			error_buffer.buf_addr = error_string;
+			error_buffer.len_alloc = YDBPY_MAX_ERRORMSG - 1;
+			error_buffer.len_used = 0;
+			YDBPY_CALL_UTILITY(zstatus, message, status, &error_buffer);
+			if (YDB_OK == zstatus) {
+				copied = snprintf(full_error_message, YDBPY_MAX_ERRORMSG + CANONICAL_NUMBER_TO_STRING_MAX, "%d, %.*s",
+						  status, (int)error_buffer.len_used, error_buffer.buf_addr);
+			} else {
+				copied = snprintf(full_error_message, YDBPY_MAX_ERRORMSG, "%d, UNKNOWN error", status);
+			}
+		}
+		error_type = YDBError;
 	} else {
 		zstatus = ydb_zstatus(error_string, YDB_MAX_ERRORMSG);
 		if ((YDB_OK == zstatus) || (YDB_ERR_INVSTRLEN == zstatus)) {
@@ -922,8 +1452,13 @@ static void raise_YDBError(int status) {
  *
  * Parameters:
  *    self        - the object that this method belongs to (in this case it's the _yottadb module.)
- *    args        - a Python tuple of the positional arguments passed to the function.
- *    kwds        - a Python dictionary of the keyword arguments passed to the function.
+ *    args        - a C array of the positional arguments passed to the function, followed by the values
+ *                  of any keyword arguments.
+ *    nargs       - the number of positional arguments in `args`.
+ *    kwnames     - a Python tuple of the names of the keyword arguments in `args`, or NULL if there are none.
+ *
+ * All wrappers use the METH_FASTCALL | METH_KEYWORDS calling convention and parse their arguments with
+ * parse_fastcall_args(), avoiding the creation of an argument tuple and keyword dictionary on every call.
  */
 
 /* Initialize a py_ci_name_descriptor struct with the name of a call-in routine.
@@ -960,7 +1495,7 @@ static void free_ci_name_descriptor() {
 	ci_info.has_parm_types = FALSE;
 }
 
-static PyObject *ci_wrapper(PyObject *args, PyObject *kwds, bool is_cip) {
+static PyObject *ci_wrapper(PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames, bool is_cip) {
 	bool	      return_null = false;
 	int	      status, has_retval;
 	PyObject *    routine, *routine_args, *seq, *py_arg, *ret;
@@ -978,13 +1513,20 @@ static PyObject *ci_wrapper(PyObject *args, PyObject *kwds, bool is_cip) {
 	// Parse and validate
 	static char *kwlist[] = {"routine", "args", "has_retval", NULL};
 	// Parsed values are borrowed references, do not Py_DECREF them.
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|Op", kwlist, &routine, &routine_args, &has_retval)) {
+	if (!parse_fastcall_args(args, nargs, kwnames, "O|Op", (is_cip ? "cip" : "ci"), kwlist, &routine, &routine_args,
+				 &has_retval)) {
 		return NULL;
 	}
 	if (Py_None == routine) {
 		raise_ValidationError(YDBPython_ValueError, NULL, YDBPY_ERR_ROUTINE_UNSPECIFIED);
 		return NULL;
 	}
+	/* The call-in descriptor cached by cip() is shared by all threads, so in threaded mode it could be replaced by
+	 * one thread while YottaDB uses it on behalf of another with the GIL released. Make the same call as ci() instead.
+	 */
+	if (threaded_api) {
+		is_cip = FALSE;
+	}
 
 	// Lookup routine parameter information for construction of argument array
 	if (is_cip) {
@@ -1009,7 +1551,7 @@ static PyObject *ci_wrapper(PyObject *args, PyObject *kwds, bool is_cip) {
 				YDB_FREE_BUFFER(&routine_name);
 				return NULL;
 			}
-			status = ydb_ci_get_info(routine_name.buf_addr, &ci_info.parm_types);
+			YDBPY_CALL_UTILITY(status, ci_get_info, routine_name.buf_addr, &ci_info.parm_types);
 			if (YDB_OK != status) {
 				raise_YDBError(status);
 				YDB_FREE_BUFFER(&routine_name);
@@ -1019,7 +1561,7 @@ static PyObject *ci_wrapper(PyObject *args, PyObject *kwds, bool is_cip) {
 		}
 		parm_types = ci_info.parm_types;
 	} else {
-		status = ydb_ci_get_info(routine_name.buf_addr, &parm_types);
+		YDBPY_CALL_UTILITY(status, ci_get_info, routine_name.buf_addr, &parm_types);
 		if (YDB_OK != status) {
 			raise_YDBError(status);
 			YDB_FREE_BUFFER(&routine_name);
@@ -1055,6 +1597,16 @@ static PyObject *ci_wrapper(PyObject *args, PyObject *kwds, bool is_cip) {
 		YDB_FREE_BUFFER(&routine_name);
 		return NULL;
 	}
+	/* The threaded API takes two more arguments, leaving room for fewer call-in arguments */
+	if (threaded_api && (YDB_CALL_VARIADIC_MAX_ARGUMENTS < (num_args + has_retval + 1 + YDBPY_THREADED_ARGS))) {
+		raise_ValidationError(YDBPython_ValueError, NULL, YDBPY_ERR_SEQUENCE_TOO_LONG, (long)num_args,
+				      YDB_CALL_VARIADIC_MAX_ARGUMENTS - YDBPY_THREADED_ARGS - 1 - has_retval);
+		if (NULL != seq) {
+			Py_DECREF(seq);
+		}
+		YDB_FREE_BUFFER(&routine_name);
+		return NULL;
+	}
 	/* In the case of output arguments to ci(), as specified in the call-in table,
 	 * an update will be required to the Python object containing the arguments to
 	 * be passed to ydb_ci() with the output value for that argument. In that case,
@@ -1158,9 +1710,9 @@ static PyObject *ci_wrapper(PyObject *args, PyObject *kwds, bool is_cip) {
 	assert((num_args + has_retval + 1) == cur_index); // +1 for ci_name_descriptor
 
 	if (is_cip) {
-		status = ydb_call_variadic_plist_func((ydb_vplist_func)&ydb_cip, &arg_values);
+		status = call_variadic_plist_func(YDBPY_OP_cip, (ydb_vplist_func)&ydb_cip, (ydb_vplist_func)&ydb_cip_t, &arg_values);
 	} else {
-		status = ydb_call_variadic_plist_func((ydb_vplist_func)&ydb_ci, &arg_values);
+		status = call_variadic_plist_func(YDBPY_OP_ci, (ydb_vplist_func)&ydb_ci, (ydb_vplist_func)&ydb_ci_t, &arg_values);
 	}
 	if (YDB_OK != status) {
 		FREE_STRING_ARRAY(args_ydb, num_args);
@@ -1214,35 +1766,35 @@ static PyObject *ci_wrapper(PyObject *args, PyObject *kwds, bool is_cip) {
 }
 
 /* Wrapper for ydb_cip() */
-static PyObject *cip(PyObject *self, PyObject *args, PyObject *kwds) {
+static PyObject *cip(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
 	UNUSED(self);
-	return ci_wrapper(args, kwds, TRUE);
+	return ci_wrapper(args, nargs, kwnames, TRUE);
 }
 
 /* Wrapper for ydb_ci() */
-static PyObject *ci(PyObject *self, PyObject *args, PyObject *kwds) {
+static PyObject *ci(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
 	UNUSED(self);
-	return ci_wrapper(args, kwds, FALSE);
+	return ci_wrapper(args, nargs, kwnames, FALSE);
 }
 
-static PyObject *open_ci_table(PyObject *self, PyObject *args, PyObject *kwds) {
-	char *	   filename;
-	int	   status;
-	Py_ssize_t filename_len;
-	PyObject * ret;
-	uintptr_t  ret_value;
+static PyObject *open_ci_table(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	const char *filename;
+	int	    status;
+	Py_ssize_t  filename_len;
+	PyObject *  ret;
+	uintptr_t   ret_value;
 
 	UNUSED(self);
 
 	/* Parse and validate */
 	static char *kwlist[] = {"filename", NULL};
 	/* Parsed values are borrowed references, do not Py_DECREF them. */
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "s#", kwlist, &filename, &filename_len))
+	if (!parse_fastcall_args(args, nargs, kwnames, "s#", "open_ci_table", kwlist, &filename, &filename_len))
 		return NULL;
 
 	if (0 < filename_len) {
 		/* Call the wrapped function */
-		status = ydb_ci_tab_open(filename, &ret_value);
+		YDBPY_CALL_UTILITY(status, ci_tab_open, filename, &ret_value);
 		if (YDB_OK != status) {
 			raise_YDBError(status);
 			return NULL;
@@ -1256,7 +1808,7 @@ static PyObject *open_ci_table(PyObject *self, PyObject *args, PyObject *kwds) {
 	return ret;
 }
 
-static PyObject *switch_ci_table(PyObject *self, PyObject *args, PyObject *kwds) {
+static PyObject *switch_ci_table(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
 	int	  status;
 	PyObject *ret;
 	uintptr_t ret_value, handle;
@@ -1266,11 +1818,11 @@ static PyObject *switch_ci_table(PyObject *self, PyObject *args, PyObject *kwds)
 	/* parse and validate */
 	static char *kwlist[] = {"handle", NULL};
 	/* Parsed values are borrowed references, do not Py_DECREF them. */
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "k", kwlist, &handle))
+	if (!parse_fastcall_args(args, nargs, kwnames, "k", "switch_ci_table", kwlist, &handle))
 		return NULL;
 
 	/* Call the wrapped function */
-	status = ydb_ci_tab_switch(handle, &ret_value);
+	YDBPY_CALL_UTILITY(status, ci_tab_switch, handle, &ret_value);
 	if (YDB_OK != status) {
 		raise_YDBError(status);
 		return NULL;
@@ -1280,7 +1832,7 @@ static PyObject *switch_ci_table(PyObject *self, PyObject *args, PyObject *kwds)
 	return ret;
 }
 
-static PyObject *message(PyObject *self, PyObject *args, PyObject *kwds) {
+static PyObject *message(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
 	int	     err_num, status;
 	PyObject *   ret;
 	ydb_buffer_t ret_val;
@@ -1290,11 +1842,11 @@ static PyObject *message(PyObject *self, PyObject *args, PyObject *kwds) {
 	/* parse and validate */
 	static char *kwlist[] = {"err_num", NULL};
 	/* Parsed values are borrowed references, do not Py_DECREF them. */
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "i", kwlist, &err_num))
+	if (!parse_fastcall_args(args, nargs, kwnames, "i", "message", kwlist, &err_num))
 		return NULL;
 
 	YDB_MALLOC_BUFFER(&ret_val, YDBPY_MAX_ERRORMSG);
-	status = ydb_message(err_num, &ret_val);
+	YDBPY_CALL_UTILITY(status, message, err_num, &ret_val);
 	if (YDB_OK != status) {
 		raise_YDBError(status);
 		assert(YDB_ERR_INVSTRLEN != status);
@@ -1318,7 +1870,7 @@ static PyObject *release(PyObject *self) {
 	ret_value.len_alloc = YDBPY_MAX_ERRORMSG;
 	ret_value.len_used = 0;
 	YDB_STRING_TO_BUFFER("$ZYRELEASE", &varname);
-	status = ydb_get_s(&varname, 0, NULL, &ret_value);
+	YDBPY_CALL(status, get, &varname, 0, NULL, &ret_value);
 	if (YDB_OK != status) {
 		raise_YDBError(status);
 		assert(YDB_ERR_INVSTRLEN != status);
@@ -1335,7 +1887,17 @@ static PyObject *adjust_stdout_stderr(PyObject *self) {
 
 	UNUSED(self);
 
-	status = ydb_stdout_stderr_adjust();
+	if (threaded_api) {
+		ydb_buffer_t *errstr;
+
+		errstr = reset_errstr();
+		Py_BEGIN_ALLOW_THREADS;
+		status = ydb_stdout_stderr_adjust_t(thread_state.tptoken, errstr);
+		Py_END_ALLOW_THREADS;
+	} else {
+		simple_api_used = TRUE;
+		status = ydb_stdout_stderr_adjust();
+	}
 	if (YDB_OK != status) {
 		raise_YDBError(status);
 		return NULL;
@@ -1345,39 +1907,400 @@ static PyObject *adjust_stdout_stderr(PyObject *self) {
 	return Py_None;
 }
 
+/* Switch to the threaded API for all subsequent calls to YottaDB, releasing the GIL for the duration of each call.
+ * This must happen before the first call to YottaDB in the process, since YottaDB does not allow a process to use
+ * both the Simple API and the threaded API.
+ */
+static PyObject *enable_threads(PyObject *self) {
+	UNUSED(self);
+
+	if (simple_api_used) {
+		PyErr_SetString(YDBPythonError, YDBPY_ERR_SIMPLE_API_USED);
+		return NULL;
+	}
+	threaded_api = TRUE;
+	Py_RETURN_NONE;
+}
+
+/* Report statistics on the buffers used to receive values from YottaDB, optionally resetting the counters */
+static PyObject *buffer_stats(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int	      reset;
+	unsigned int  value_buffer_len;
+	ydb_buffer_t *value_buffer;
+	PyObject *    ret;
+
+	UNUSED(self);
+	/* Default values for optional arguments passed from Python */
+	reset = FALSE;
+
+	/* Parse */
+	static char *kwlist[] = {"reset", NULL};
+	if (!parse_fastcall_args(args, nargs, kwnames, "|p", "buffer_stats", kwlist, &reset))
+		return NULL;
+
+	// Report the size of the calling thread's value buffer, which is not allocated until first used
+	value_buffer = pthread_getspecific(value_buffer_key);
+	value_buffer_len = (NULL == value_buffer) ? 0 : value_buffer->len_alloc;
+	/* New Reference */
+	ret = Py_BuildValue("{s:K,s:I}", "invstrlen_retries", invstrlen_retries, "value_buffer_len", value_buffer_len);
+	if ((NULL != ret) && reset) {
+		invstrlen_retries = 0;
+	}
+	return ret;
+}
+
+/* Start or stop counting and timing the calls made to YottaDB, as reported by stats() */
+static PyObject *enable_stats(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int enable;
+
+	UNUSED(self);
+	/* Default values for optional arguments passed from Python */
+	enable = TRUE;
+
+	/* Parse */
+	static char *kwlist[] = {"enable", NULL};
+	if (!parse_fastcall_args(args, nargs, kwnames, "|p", "enable_stats", kwlist, &enable))
+		return NULL;
+
+	stats_enabled = enable;
+	calls_timed = stats_enabled || trace_enabled;
+	Py_RETURN_NONE;
+}
+
+/* Build the dict describing the counters of one operation, as returned by stats() */
+static PyObject *op_stats_to_dict(YDBOpStats *stats) {
+	PyObject *statuses, *latency, *bucket;
+	int	  status;
+
+	/* New Reference */
+	statuses = PyDict_New();
+	if (NULL == statuses)
+		return NULL;
+	for (unsigned int i = 0; (i < YDBPY_STATS_MAX_STATUSES) && (0 < stats->status_counts[i]); i++) {
+		PyObject *status_py, *count_py;
+
+		/* New Reference */
+		status_py = PyLong_FromLong(stats->statuses[i]);
+		/* New Reference */
+		count_py = PyLong_FromUnsignedLongLong(stats->status_counts[i]);
+		status = ((NULL == status_py) || (NULL == count_py)) ? -1 : PyDict_SetItem(statuses, status_py, count_py);
+		Py_XDECREF(status_py);
+		Py_XDECREF(count_py);
+		if (0 != status) {
+			Py_DECREF(statuses);
+			return NULL;
+		}
+	}
+	// Only list the buckets that calls fell into, as (start_ns, end_ns, count) tuples
+	/* New Reference */
+	latency = PyList_New(0);
+	if (NULL == latency) {
+		Py_DECREF(statuses);
+		return NULL;
+	}
+	for (unsigned int i = 0; i < YDBPY_STATS_LATENCY_BUCKETS; i++) {
+		if (0 == stats->latency[i])
+			continue;
+		/* New Reference */
+		bucket = Py_BuildValue("(KKK)", latency_bucket_start(i), latency_bucket_start(i + 1), stats->latency[i]);
+		status = (NULL == bucket) ? -1 : PyList_Append(latency, bucket);
+		Py_XDECREF(bucket);
+		if (0 != status) {
+			Py_DECREF(statuses);
+			Py_DECREF(latency);
+			return NULL;
+		}
+	}
+	/* New Reference */
+	return Py_BuildValue("{s:K,s:K,s:N,s:K,s:K,s:K,s:N}", "calls", stats->calls, "errors", stats->errors, "statuses", statuses,
+			     "bytes_in", stats->bytes_in, "bytes_out", stats->bytes_out, "total_ns", stats->total_ns, "latency",
+			     latency);
+}
+
+/* Report the counters kept for each operation since stats were enabled by enable_stats(), optionally resetting them */
+static PyObject *stats(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int	  reset, status;
+	PyObject *ret, *op_dict;
+
+	UNUSED(self);
+	/* Default values for optional arguments passed from Python */
+	reset = FALSE;
+
+	/* Parse */
+	static char *kwlist[] = {"reset", NULL};
+	if (!parse_fastcall_args(args, nargs, kwnames, "|p", "stats", kwlist, &reset))
+		return NULL;
+
+	/* New Reference */
+	ret = PyDict_New();
+	if (NULL == ret)
+		return NULL;
+	for (unsigned int op = 0; op < YDBPY_NUM_OPS; op++) {
+		if (0 == op_stats[op].calls)
+			continue;
+		/* New Reference */
+		op_dict = op_stats_to_dict(&op_stats[op]);
+		if (NULL == op_dict) {
+			Py_DECREF(ret);
+			return NULL;
+		}
+		status = PyDict_SetItemString(ret, op_names[op], op_dict);
+		Py_DECREF(op_dict);
+		if (0 != status) {
+			Py_DECREF(ret);
+			return NULL;
+		}
+	}
+	if (reset) {
+		memset(op_stats, 0, sizeof(op_stats));
+	}
+	return ret;
+}
+
+/* Report the counters kept for the calls to tp() made while stats are enabled, by transid, optionally resetting them */
+static PyObject *tp_stats(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int	    reset, status;
+	PyObject *  ret, *entry_py;
+	YDBTPStats *stats;
+
+	UNUSED(self);
+	/* Default values for optional arguments passed from Python */
+	reset = FALSE;
+
+	/* Parse */
+	static char *kwlist[] = {"reset", NULL};
+	if (!parse_fastcall_args(args, nargs, kwnames, "|p", "tp_stats", kwlist, &reset))
+		return NULL;
+
+	/* New Reference */
+	ret = PyDict_New();
+	if (NULL == ret)
+		return NULL;
+	for (unsigned int i = 0; i < tp_stats_used; i++) {
+		stats = &tp_stats_entries[i];
+		/* New Reference */
+		entry_py = Py_BuildValue("{s:K,s:K,s:K,s:K,s:K,s:K,s:K}", "attempts", stats->attempts, "restarts", stats->restarts,
+					 "rollbacks", stats->rollbacks, "commits", stats->commits, "errors", stats->errors,
+					 "callback_ns", stats->callback_ns, "commit_ns", stats->commit_ns);
+		status = (NULL == entry_py) ? -1 : PyDict_SetItemString(ret, stats->transid, entry_py);
+		Py_XDECREF(entry_py);
+		if (0 != status) {
+			Py_DECREF(ret);
+			return NULL;
+		}
+	}
+	if (reset) {
+		for (unsigned int i = 0; i < tp_stats_used; i++) {
+			free(tp_stats_entries[i].transid);
+		}
+		tp_stats_used = 0;
+	}
+	return ret;
+}
+
+/* Start or stop recording the calls made to YottaDB that take at least `threshold_ns` nanoseconds, in a ring buffer of
+ * `size` entries that is drained by drain_trace(). Changing the size discards any entries not drained yet.
+ */
+static PyObject *enable_trace(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int		   enable;
+	unsigned long	   size;
+	unsigned long long threshold_ns;
+	YDBTraceEntry *	   entries;
+
+	UNUSED(self);
+	/* Default values for optional arguments passed from Python */
+	threshold_ns = YDBPY_DEFAULT_TRACE_THRESHOLD_NS;
+	size = YDBPY_DEFAULT_TRACE_SIZE;
+	enable = TRUE;
+
+	/* Parse */
+	static char *kwlist[] = {"threshold_ns", "size", "enable", NULL};
+	if (!parse_fastcall_args(args, nargs, kwnames, "|Kkp", "enable_trace", kwlist, &threshold_ns, &size, &enable))
+		return NULL;
+
+	if (enable && (size != trace_size)) {
+		if (0 == size) {
+			PyErr_Format(PyExc_ValueError, YDBPY_ERR_TRACE_SIZE, size);
+			return NULL;
+		}
+		entries = malloc(size * sizeof(YDBTraceEntry));
+		if (NULL == entries) {
+			PyErr_NoMemory();
+			return NULL;
+		}
+		free(trace_entries);
+		trace_entries = entries;
+		trace_size = size;
+		trace_next = trace_used = 0;
+		trace_dropped = 0;
+	}
+	trace_threshold_ns = threshold_ns;
+	trace_enabled = enable;
+	calls_timed = stats_enabled || trace_enabled;
+	Py_RETURN_NONE;
+}
+
+/* Returns the subscripts recorded in `entry` as a str of comma-separated ZWR format subscripts, followed by "..." if
+ * they were truncated, or NULL with a Python exception raised on error.
+ */
+static PyObject *trace_subs_to_zwr(YDBTraceEntry *entry) {
+	int	      status;
+	unsigned int  offset;
+	ydb_buffer_t  sub, *zwr;
+	PyObject *    pieces, *piece, *separator, *ret;
+
+	zwr = get_value_buffer();
+	if (NULL == zwr)
+		return NULL;
+	/* New Reference */
+	pieces = PyList_New(0);
+	if (NULL == pieces)
+		return NULL;
+	offset = 0;
+	for (int i = 0; i < entry->subs_used; i++) {
+		sub.buf_addr = entry->subs + offset;
+		sub.len_alloc = sub.len_used = entry->subs_lens[i];
+		offset += entry->subs_lens[i];
+		// Not timed, so that draining the ring buffer does not fill it again, nor count in stats()
+		YDBPY_CALL_UNCOUNTED(status, str2zwr, &sub, zwr);
+		if (YDB_ERR_INVSTRLEN == status) {
+			grow_value_buffer(zwr);
+			YDBPY_CALL_UNCOUNTED(status, str2zwr, &sub, zwr);
+			assert(YDB_ERR_INVSTRLEN != status);
+		}
+		if (YDB_OK != status) {
+			raise_YDBError(status);
+			Py_DECREF(pieces);
+			return NULL;
+		}
+		/* New Reference */
+		piece = PyUnicode_DecodeUTF8(zwr->buf_addr, zwr->len_used, "replace");
+		status = (NULL == piece) ? -1 : PyList_Append(pieces, piece);
+		Py_XDECREF(piece);
+		if (0 != status) {
+			Py_DECREF(pieces);
+			return NULL;
+		}
+	}
+	if (entry->subs_truncated) {
+		/* New Reference */
+		piece = PyUnicode_FromString("...");
+		status = (NULL == piece) ? -1 : PyList_Append(pieces, piece);
+		Py_XDECREF(piece);
+		if (0 != status) {
+			Py_DECREF(pieces);
+			return NULL;
+		}
+	}
+	/* New Reference */
+	separator = PyUnicode_FromString(",");
+	if (NULL == separator) {
+		Py_DECREF(pieces);
+		return NULL;
+	}
+	/* New Reference */
+	ret = PyUnicode_Join(separator, pieces);
+	Py_DECREF(separator);
+	Py_DECREF(pieces);
+	return ret;
+}
+
+/* Returns the calls recorded since the last call as set up by enable_trace(), oldest first, and the number of calls that
+ * were not kept because the ring buffer was full, emptying the ring buffer. On error, the ring buffer is left as is, so
+ * that its entries are returned by the next call.
+ */
+static PyObject *drain_trace(PyObject *self) {
+	int		   status;
+	unsigned long	   used, first;
+	unsigned long long dropped, recorded;
+	YDBTraceEntry *	   entries;
+	PyObject *	   list, *entry_py, *subs, *ret;
+
+	UNUSED(self);
+
+	/* Copy the entries out before formatting them, as the YottaDB calls made to do so release the GIL in threaded mode,
+	 * during which other threads may record new entries or resize the ring buffer.
+	 */
+	used = trace_used;
+	dropped = trace_dropped;
+	recorded = trace_recorded;
+	entries = malloc((0 < used ? used : 1) * sizeof(YDBTraceEntry));
+	if (NULL == entries) {
+		PyErr_NoMemory();
+		return NULL;
+	}
+	first = (trace_next + trace_size - used) % (0 < trace_size ? trace_size : 1);
+	for (unsigned long i = 0; i < used; i++) {
+		entries[i] = trace_entries[(first + i) % trace_size];
+	}
+
+	/* New Reference */
+	list = PyList_New(0);
+	if (NULL == list) {
+		free(entries);
+		return NULL;
+	}
+	for (unsigned long i = 0; i < used; i++) {
+		/* New Reference */
+		subs = trace_subs_to_zwr(&entries[i]);
+		if (NULL == subs) {
+			Py_DECREF(list);
+			free(entries);
+			return NULL;
+		}
+		/* New Reference */
+		entry_py = Py_BuildValue("{s:s,s:s#,s:N,s:i,s:K,s:K}", "op", op_names[entries[i].op], "varname", entries[i].varname,
+					 (Py_ssize_t)entries[i].varname_len, "subs", subs, "status", entries[i].status, "duration_ns",
+					 entries[i].duration_ns, "time_ns", entries[i].time_ns);
+		status = (NULL == entry_py) ? -1 : PyList_Append(list, entry_py);
+		Py_XDECREF(entry_py);
+		if (0 != status) {
+			Py_DECREF(list);
+			free(entries);
+			return NULL;
+		}
+	}
+	free(entries);
+	/* New Reference */
+	ret = Py_BuildValue("(NK)", list, dropped);
+	if (NULL != ret) {
+		/* Only keep the entries recorded since they were copied out, unless the ring buffer was resized meanwhile */
+		if (trace_recorded - recorded < trace_used) {
+			trace_used = trace_recorded - recorded;
+		}
+		trace_dropped = (trace_dropped < dropped) ? 0 : trace_dropped - dropped;
+	}
+	return ret;
+}
+
 /* Wrapper for ydb_data_s */
-static PyObject *data(PyObject *self, PyObject *args, PyObject *kwds) {
-	PyObject *    varname_py;
-	int	      subs_used, status;
-	unsigned int  ret_value;
-	PyObject *    subsarray_py, *ret;
-	ydb_buffer_t  varname_ydb;
-	ydb_buffer_t *subsarray_ydb;
+static PyObject *data(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	PyObject *   varname_py;
+	int	     status;
+	unsigned int ret_value;
+	PyObject *   subsarray_py, *ret;
+	YDBKey	     key;
 
 	UNUSED(self);
-	ret = NULL;	      // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
-	subs_used = 0;	      // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
-	subsarray_ydb = NULL; // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
+	ret = NULL; // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
 	/* Default values for optional arguments passed from Python */
 	subsarray_py = Py_None;
 
 	/* Parse */
 	static char *kwlist[] = {"varname", "subsarray", NULL};
 	/* Parsed values are borrowed references, do not Py_DECREF them. */
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O", kwlist, &varname_py, &subsarray_py))
+	if (!parse_fastcall_args(args, nargs, kwnames, "O|O", "data", kwlist, &varname_py, &subsarray_py))
 		return NULL;
 
 	/* Validate */
 	RETURN_IF_INVALID_SEQUENCE(subsarray_py, YDBPython_SubsarraySequence);
 
 	/* Setup for call */
-	INVOKE_ANYSTR_TO_BUFFER(varname_py, varname_ydb, TRUE);
-	INVOKE_POPULATE_SUBS_USED_AND_SUBSARRAY_AND_CLEANUP_VARNAME(subsarray_py, subs_used, subsarray_ydb, varname_ydb);
+	INVOKE_LOAD_YDBKEY(key, varname_py, subsarray_py);
 
 	/* Call the wrapped function */
-	status = ydb_data_s(&varname_ydb, subs_used, subsarray_ydb, &ret_value);
-	FREE_BUFFER_ARRAY(subsarray_ydb, subs_used);
-	YDB_FREE_BUFFER(&varname_ydb);
+	YDBPY_CALL(status, data, &key.varname, key.subs_used, key.subsarray, &ret_value);
+	free_YDBKey(&key);
 
 	if (YDB_OK != status) {
 		raise_YDBError(status);
@@ -1388,17 +2311,14 @@ static PyObject *data(PyObject *self, PyObject *args, PyObject *kwds) {
 }
 
 /* Wrapper for ydb_delete_s() */
-static PyObject *delete_wrapper(PyObject *self, PyObject *args, PyObject *kwds) {
-	int	      deltype, status, subs_used;
-	PyObject *    varname_py, *subsarray_py;
-	PyObject *    ret;
-	ydb_buffer_t  varname_ydb;
-	ydb_buffer_t *subsarray_ydb;
+static PyObject *delete_wrapper(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int	  deltype, status;
+	PyObject *varname_py, *subsarray_py;
+	PyObject *ret;
+	YDBKey	  key;
 
 	UNUSED(self);
 	ret = NULL;
-	subs_used = 0;	      // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
-	subsarray_ydb = NULL; // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
 	/* Default values for optional arguments passed from Python */
 	subsarray_py = Py_None;
 	deltype = YDB_DEL_NODE;
@@ -1406,7 +2326,7 @@ static PyObject *delete_wrapper(PyObject *self, PyObject *args, PyObject *kwds)
 	/* Parse */
 	static char *kwlist[] = {"varname", "subsarray", "delete_type", NULL};
 	/* Parsed values are borrowed references, do not Py_DECREF them. */
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|Oi", kwlist, &varname_py, &subsarray_py, &deltype)) {
+	if (!parse_fastcall_args(args, nargs, kwnames, "O|Oi", "delete", kwlist, &varname_py, &subsarray_py, &deltype)) {
 		return NULL;
 	}
 
@@ -1414,13 +2334,11 @@ static PyObject *delete_wrapper(PyObject *self, PyObject *args, PyObject *kwds)
 	RETURN_IF_INVALID_SEQUENCE(subsarray_py, YDBPython_SubsarraySequence);
 
 	/* Setup for call */
-	INVOKE_ANYSTR_TO_BUFFER(varname_py, varname_ydb, TRUE);
-	INVOKE_POPULATE_SUBS_USED_AND_SUBSARRAY_AND_CLEANUP_VARNAME(subsarray_py, subs_used, subsarray_ydb, varname_ydb);
+	INVOKE_LOAD_YDBKEY(key, varname_py, subsarray_py);
 
 	/* Call the wrapped function */
-	status = ydb_delete_s(&varname_ydb, subs_used, subsarray_ydb, deltype);
-	YDB_FREE_BUFFER(&varname_ydb);
-	FREE_BUFFER_ARRAY(subsarray_ydb, subs_used);
+	YDBPY_CALL(status, delete, &key.varname, key.subs_used, key.subsarray, deltype);
+	free_YDBKey(&key);
 
 	if (YDB_OK != status) {
 		raise_YDBError(status);
@@ -1432,10 +2350,10 @@ static PyObject *delete_wrapper(PyObject *self, PyObject *args, PyObject *kwds)
 }
 
 /* Wrapper for ydb_delete_excl_s() */
-static PyObject *delete_excel(PyObject *self, PyObject *args, PyObject *kwds) {
-	int	      namecount, status;
-	ydb_buffer_t *varnames_ydb;
-	PyObject *    varnames_py, *ret;
+static PyObject *delete_excel(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int	     namecount, status;
+	ydb_buffer_t varnames_ydb[YDB_MAX_NAMES];
+	PyObject *   varnames_py, *varnames_owners[YDB_MAX_NAMES], *ret;
 
 	UNUSED(self);
 	ret = NULL;
@@ -1445,7 +2363,7 @@ static PyObject *delete_excel(PyObject *self, PyObject *args, PyObject *kwds) {
 	/* parse and validate */
 	static char *kwlist[] = {"varnames", NULL};
 	/* Parsed values are borrowed references, do not Py_DECREF them. */
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O", kwlist, &varnames_py)) {
+	if (!parse_fastcall_args(args, nargs, kwnames, "|O", "delete_excel", kwlist, &varnames_py)) {
 		return NULL;
 	}
 	RETURN_IF_INVALID_SEQUENCE(varnames_py, YDBPython_VarnameSequence);
@@ -1455,18 +2373,14 @@ static PyObject *delete_excel(PyObject *self, PyObject *args, PyObject *kwds) {
 	if (Py_None != varnames_py)
 		namecount = PySequence_Length(varnames_py);
 	if (0 < namecount) {
-		varnames_ydb = malloc(namecount * sizeof(ydb_buffer_t));
-		status = convert_py_sequence_to_ydb_buffer_array(varnames_py, namecount, varnames_ydb);
+		status = borrow_py_sequence_as_buffer_array(varnames_py, namecount, varnames_ydb, varnames_owners);
 		if (YDB_OK != status) {
-			FREE_BUFFER_ARRAY(varnames_ydb, namecount);
 			return NULL;
 		}
-	} else {
-		varnames_ydb = NULL;
 	}
 
-	status = ydb_delete_excl_s(namecount, varnames_ydb);
-	FREE_BUFFER_ARRAY(varnames_ydb, namecount);
+	YDBPY_CALL(status, delete_excl, namecount, varnames_ydb);
+	RELEASE_BUFFER_OWNERS(varnames_owners, namecount);
 	/* Check status for errors and raise Exception */
 	if (YDB_OK != status) {
 		raise_YDBError(status);
@@ -1478,69 +2392,72 @@ static PyObject *delete_excel(PyObject *self, PyObject *args, PyObject *kwds) {
 }
 
 /* Wrapper for ydb_get_s() */
-static PyObject *get(PyObject *self, PyObject *args, PyObject *kwds) {
-	int	      subs_used, status;
+static PyObject *get(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int	      status;
 	PyObject *    varname_py;
-	PyObject *    subsarray_py, *ret;
-	ydb_buffer_t  varname_ydb, ret_value;
-	ydb_buffer_t *subsarray_ydb;
+	PyObject *    subsarray_py, *default_py, *ret;
+	ydb_buffer_t *ret_value;
+	YDBKey	      key;
 
 	UNUSED(self);
-	ret = NULL;	      // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
-	subs_used = 0;	      // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
-	subsarray_ydb = NULL; // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
+	ret = NULL; // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
 	/* Default values for optional arguments passed from Python */
 	subsarray_py = Py_None;
+	default_py = NULL; // Distinguishes an omitted default from an explicit default of None
 
 	/* Parse */
-	static char *kwlist[] = {"varname", "subsarray", NULL};
+	static char *kwlist[] = {"varname", "subsarray", "default", NULL};
 	/* Parsed values are borrowed references, do not Py_DECREF them. */
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O", kwlist, &varname_py, &subsarray_py))
+	if (!parse_fastcall_args(args, nargs, kwnames, "O|OO", "get", kwlist, &varname_py, &subsarray_py, &default_py))
 		return NULL;
 	/* Validate */
 	RETURN_IF_INVALID_SEQUENCE(subsarray_py, YDBPython_SubsarraySequence);
 
 	/* Setup for call */
-	INVOKE_ANYSTR_TO_BUFFER(varname_py, varname_ydb, TRUE);
-	INVOKE_POPULATE_SUBS_USED_AND_SUBSARRAY_AND_CLEANUP_VARNAME(subsarray_py, subs_used, subsarray_ydb, varname_ydb);
-	YDB_MALLOC_BUFFER(&ret_value, YDBPY_DEFAULT_VALUE_LEN);
+	ret_value = get_value_buffer();
+	if (NULL == ret_value) {
+		return NULL;
+	}
+	INVOKE_LOAD_YDBKEY(key, varname_py, subsarray_py);
 
 	/* Call the wrapped function */
-	status = ydb_get_s(&varname_ydb, subs_used, subsarray_ydb, &ret_value);
-	/* Check to see if length of string was longer than YDBPY_DEFAULT_VALUE_LEN. If so, try again
-	 * with proper length */
+	YDBPY_CALL(status, get, &key.varname, key.subs_used, key.subsarray, ret_value);
+	/* Check to see if length of string was longer than the reusable value buffer. If so, grow the buffer
+	 * and try again. The buffer keeps its size for later calls, so this only happens for a new longest value. */
 	if (YDB_ERR_INVSTRLEN == status) {
-		FIX_BUFFER_LENGTH(ret_value);
+		grow_value_buffer(ret_value);
 		/* Call the wrapped function */
-		status = ydb_get_s(&varname_ydb, subs_used, subsarray_ydb, &ret_value);
+		YDBPY_CALL(status, get, &key.varname, key.subs_used, key.subsarray, ret_value);
 		assert(YDB_ERR_INVSTRLEN != status);
 	}
-	FREE_BUFFER_ARRAY(subsarray_ydb, subs_used);
-	YDB_FREE_BUFFER(&varname_ydb);
-	if (YDB_OK != status) {
+	free_YDBKey(&key);
+	if (((YDB_ERR_LVUNDEF == status) || (YDB_ERR_GVUNDEF == status)) && (NULL != default_py)) {
+		/* The node has no value and the caller supplied a default, so return that without
+		 * the cost of building an exception only for the caller to catch it.
+		 */
+		Py_INCREF(default_py);
+		ret = default_py;
+	} else if (YDB_OK != status) {
 		raise_YDBError(status);
 	} else {
 		/* Create Python object to return */
 		/* New Reference */
-		ret = Py_BuildValue("y#", ret_value.buf_addr, (Py_ssize_t)ret_value.len_used);
+		ret = Py_BuildValue("y#", ret_value->buf_addr, (Py_ssize_t)ret_value->len_used);
 	}
-	YDB_FREE_BUFFER(&ret_value);
 	return ret;
 }
 
 /* Wrapper for ydb_incr_s() */
-static PyObject *incr(PyObject *self, PyObject *args, PyObject *kwds) {
-	int	      status, subs_used;
-	Py_ssize_t    increment_py_len;
-	PyObject *    varname_py, *increment_py;
-	PyObject *    subsarray_py, *ret;
-	ydb_buffer_t  increment_ydb, ret_value, varname_ydb;
-	ydb_buffer_t *subsarray_ydb;
+static PyObject *incr(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int	     status;
+	PyObject *   varname_py, *increment_py;
+	PyObject *   subsarray_py, *ret;
+	PyObject *   increment_owner;
+	ydb_buffer_t increment_ydb, ret_value;
+	YDBKey	     key;
 
 	UNUSED(self);
-	ret = NULL;	      // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
-	subs_used = 0;	      // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
-	subsarray_ydb = NULL; // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
+	ret = NULL; // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
 	/* Default values for optional arguments passed from Python */
 	subsarray_py = Py_None;
 	increment_py = Py_None;
@@ -1548,35 +2465,31 @@ static PyObject *incr(PyObject *self, PyObject *args, PyObject *kwds) {
 	/* Parse */
 	static char *kwlist[] = {"varname", "subsarray", "increment", NULL};
 	/* Parsed values are borrowed references, do not Py_DECREF them. */
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|OO", kwlist, &varname_py, &subsarray_py, &increment_py,
-					 &increment_py_len)) {
+	if (!parse_fastcall_args(args, nargs, kwnames, "O|OO", "incr", kwlist, &varname_py, &subsarray_py, &increment_py)) {
 		return NULL;
 	}
 	/* Validate */
 	RETURN_IF_INVALID_SEQUENCE(subsarray_py, YDBPython_SubsarraySequence);
 
 	/* Setup for Call */
-	INVOKE_ANYSTR_TO_BUFFER(varname_py, varname_ydb, TRUE);
-	INVOKE_POPULATE_SUBS_USED_AND_SUBSARRAY_AND_CLEANUP_VARNAME(subsarray_py, subs_used, subsarray_ydb, varname_ydb);
+	INVOKE_LOAD_YDBKEY(key, varname_py, subsarray_py);
 	if (Py_None == increment_py) {
 		// No value was specified, or it was None, so set node to a default of 1.
-		YDB_MALLOC_BUFFER(&increment_ydb, YDBPY_DEFAULT_VALUE_LEN);
-		increment_ydb.len_used = snprintf(increment_ydb.buf_addr, YDBPY_DEFAULT_VALUE_LEN, "1");
+		YDB_LITERAL_TO_BUFFER("1", &increment_ydb);
+		increment_owner = NULL;
 	} else {
-		status = anystr_to_buffer(increment_py, &increment_ydb, FALSE);
+		status = anystr_to_borrowed_buffer(increment_py, &increment_ydb, FALSE, &increment_owner);
 		if (YDB_OK != status) {
-			YDB_FREE_BUFFER(&varname_ydb);
-			FREE_BUFFER_ARRAY(subsarray_ydb, subs_used);
+			free_YDBKey(&key);
 			return NULL;
 		}
 	}
 	YDB_MALLOC_BUFFER(&ret_value, CANONICAL_NUMBER_TO_STRING_MAX);
 
 	/* Call the wrapped function */
-	status = ydb_incr_s(&varname_ydb, subs_used, subsarray_ydb, &increment_ydb, &ret_value);
-	FREE_BUFFER_ARRAY(subsarray_ydb, subs_used);
-	YDB_FREE_BUFFER(&varname_ydb);
-	YDB_FREE_BUFFER(&increment_ydb);
+	YDBPY_CALL(status, incr, &key.varname, key.subs_used, key.subsarray, &increment_ydb, &ret_value);
+	free_YDBKey(&key);
+	Py_XDECREF(increment_owner);
 	if (YDB_OK != status) {
 		raise_YDBError(status);
 	} else {
@@ -1588,30 +2501,30 @@ static PyObject *incr(PyObject *self, PyObject *args, PyObject *kwds) {
 }
 
 /* Wrapper for ydb_lock_s() */
-static PyObject *lock(PyObject *self, PyObject *args, PyObject *kwds) {
+static PyObject *lock(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
 	bool		   return_null = false;
 	bool		   success = true;
 	int		   len_keys, status;
 	unsigned long long timeout_nsec;
 	PyObject *	   keys_py;
-	YDBKey *	   keys_ydb;
+	YDBKey		   keys_ydb[YDB_LOCK_MAX_KEYS];
 
 	UNUSED(self);
 	/* Default values for optional arguments passed from Python */
 	timeout_nsec = 0;
 	keys_py = Py_None;
-	keys_ydb = NULL;
 
 	/* parse and validate */
 	static char *kwlist[] = {"keys", "timeout_nsec", NULL};
 	/* Parsed values are borrowed references, do not Py_DECREF them. */
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OK", kwlist, &keys_py, &timeout_nsec))
+	if (!parse_fastcall_args(args, nargs, kwnames, "|OK", "lock", kwlist, &keys_py, &timeout_nsec))
 		return NULL;
 
 	if (Py_None == keys_py) {
 		len_keys = 0;
 	} else {
-		if (!is_valid_key_sequence(keys_py, YDB_LOCK_MAX_KEYS)) {
+		/* The threaded API takes two more arguments, leaving room for fewer keys */
+		if (!is_valid_key_sequence(keys_py, threaded_api ? YDB_LOCK_ST_MAX_KEYS : YDB_LOCK_MAX_KEYS)) {
 			return NULL;
 		}
 		len_keys = Py_SAFE_DOWNCAST(PySequence_Length(keys_py), Py_ssize_t, int);
@@ -1619,10 +2532,8 @@ static PyObject *lock(PyObject *self, PyObject *args, PyObject *kwds) {
 
 	/* Setup for Call */
 	if ((Py_None != keys_py) && (0 < len_keys)) {
-		keys_ydb = malloc(len_keys * sizeof(YDBKey));
 		success = load_YDBKeys_from_key_sequence(keys_py, len_keys, keys_ydb);
 		if (!success) {
-			free(keys_ydb);
 			return NULL;
 		}
 	}
@@ -1639,16 +2550,16 @@ static PyObject *lock(PyObject *self, PyObject *args, PyObject *kwds) {
 		 * initialized above.
 		 */
 		cur_index = YDB_LOCK_MIN_ARGS;
-		if (NULL != keys_ydb) {
+		if (0 < len_keys) {
 			for (cur_key = 0; cur_key < len_keys; cur_key++) {
-				arg_values.arg[cur_index] = keys_ydb[cur_key].varname;
+				arg_values.arg[cur_index] = &keys_ydb[cur_key].varname;
 				arg_values.arg[cur_index + 1] = (void *)(uintptr_t)keys_ydb[cur_key].subs_used;
 				arg_values.arg[cur_index + 2] = keys_ydb[cur_key].subsarray;
 				cur_index += YDB_LOCK_ARGS_PER_KEY;
 			}
 		}
 
-		status = ydb_call_variadic_plist_func((ydb_vplist_func)&ydb_lock_s, &arg_values);
+		status = call_variadic_plist_func(YDBPY_OP_lock, (ydb_vplist_func)&ydb_lock_s, (ydb_vplist_func)&ydb_lock_st, &arg_values);
 		/* check for errors */
 		if (YDB_LOCK_TIMEOUT == status) {
 			PyErr_SetString(YDBLockTimeoutError, "Not able to acquire all requested locks in the specified time.");
@@ -1659,7 +2570,7 @@ static PyObject *lock(PyObject *self, PyObject *args, PyObject *kwds) {
 		}
 	}
 
-	/* Free allocated memory */
+	/* Release references held by the keys */
 	free_YDBKey_array(keys_ydb, len_keys);
 
 	if (return_null) {
@@ -1671,35 +2582,30 @@ static PyObject *lock(PyObject *self, PyObject *args, PyObject *kwds) {
 }
 
 /* Wrapper for ydb_lock_decr_s() */
-static PyObject *lock_decr(PyObject *self, PyObject *args, PyObject *kwds) {
-	int	      status, subs_used;
-	PyObject *    varname_py, *subsarray_py;
-	PyObject *    ret;
-	ydb_buffer_t  varname_ydb;
-	ydb_buffer_t *subsarray_ydb;
+static PyObject *lock_decr(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int	  status;
+	PyObject *varname_py, *subsarray_py;
+	PyObject *ret;
+	YDBKey	  key;
 
 	UNUSED(self);
 	ret = NULL;
-	subs_used = 0;	      // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
-	subsarray_ydb = NULL; // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
 	/* Default values for optional arguments passed from Python */
 	subsarray_py = Py_None;
 
 	/* Parse and validate */
 	static char *kwlist[] = {"varname", "subsarray", NULL};
 	/* Parsed values are borrowed references, do not Py_DECREF them. */
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O", kwlist, &varname_py, &subsarray_py))
+	if (!parse_fastcall_args(args, nargs, kwnames, "O|O", "lock_decr", kwlist, &varname_py, &subsarray_py))
 		return NULL;
 	RETURN_IF_INVALID_SEQUENCE(subsarray_py, YDBPython_SubsarraySequence);
 
 	/* Setup for Call */
-	INVOKE_ANYSTR_TO_BUFFER(varname_py, varname_ydb, TRUE);
-	INVOKE_POPULATE_SUBS_USED_AND_SUBSARRAY_AND_CLEANUP_VARNAME(subsarray_py, subs_used, subsarray_ydb, varname_ydb);
+	INVOKE_LOAD_YDBKEY(key, varname_py, subsarray_py);
 
 	/* Call the wrapped function */
-	status = ydb_lock_decr_s(&varname_ydb, subs_used, subsarray_ydb);
-	YDB_FREE_BUFFER(&varname_ydb);
-	FREE_BUFFER_ARRAY(subsarray_ydb, subs_used);
+	YDBPY_CALL(status, lock_decr, &key.varname, key.subs_used, key.subsarray);
+	free_YDBKey(&key);
 	if (YDB_OK != status) {
 		raise_YDBError(status);
 	} else {
@@ -1710,18 +2616,15 @@ static PyObject *lock_decr(PyObject *self, PyObject *args, PyObject *kwds) {
 }
 
 /* Wrapper for ydb_lock_incr_s() */
-static PyObject *lock_incr(PyObject *self, PyObject *args, PyObject *kwds) {
-	int		   status, subs_used;
+static PyObject *lock_incr(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int		   status;
 	PyObject *	   varname_py, *subsarray_py;
 	PyObject *	   ret;
 	unsigned long long timeout_nsec;
-	ydb_buffer_t	   varname_ydb;
-	ydb_buffer_t *	   subsarray_ydb;
+	YDBKey		   key;
 
 	UNUSED(self);
 	ret = NULL;
-	subs_used = 0;	      // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
-	subsarray_ydb = NULL; // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
 	/* Default values for optional arguments passed from Python */
 	subsarray_py = Py_None;
 	timeout_nsec = 0;
@@ -1729,19 +2632,18 @@ static PyObject *lock_incr(PyObject *self, PyObject *args, PyObject *kwds) {
 	/* Parse and validate */
 	static char *kwlist[] = {"varname", "subsarray", "timeout_nsec", NULL};
 	/* Parsed values are borrowed references, do not Py_DECREF them. */
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|OK", kwlist, &varname_py, &subsarray_py, &timeout_nsec)) {
+	if (!parse_fastcall_args(args, nargs, kwnames, "O|OK", "lock_incr", kwlist, &varname_py, &subsarray_py,
+				 &timeout_nsec)) {
 		return NULL;
 	}
 	RETURN_IF_INVALID_SEQUENCE(subsarray_py, YDBPython_SubsarraySequence);
 
 	/* Setup for Call */
-	INVOKE_ANYSTR_TO_BUFFER(varname_py, varname_ydb, TRUE);
-	INVOKE_POPULATE_SUBS_USED_AND_SUBSARRAY_AND_CLEANUP_VARNAME(subsarray_py, subs_used, subsarray_ydb, varname_ydb);
+	INVOKE_LOAD_YDBKEY(key, varname_py, subsarray_py);
 
 	/* Call the wrapped function */
-	status = ydb_lock_incr_s(timeout_nsec, &varname_ydb, subs_used, subsarray_ydb);
-	YDB_FREE_BUFFER(&varname_ydb);
-	FREE_BUFFER_ARRAY(subsarray_ydb, subs_used);
+	YDBPY_CALL(status, lock_incr, timeout_nsec, &key.varname, key.subs_used, key.subsarray);
+	free_YDBKey(&key);
 	if (YDB_LOCK_TIMEOUT == status) {
 		PyErr_SetString(YDBLockTimeoutError, "Not able to acquire all requested locks in the specified time.");
 	} else if (YDB_OK != status) {
@@ -1754,559 +2656,3666 @@ static PyObject *lock_incr(PyObject *self, PyObject *args, PyObject *kwds) {
 }
 
 /* Wrapper for ydb_node_next_s() */
-static PyObject *node_next(PyObject *self, PyObject *args, PyObject *kwds) {
-	int	      max_subscript_string, ret_subsarray_num_elements, ret_subs_used, status, subs_used;
-	PyObject *    varname_py;
-	PyObject *    subsarray_py, *ret;
-	ydb_buffer_t  varname_ydb;
-	ydb_buffer_t *ret_subsarray, *subsarray_ydb;
+static PyObject *node_next(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int		ret_subs_used, status;
+	PyObject *	varname_py;
+	PyObject *	subsarray_py, *default_py, *ret;
+	ydb_buffer_t *	ret_subsarray;
+	YDBSubsBuffers *subs_buffers;
+	YDBKey		key;
 
 	UNUSED(self);
-	ret = NULL;	      // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
-	subs_used = 0;	      // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
-	subsarray_ydb = NULL; // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
+	ret = NULL; // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
 	/* Default values for optional arguments passed from Python */
 	subsarray_py = Py_None;
+	default_py = NULL; // Distinguishes an omitted default from an explicit default of None
 
 	/* Parse and validate */
-	static char *kwlist[] = {"varname", "subsarray", NULL};
+	static char *kwlist[] = {"varname", "subsarray", "default", NULL};
 	/* Parsed values are borrowed references, do not Py_DECREF them. */
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O", kwlist, &varname_py, &subsarray_py))
+	if (!parse_fastcall_args(args, nargs, kwnames, "O|OO", "node_next", kwlist, &varname_py, &subsarray_py, &default_py))
 		return NULL;
 	RETURN_IF_INVALID_SEQUENCE(subsarray_py, YDBPython_SubsarraySequence);
 
 	/* Setup for Call */
-	INVOKE_ANYSTR_TO_BUFFER(varname_py, varname_ydb, TRUE);
-	INVOKE_POPULATE_SUBS_USED_AND_SUBSARRAY_AND_CLEANUP_VARNAME(subsarray_py, subs_used, subsarray_ydb, varname_ydb);
-	max_subscript_string = YDBPY_DEFAULT_SUBSCRIPT_LEN;
-	ret_subsarray_num_elements = YDBPY_DEFAULT_SUBSCRIPT_COUNT;
-	ret_subs_used = ret_subsarray_num_elements;
-	ret_subsarray = create_empty_buffer_array(ret_subs_used, max_subscript_string);
+	subs_buffers = get_subs_buffers();
+	if (NULL == subs_buffers) {
+		return NULL;
+	}
+	INVOKE_LOAD_YDBKEY(key, varname_py, subsarray_py);
+	/* The reusable array has room for the maximum number of subscripts, so YDB_ERR_INSUFFSUBS cannot occur */
+	ret_subsarray = subs_buffers->arrays[0];
+	ret_subs_used = YDB_MAX_SUBS;
 
 	/* Call the wrapped function */
-	status = ydb_node_next_s(&varname_ydb, subs_used, subsarray_ydb, &ret_subs_used, ret_subsarray);
-	/* If not enough buffers in ret_subsarray */
-	if (YDB_ERR_INSUFFSUBS == status) {
-		FREE_BUFFER_ARRAY(ret_subsarray, ret_subsarray_num_elements);
-		ret_subsarray_num_elements = ret_subs_used;
-		ret_subsarray = create_empty_buffer_array(ret_subs_used, max_subscript_string);
-		/* Re-call the wrapped function */
-		status = ydb_node_next_s(&varname_ydb, subs_used, subsarray_ydb, &ret_subs_used, ret_subsarray);
-	}
-	/* If a buffer is not long enough */
+	YDBPY_CALL(status, node_next, &key.varname, key.subs_used, key.subsarray, &ret_subs_used, ret_subsarray);
+	/* If a buffer is not long enough, grow it and try again. Buffers keep their size for later calls, so this only
+	 * happens for a new longest subscript at a given level. */
 	while (YDB_ERR_INVSTRLEN == status) {
-		FIX_BUFFER_LENGTH(ret_subsarray[ret_subs_used]);
-		ret_subs_used = ret_subsarray_num_elements;
+		grow_value_buffer(&ret_subsarray[ret_subs_used]);
+		ret_subs_used = YDB_MAX_SUBS;
 		/* Re-call the wrapped function */
-		status = ydb_node_next_s(&varname_ydb, subs_used, subsarray_ydb, &ret_subs_used, ret_subsarray);
+		YDBPY_CALL(status, node_next, &key.varname, key.subs_used, key.subsarray, &ret_subs_used, ret_subsarray);
 	}
-	YDB_FREE_BUFFER(&varname_ydb);
-	FREE_BUFFER_ARRAY(subsarray_ydb, subs_used);
+	free_YDBKey(&key);
 	assert(YDB_ERR_INVSTRLEN != status);
 
 	/* Check status for errors and Raise Exception */
-	if (YDB_OK != status) {
+	if ((YDB_ERR_NODEEND == status) && (NULL != default_py)) {
+		/* No more nodes, so signal the end of the traversal with the default rather than by raising YDBNodeEnd */
+		Py_INCREF(default_py);
+		ret = default_py;
+	} else if (YDB_OK != status) {
 		raise_YDBError(status);
 	} else {
 		/* Create Python object to return */
 		/* New Reference */
 		ret = convert_ydb_buffer_array_to_py_tuple(ret_subsarray, ret_subs_used);
 	}
-	FREE_BUFFER_ARRAY(ret_subsarray, ret_subsarray_num_elements);
 	return ret;
 }
 
 /* Wrapper for ydb_node_previous_s() */
-static PyObject *node_previous(PyObject *self, PyObject *args, PyObject *kwds) {
-	int	      max_subscript_string, ret_subsarray_num_elements, ret_subs_used, status, subs_used;
-	PyObject *    varname_py;
-	PyObject *    subsarray_py, *ret;
-	ydb_buffer_t  varname_ydb;
-	ydb_buffer_t *ret_subsarray, *subsarray_ydb;
+static PyObject *node_previous(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int		ret_subs_used, status;
+	PyObject *	varname_py;
+	PyObject *	subsarray_py, *default_py, *ret;
+	ydb_buffer_t *	ret_subsarray;
+	YDBSubsBuffers *subs_buffers;
+	YDBKey		key;
 
 	UNUSED(self);
-	ret = NULL;	      // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
-	subs_used = 0;	      // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
-	subsarray_ydb = NULL; // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
+	ret = NULL; // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
 	/* Default values for optional arguments passed from Python */
 	subsarray_py = Py_None;
+	default_py = NULL; // Distinguishes an omitted default from an explicit default of None
 
 	/* Parse and validate */
-	static char *kwlist[] = {"varname", "subsarray", NULL};
+	static char *kwlist[] = {"varname", "subsarray", "default", NULL};
 	/* Parsed values are borrowed references, do not Py_DECREF them. */
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O", kwlist, &varname_py, &subsarray_py))
+	if (!parse_fastcall_args(args, nargs, kwnames, "O|OO", "node_previous", kwlist, &varname_py, &subsarray_py, &default_py))
 		return NULL;
 	RETURN_IF_INVALID_SEQUENCE(subsarray_py, YDBPython_SubsarraySequence);
 
 	/* Setup for Call */
-	INVOKE_ANYSTR_TO_BUFFER(varname_py, varname_ydb, TRUE);
-	INVOKE_POPULATE_SUBS_USED_AND_SUBSARRAY_AND_CLEANUP_VARNAME(subsarray_py, subs_used, subsarray_ydb, varname_ydb);
-	max_subscript_string = YDBPY_DEFAULT_SUBSCRIPT_LEN;
-	ret_subsarray_num_elements = YDBPY_DEFAULT_SUBSCRIPT_COUNT;
-	ret_subs_used = ret_subsarray_num_elements;
-	ret_subsarray = create_empty_buffer_array(ret_subs_used, max_subscript_string);
+	subs_buffers = get_subs_buffers();
+	if (NULL == subs_buffers) {
+		return NULL;
+	}
+	INVOKE_LOAD_YDBKEY(key, varname_py, subsarray_py);
+	/* The reusable array has room for the maximum number of subscripts, so YDB_ERR_INSUFFSUBS cannot occur */
+	ret_subsarray = subs_buffers->arrays[0];
+	ret_subs_used = YDB_MAX_SUBS;
 
 	/* Call the wrapped function */
-	status = ydb_node_previous_s(&varname_ydb, subs_used, subsarray_ydb, &ret_subs_used, ret_subsarray);
-	/* If not enough buffers in ret_subsarray */
-	if (YDB_ERR_INSUFFSUBS == status) {
-		FREE_BUFFER_ARRAY(ret_subsarray, ret_subsarray_num_elements);
-		ret_subsarray_num_elements = ret_subs_used;
-		ret_subsarray = create_empty_buffer_array(ret_subs_used, max_subscript_string);
-		/* Re-call the wrapped function */
-		status = ydb_node_previous_s(&varname_ydb, subs_used, subsarray_ydb, &ret_subs_used, ret_subsarray);
-	}
-	/* If a buffer is not long enough */
+	YDBPY_CALL(status, node_previous, &key.varname, key.subs_used, key.subsarray, &ret_subs_used, ret_subsarray);
+	/* If a buffer is not long enough, grow it and try again. Buffers keep their size for later calls, so this only
+	 * happens for a new longest subscript at a given level. */
 	while (YDB_ERR_INVSTRLEN == status) {
-		FIX_BUFFER_LENGTH(ret_subsarray[ret_subs_used]);
-		ret_subs_used = ret_subsarray_num_elements;
+		grow_value_buffer(&ret_subsarray[ret_subs_used]);
+		ret_subs_used = YDB_MAX_SUBS;
 		/* Re-call the wrapped function */
-		status = ydb_node_previous_s(&varname_ydb, subs_used, subsarray_ydb, &ret_subs_used, ret_subsarray);
+		YDBPY_CALL(status, node_previous, &key.varname, key.subs_used, key.subsarray, &ret_subs_used, ret_subsarray);
 	}
-	FREE_BUFFER_ARRAY(subsarray_ydb, subs_used);
-	YDB_FREE_BUFFER(&varname_ydb);
+	free_YDBKey(&key);
 	assert(YDB_ERR_INVSTRLEN != status);
 
 	/* Check status for errors and raise Exception */
-	if (YDB_OK != status) {
+	if ((YDB_ERR_NODEEND == status) && (NULL != default_py)) {
+		/* No more nodes, so signal the end of the traversal with the default rather than by raising YDBNodeEnd */
+		Py_INCREF(default_py);
+		ret = default_py;
+	} else if (YDB_OK != status) {
 		raise_YDBError(status);
 	} else {
 		/* Create Python object to return. Creates a new reference */
 		ret = convert_ydb_buffer_array_to_py_tuple(ret_subsarray, ret_subs_used);
 	}
-	FREE_BUFFER_ARRAY(ret_subsarray, ret_subsarray_num_elements);
 	return ret;
 }
 
-/* Wrapper for ydb_set_s() */
-static PyObject *set(PyObject *self, PyObject *args, PyObject *kwds) {
-	int	      status = YDB_OK, subs_used;
-	PyObject *    varname_py, *value_py, *subsarray_py;
-	PyObject *    ret;
-	ydb_buffer_t  value_ydb, varname_ydb;
-	ydb_buffer_t *subsarray_ydb;
+/* Returns whether the first `prefix_used` subscripts of `subsarray`, which has `subs_used` subscripts, are those of
+ * `prefix`, i.e. whether `subsarray` is that of the node given by `prefix` or one of its descendants.
+ */
+static bool has_subs_prefix(ydb_buffer_t *subsarray, int subs_used, ydb_buffer_t *prefix, int prefix_used) {
+	if (subs_used < prefix_used) {
+		return FALSE;
+	}
+	for (int i = 0; i < prefix_used; i++) {
+		if ((prefix[i].len_used != subsarray[i].len_used)
+		    || (0 != memcmp(prefix[i].buf_addr, subsarray[i].buf_addr, subsarray[i].len_used))) {
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/* Wrapper for ydb_node_next_s() and ydb_get_s(), used to read the nodes of a subtree in chunks. Returns a tuple of
+ * a list of up to `limit` (subscripts, value) pairs for the nodes with a value in the subtree given by `varname` and
+ * `subsarray`, in the order of ydb_node_next_s(), and the position to resume the scan from. The scan starts with the
+ * root of the subtree, or if `start` is given, with the node following `start`. If `stop` is given, the scan ends
+ * before the first node at or past the node with those subscripts in the order of ydb_node_next_s(), which bounds it
+ * to a range of the subtree whether or not `stop` exists. The resume position is the subscripts of the last node returned, to be passed as `start` to the next call, or None
+ * once the subtree or range is exhausted.
+ *
+ * Subscripts are received into the two per-thread subscript buffer arrays, which alternate between being the input
+ * and the output of ydb_node_next_s(), so that the subscripts of each node are passed back to YottaDB without any
+ * conversion.
+ */
+static PyObject *scan(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	bool		done, failed, has_stop;
+	int		status, limit, in_subs_used, out_subs_used;
+	unsigned int	data;
+	PyObject *	varname_py, *subsarray_py, *start_py, *stop_py, *pairs, *subs, *value, *pair, *resume, *ret;
+	ydb_buffer_t *	value_buffer, *in_subsarray, *out_subsarray;
+	YDBSubsBuffers *subs_buffers;
+	YDBKey		root, start, stop;
 
 	UNUSED(self);
-	ret = NULL;
-	subs_used = 0;	      // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
-	subsarray_ydb = NULL; // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
 	/* Default values for optional arguments passed from Python */
 	subsarray_py = Py_None;
-	value_py = Py_None;
+	limit = YDBPY_DEFAULT_SCAN_LIMIT;
+	start_py = Py_None;
+	stop_py = Py_None;
 
 	/* Parse and validate */
-	static char *kwlist[] = {"varname", "subsarray", "value", NULL};
+	static char *kwlist[] = {"varname", "subsarray", "limit", "start", "stop", NULL};
 	/* Parsed values are borrowed references, do not Py_DECREF them. */
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|OO", kwlist, &varname_py, &subsarray_py, &value_py)) {
+	if (!parse_fastcall_args(args, nargs, kwnames, "O|OiOO", "scan", kwlist, &varname_py, &subsarray_py, &limit, &start_py,
+				 &stop_py))
 		return NULL;
-	}
 	RETURN_IF_INVALID_SEQUENCE(subsarray_py, YDBPython_SubsarraySequence);
-
-	/* Setup for Call */
-	INVOKE_ANYSTR_TO_BUFFER(varname_py, varname_ydb, TRUE);
-	INVOKE_POPULATE_SUBS_USED_AND_SUBSARRAY_AND_CLEANUP_VARNAME(subsarray_py, subs_used, subsarray_ydb, varname_ydb);
-	if (Py_None == value_py) {
-		// No value was specified, or it was None, so set node to empty string.
-		YDB_MALLOC_BUFFER(&value_ydb, YDBPY_DEFAULT_VALUE_LEN);
-		value_ydb.buf_addr[0] = '\0';
-		value_ydb.len_used = 0;
-	} else {
-		status = anystr_to_buffer(value_py, &value_ydb, FALSE);
-		if (YDB_OK != status) {
-			FREE_BUFFER_ARRAY(subsarray_ydb, subs_used);
-			YDB_FREE_BUFFER(&varname_ydb);
-			return NULL;
-		}
+	RETURN_IF_INVALID_SEQUENCE(start_py, YDBPython_SubsarraySequence);
+	RETURN_IF_INVALID_SEQUENCE(stop_py, YDBPython_SubsarraySequence);
+	if (0 >= limit) {
+		PyErr_Format(PyExc_ValueError, YDBPY_ERR_SCAN_LIMIT, limit);
+		return NULL;
 	}
 
-	/* Call the wrapped function */
-	status = ydb_set_s(&varname_ydb, subs_used, subsarray_ydb, &value_ydb);
-	FREE_BUFFER_ARRAY(subsarray_ydb, subs_used);
-	YDB_FREE_BUFFER(&varname_ydb);
-	YDB_FREE_BUFFER(&value_ydb);
-
-	if (YDB_OK != status) {
-		raise_YDBError(status);
-	} else {
-		Py_INCREF(Py_None);
-		ret = Py_None;
+	/* Setup for calls */
+	value_buffer = get_value_buffer();
+	if (NULL == value_buffer) {
+		return NULL;
 	}
-	return ret;
-}
-
-/* Wrapper for ydb_str2zwr_s() */
-static PyObject *str2zwr(PyObject *self, PyObject *args, PyObject *kwds) {
-	int	     status;
-	Py_ssize_t   str_py_len;
-	PyObject *   str_py, *ret;
-	ydb_buffer_t str_ydb, zwr_ydb;
-
-	UNUSED(self);
-	ret = NULL;
-
-	/* Parse */
-	static char *kwlist[] = {"input", NULL};
-	/* Parsed values are borrowed references, do not Py_DECREF them. */
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|", kwlist, &str_py, &str_py_len))
+	subs_buffers = get_subs_buffers();
+	if (NULL == subs_buffers) {
 		return NULL;
+	}
+	pairs = PyList_New(0); // New Reference
+	if (NULL == pairs) {
+		return NULL;
+	}
+	if (!load_YDBKey(&root, varname_py, subsarray_py)) {
+		DECREF_AND_RETURN(pairs, NULL);
+	}
+	if ((Py_None != start_py) && !load_YDBKey(&start, varname_py, start_py)) {
+		free_YDBKey(&root);
+		DECREF_AND_RETURN(pairs, NULL);
+	}
+	if ((Py_None != stop_py) && !load_YDBKey(&stop, varname_py, stop_py)) {
+		if (Py_None != start_py) {
+			free_YDBKey(&start);
+		}
+		free_YDBKey(&root);
+		DECREF_AND_RETURN(pairs, NULL);
+	}
+	has_stop = (Py_None != stop_py);
+	done = failed = FALSE;
+	resume = NULL;
+	status = YDB_OK;
+	if (has_stop) {
+		/* As in scan_range(), locate the first node at or past `stop` with YottaDB, so that the loop below only has to
+		 * compare each node with it. That is `stop` itself or its first descendant unless it does not exist, e.g. if it
+		 * was deleted since it was passed on by parallel_scan(), in which case it is the next node. The scan then runs
+		 * to the end of the subtree if there is none.
+		 */
+		YDBPY_CALL(status, data, &root.varname, stop.subs_used, stop.subsarray, &data);
+		if ((YDB_OK == status) && (0 == data)) {
+			out_subsarray = subs_buffers->arrays[0];
+			out_subs_used = YDB_MAX_SUBS;
+			YDBPY_CALL(status, node_next, &root.varname, stop.subs_used, stop.subsarray, &out_subs_used, out_subsarray);
+			while (YDB_ERR_INVSTRLEN == status) {
+				grow_value_buffer(&out_subsarray[out_subs_used]);
+				out_subs_used = YDB_MAX_SUBS;
+				YDBPY_CALL(status, node_next, &root.varname, stop.subs_used, stop.subsarray, &out_subs_used,
+					   out_subsarray);
+			}
+			free_YDBKey(&stop);
+			has_stop = FALSE;
+			if (YDB_OK == status) {
+				/* New Reference */
+				subs = convert_ydb_buffer_array_to_py_tuple(out_subsarray, out_subs_used);
+				has_stop = (NULL != subs) && load_YDBKey(&stop, varname_py, subs);
+				failed = !has_stop;
+				Py_XDECREF(subs);
+			} else if (YDB_ERR_NODEEND == status) {
+				status = YDB_OK;
+			}
+		}
+	}
+	if ((YDB_OK != status) || failed) {
+		// Skip the scan and report the error below
+	} else if (Py_None == start_py) {
+		/* Start with the root of the subtree, which is only returned if it has a value */
+		in_subsarray = root.subsarray;
+		in_subs_used = root.subs_used;
+		YDBPY_CALL(status, get, &root.varname, root.subs_used, root.subsarray, value_buffer);
+		if (YDB_ERR_INVSTRLEN == status) {
+			grow_value_buffer(value_buffer);
+			YDBPY_CALL(status, get, &root.varname, root.subs_used, root.subsarray, value_buffer);
+			assert(YDB_ERR_INVSTRLEN != status);
+		}
+		if (YDB_OK == status) {
+			subs = convert_ydb_buffer_array_to_py_tuple(root.subsarray, root.subs_used); // New Reference
+			value = PyBytes_FromStringAndSize(value_buffer->buf_addr, value_buffer->len_used); // New Reference
+			pair = ((NULL == subs) || (NULL == value)) ? NULL : PyTuple_Pack(2, subs, value); // New Reference
+			Py_XDECREF(value);
+			if ((NULL == pair) || (0 > PyList_Append(pairs, pair))) {
+				failed = TRUE;
+			}
+			Py_XDECREF(pair);
+			resume = subs;
+		} else if ((YDB_ERR_LVUNDEF == status) || (YDB_ERR_GVUNDEF == status)) {
+			status = YDB_OK;
+		}
+	} else {
+		in_subsarray = start.subsarray;
+		in_subs_used = start.subs_used;
+	}
 
-	/* Setup for Call */
-	INVOKE_ANYSTR_TO_BUFFER(str_py, str_ydb, FALSE);
-	YDB_MALLOC_BUFFER(&zwr_ydb, YDBPY_DEFAULT_VALUE_LEN);
-
-	/* Call the wrapped function */
-	status = ydb_str2zwr_s(&str_ydb, &zwr_ydb);
-	/* Re-call with properly sized buffer if zwr_buf is not long enough */
+	for (int i = 0; (YDB_OK == status) && !failed && (PyList_GET_SIZE(pairs) < limit); i++) {
+		out_subsarray = subs_buffers->arrays[i % 2];
+		out_subs_used = YDB_MAX_SUBS;
+		YDBPY_CALL(status, node_next, &root.varname, in_subs_used, in_subsarray, &out_subs_used, out_subsarray);
+		while (YDB_ERR_INVSTRLEN == status) {
+			grow_value_buffer(&out_subsarray[out_subs_used]);
+			out_subs_used = YDB_MAX_SUBS;
+			YDBPY_CALL(status, node_next, &root.varname, in_subs_used, in_subsarray, &out_subs_used, out_subsarray);
+		}
+		if (YDB_ERR_NODEEND == status) {
+			done = TRUE;
+			status = YDB_OK;
+			break;
+		} else if (YDB_OK != status) {
+			break;
+		}
+		/* Stop at the first node outside of the subtree, or at the end of the range */
+		if ((out_subs_used <= root.subs_used)
+		    || !has_subs_prefix(out_subsarray, out_subs_used, root.subsarray, root.subs_used)
+		    || (has_stop && has_subs_prefix(out_subsarray, out_subs_used, stop.subsarray, stop.subs_used))) {
+			done = TRUE;
+			break;
+		}
+
+		YDBPY_CALL(status, get, &root.varname, out_subs_used, out_subsarray, value_buffer);
+		if (YDB_ERR_INVSTRLEN == status) {
+			grow_value_buffer(value_buffer);
+			YDBPY_CALL(status, get, &root.varname, out_subs_used, out_subsarray, value_buffer);
+			assert(YDB_ERR_INVSTRLEN != status);
+		}
+		if (YDB_OK != status) {
+			break;
+		}
+		subs = convert_ydb_buffer_array_to_py_tuple(out_subsarray, out_subs_used); // New Reference
+		value = PyBytes_FromStringAndSize(value_buffer->buf_addr, value_buffer->len_used); // New Reference
+		pair = ((NULL == subs) || (NULL == value)) ? NULL : PyTuple_Pack(2, subs, value); // New Reference
+		Py_XDECREF(value);
+		if ((NULL == pair) || (0 > PyList_Append(pairs, pair))) {
+			failed = TRUE;
+		}
+		Py_XDECREF(pair);
+		Py_XSETREF(resume, subs);
+		in_subsarray = out_subsarray;
+		in_subs_used = out_subs_used;
+	}
+	if (has_stop) {
+		free_YDBKey(&stop);
+	}
+	if (Py_None != start_py) {
+		free_YDBKey(&start);
+	}
+	free_YDBKey(&root);
+
+	if (!failed && (YDB_OK != status)) {
+		raise_YDBError(status);
+		failed = TRUE;
+	}
+	if (failed) {
+		Py_XDECREF(resume);
+		DECREF_AND_RETURN(pairs, NULL);
+	}
+	if (done || (NULL == resume)) {
+		/* The subtree is exhausted, so there is nothing to resume from */
+		Py_XDECREF(resume);
+		Py_INCREF(Py_None);
+		resume = Py_None;
+	}
+	ret = PyTuple_Pack(2, pairs, resume); // New Reference
+	Py_DECREF(pairs);
+	Py_DECREF(resume);
+	return ret;
+}
+
+/* Get the next or previous subscript after the last of the `subs_used` subscripts in `subsarray` into `ret_value`,
+ * growing it if needed. Returns the status of the ydb_subscript_next_s() or ydb_subscript_previous_s() call.
+ */
+static int subscript_order(ydb_buffer_t *varname, int subs_used, ydb_buffer_t *subsarray, ydb_buffer_t *ret_value, bool reverse) {
+	int status;
+
+	if (reverse) {
+		YDBPY_CALL(status, subscript_previous, varname, subs_used, subsarray, ret_value);
+	} else {
+		YDBPY_CALL(status, subscript_next, varname, subs_used, subsarray, ret_value);
+	}
 	if (YDB_ERR_INVSTRLEN == status) {
-		FIX_BUFFER_LENGTH(zwr_ydb);
-		/* recall the wrapped function */
-		status = ydb_str2zwr_s(&str_ydb, &zwr_ydb);
+		grow_value_buffer(ret_value);
+		if (reverse) {
+			YDBPY_CALL(status, subscript_previous, varname, subs_used, subsarray, ret_value);
+		} else {
+			YDBPY_CALL(status, subscript_next, varname, subs_used, subsarray, ret_value);
+		}
 		assert(YDB_ERR_INVSTRLEN != status);
 	}
-	YDB_FREE_BUFFER(&str_ydb);
+	return status;
+}
 
-	/* Check status for Errors and Raise Exception */
-	if (YDB_OK != status) {
+/* Wrapper for ydb_subscript_next_s() or ydb_subscript_previous_s() and ydb_get_s(), used to page through the
+ * subscripts at the level below `subs_prefix`. Returns a tuple of a list of up to `limit` (subscript, value) pairs,
+ * with a value of None for nodes that only have descendants, and a continuation token, which is the last subscript
+ * returned, to be passed as `token` to get the next page, or None once the range is exhausted.
+ *
+ * The range starts at `start`, inclusive, and ends before `stop`, in the collation order of YottaDB, or in reverse
+ * order if `reverse` is True. Neither bound needs to exist: each is first located with YottaDB, so that the native
+ * loop only has to compare each subscript with the first one at or past `stop`, and paging with a token costs as
+ * much as the page itself, whatever its offset in the range.
+ */
+static PyObject *scan_range(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	bool		done, failed, include_start;
+	int		status, limit, reverse, depth;
+	unsigned int	data;
+	PyObject *	varname_py, *prefix_py, *start_py, *stop_py, *token_py, *pairs, *subscript, *value, *pair, *ret;
+	PyObject *	start_owner, *stop_owner, *token_owner, *stop_subscript;
+	ydb_buffer_t	*last, *value_buffer, *out_buffer;
+	YDBSubsBuffers *subs_buffers;
+	YDBKey		key;
+
+	UNUSED(self);
+	/* Default values for optional arguments passed from Python */
+	prefix_py = Py_None;
+	start_py = stop_py = token_py = Py_None;
+	limit = YDBPY_DEFAULT_SCAN_LIMIT;
+	reverse = FALSE;
+
+	/* Parse and validate */
+	static char *kwlist[] = {"varname", "subs_prefix", "start", "stop", "limit", "reverse", "token", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!parse_fastcall_args(args, nargs, kwnames, "O|OOOipO", "scan_range", kwlist, &varname_py, &prefix_py, &start_py,
+				 &stop_py, &limit, &reverse, &token_py))
+		return NULL;
+	RETURN_IF_INVALID_SEQUENCE(prefix_py, YDBPython_SubsarraySequence);
+	if (0 >= limit) {
+		PyErr_Format(PyExc_ValueError, YDBPY_ERR_SCAN_LIMIT, limit);
+		return NULL;
+	}
+
+	/* Setup for calls */
+	value_buffer = get_value_buffer();
+	if (NULL == value_buffer) {
+		return NULL;
+	}
+	subs_buffers = get_subs_buffers();
+	if (NULL == subs_buffers) {
+		return NULL;
+	}
+	INVOKE_LOAD_YDBKEY(key, varname_py, prefix_py);
+	if (YDB_MAX_SUBS <= key.subs_used) {
+		free_YDBKey(&key);
+		raise_ValidationError(YDBPython_ValueError, "'subs_prefix' argument invalid: ", YDBPY_ERR_SEQUENCE_TOO_LONG,
+				      (long)key.subs_used, YDB_MAX_SUBS - 1);
+		return NULL;
+	}
+	depth = key.subs_used + 1;
+	last = &key.subsarray[key.subs_used];
+	start_owner = stop_owner = token_owner = stop_subscript = NULL;
+	status = YDB_OK;
+	failed = FALSE;
+
+	/* Locate the first subscript at or past `stop`, if any, which ends the range */
+	if (Py_None != stop_py) {
+		if (YDB_OK != anystr_to_borrowed_buffer(stop_py, last, FALSE, &stop_owner)) {
+			free_YDBKey(&key);
+			return NULL;
+		}
+		YDBPY_CALL(status, data, &key.varname, depth, key.subsarray, &data);
+		if ((YDB_OK == status) && (YDB_DATA_UNDEF != data)) {
+			stop_subscript = PyBytes_FromStringAndSize(last->buf_addr, last->len_used); // New Reference
+			failed = (NULL == stop_subscript);
+		} else if (YDB_OK == status) {
+			status = subscript_order(&key.varname, depth, key.subsarray, value_buffer, reverse);
+			if (YDB_OK == status) {
+				stop_subscript = PyBytes_FromStringAndSize(value_buffer->buf_addr, value_buffer->len_used); // New Reference
+				failed = (NULL == stop_subscript);
+			} else if (YDB_ERR_NODEEND == status) {
+				/* Nothing at or past `stop`, so the range runs to the end of the level */
+				status = YDB_OK;
+			}
+		}
+		Py_DECREF(stop_owner);
+	}
+
+	/* Position the scan before its first subscript: after the token of the previous page, before `start` or,
+	 * when `start` exists, at `start` itself.
+	 */
+	include_start = FALSE;
+	if ((YDB_OK == status) && !failed) {
+		if (Py_None != token_py) {
+			failed = (YDB_OK != anystr_to_borrowed_buffer(token_py, last, FALSE, &token_owner));
+		} else if (Py_None != start_py) {
+			failed = (YDB_OK != anystr_to_borrowed_buffer(start_py, last, FALSE, &start_owner));
+			if (!failed) {
+				YDBPY_CALL(status, data, &key.varname, depth, key.subsarray, &data);
+				include_start = (YDB_OK == status) && (YDB_DATA_UNDEF != data);
+			}
+		} else {
+			YDB_LITERAL_TO_BUFFER("", last);
+		}
+	}
+
+	pairs = failed ? NULL : PyList_New(0); // New Reference
+	failed = (NULL == pairs);
+	done = FALSE;
+	for (int i = 0; (YDB_OK == status) && !failed && (PyList_GET_SIZE(pairs) < limit); i++) {
+		if (include_start) {
+			include_start = FALSE;
+		} else {
+			out_buffer = &subs_buffers->arrays[i % 2][0];
+			status = subscript_order(&key.varname, depth, key.subsarray, out_buffer, reverse);
+			if (YDB_ERR_NODEEND == status) {
+				done = TRUE;
+				status = YDB_OK;
+				break;
+			} else if (YDB_OK != status) {
+				break;
+			}
+			*last = *out_buffer;
+		}
+		if ((NULL != stop_subscript) && (last->len_used == (unsigned int)PyBytes_GET_SIZE(stop_subscript))
+		    && (0 == memcmp(last->buf_addr, PyBytes_AS_STRING(stop_subscript), last->len_used))) {
+			done = TRUE;
+			break;
+		}
+
+		YDBPY_CALL(status, get, &key.varname, depth, key.subsarray, value_buffer);
+		if (YDB_ERR_INVSTRLEN == status) {
+			grow_value_buffer(value_buffer);
+			YDBPY_CALL(status, get, &key.varname, depth, key.subsarray, value_buffer);
+			assert(YDB_ERR_INVSTRLEN != status);
+		}
+		if (YDB_OK == status) {
+			value = PyBytes_FromStringAndSize(value_buffer->buf_addr, value_buffer->len_used); // New Reference
+		} else if ((YDB_ERR_LVUNDEF == status) || (YDB_ERR_GVUNDEF == status)) {
+			status = YDB_OK;
+			Py_INCREF(Py_None);
+			value = Py_None;
+		} else {
+			break;
+		}
+		subscript = PyBytes_FromStringAndSize(last->buf_addr, last->len_used); // New Reference
+		pair = ((NULL == subscript) || (NULL == value)) ? NULL : PyTuple_Pack(2, subscript, value); // New Reference
+		Py_XDECREF(subscript);
+		Py_XDECREF(value);
+		if ((NULL == pair) || (0 > PyList_Append(pairs, pair))) {
+			failed = TRUE;
+		}
+		Py_XDECREF(pair);
+	}
+	Py_XDECREF(start_owner);
+	Py_XDECREF(token_owner);
+	Py_XDECREF(stop_subscript);
+	free_YDBKey(&key);
+
+	if (!failed && (YDB_OK != status)) {
 		raise_YDBError(status);
+		failed = TRUE;
+	}
+	if (failed) {
+		Py_XDECREF(pairs);
+		return NULL;
+	}
+	if (done || (0 == PyList_GET_SIZE(pairs))) {
+		/* The range is exhausted, so there is nothing to resume from */
+		ret = Py_BuildValue("(OO)", pairs, Py_None); // New Reference
 	} else {
-		/* Create Python object to return. Creates a new reference */
-		ret = Py_BuildValue("y#", zwr_ydb.buf_addr, (Py_ssize_t)zwr_ydb.len_used);
+		pair = PyList_GET_ITEM(pairs, PyList_GET_SIZE(pairs) - 1); // Borrowed Reference
+		ret = Py_BuildValue("(OO)", pairs, PyTuple_GET_ITEM(pair, 0)); // New Reference
 	}
-	YDB_FREE_BUFFER(&zwr_ydb);
+	Py_DECREF(pairs);
 	return ret;
 }
 
-/* Wrapper for ydb_subscript_next_s() */
-static PyObject *subscript_next(PyObject *self, PyObject *args, PyObject *kwds) {
-	int	      status, subs_used;
-	PyObject *    varname_py;
-	PyObject *    subsarray_py, *ret;
-	ydb_buffer_t  ret_value, varname_ydb;
-	ydb_buffer_t *subsarray_ydb;
+/* Get or add the dictionary stored in `parent` under the subscript in `sub`, decoded as UTF-8, for load_tree().
+ * Returns a borrowed reference to the dictionary, or NULL with a Python exception raised.
+ */
+static PyObject *get_subtree_dict(PyObject *parent, ydb_buffer_t *sub) {
+	PyObject *key, *child, *existing;
+
+	key = PyUnicode_DecodeUTF8(sub->buf_addr, sub->len_used, NULL); // New Reference
+	if (NULL == key) {
+		return NULL;
+	}
+	child = PyDict_New(); // New Reference
+	if (NULL == child) {
+		DECREF_AND_RETURN(key, NULL);
+	}
+	existing = PyDict_SetDefault(parent, key, child); // Borrowed Reference
+	Py_DECREF(key);
+	Py_DECREF(child);
+	if ((NULL != existing) && !PyDict_Check(existing)) {
+		PyErr_Format(PyExc_TypeError, YDBPY_ERR_TREE_NOT_DICT, (int)sub->len_used, sub->buf_addr);
+		return NULL;
+	}
+	return existing;
+}
+
+/* Store the value in `value_buffer`, decoded as UTF-8, under the "value" key of `tree` for load_tree().
+ * Returns TRUE on success, or FALSE with a Python exception raised.
+ */
+static bool set_tree_value(PyObject *tree, ydb_buffer_t *value_buffer) {
+	PyObject *value;
+	int	  status;
+
+	value = PyUnicode_DecodeUTF8(value_buffer->buf_addr, value_buffer->len_used, NULL); // New Reference
+	if (NULL == value) {
+		return FALSE;
+	}
+	status = PyDict_SetItemString(tree, "value", value);
+	Py_DECREF(value);
+	return (0 == status);
+}
+
+/* Wrapper for ydb_node_next_s() and ydb_get_s(), used to load the subtree given by `varname` and `subsarray` into
+ * `tree`, a dictionary nesting one dictionary per subscript, keyed by the subscript decoded as UTF-8, in which the
+ * value of each node, also decoded, is stored under the "value" key. The value of the root of the subtree is only
+ * stored if `include_root` is True. Returns `tree`, or a new dictionary if it is None.
+ *
+ * The subtree is read with a single ydb_node_next_s() walk, in which the dictionary of each level of the previous
+ * node is kept, so that each node only looks up the levels in which its subscripts differ from those of the previous
+ * node. As in scan(), the two per-thread subscript buffer arrays alternate between input and output.
+ */
+static PyObject *load_tree(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	bool		failed;
+	int		status, include_root, in_subs_used, out_subs_used, common;
+	PyObject *	varname_py, *subsarray_py, *tree;
+	PyObject *	levels[YDB_MAX_SUBS + 1];
+	ydb_buffer_t *	value_buffer, *in_subsarray, *out_subsarray;
+	YDBSubsBuffers *subs_buffers;
+	YDBKey		root;
 
 	UNUSED(self);
-	ret = NULL;	      // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
-	subs_used = 0;	      // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
-	subsarray_ydb = NULL; // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
 	/* Default values for optional arguments passed from Python */
 	subsarray_py = Py_None;
+	tree = Py_None;
+	include_root = TRUE;
 
 	/* Parse and validate */
-	static char *kwlist[] = {"varname", "subsarray", NULL};
+	static char *kwlist[] = {"varname", "subsarray", "tree", "include_root", NULL};
 	/* Parsed values are borrowed references, do not Py_DECREF them. */
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O", kwlist, &varname_py, &subsarray_py)) {
+	if (!parse_fastcall_args(args, nargs, kwnames, "O|OOp", "load_tree", kwlist, &varname_py, &subsarray_py, &tree,
+				 &include_root))
 		return NULL;
-	}
 	RETURN_IF_INVALID_SEQUENCE(subsarray_py, YDBPython_SubsarraySequence);
+	if ((Py_None != tree) && !PyDict_Check(tree)) {
+		PyErr_SetString(PyExc_TypeError, YDBPY_ERR_TREE_NOT_DICT_ARG);
+		return NULL;
+	}
 
-	/* Setup for Call */
-	INVOKE_ANYSTR_TO_BUFFER(varname_py, varname_ydb, TRUE);
-	INVOKE_POPULATE_SUBS_USED_AND_SUBSARRAY_AND_CLEANUP_VARNAME(subsarray_py, subs_used, subsarray_ydb, varname_ydb);
-	YDB_MALLOC_BUFFER(&ret_value, YDBPY_DEFAULT_SUBSCRIPT_LEN);
+	/* Setup for calls */
+	value_buffer = get_value_buffer();
+	if (NULL == value_buffer) {
+		return NULL;
+	}
+	subs_buffers = get_subs_buffers();
+	if (NULL == subs_buffers) {
+		return NULL;
+	}
+	if (Py_None == tree) {
+		tree = PyDict_New(); // New Reference
+		if (NULL == tree) {
+			return NULL;
+		}
+	} else {
+		Py_INCREF(tree);
+	}
+	if (!load_YDBKey(&root, varname_py, subsarray_py)) {
+		DECREF_AND_RETURN(tree, NULL);
+	}
+	levels[0] = tree;
+	failed = FALSE;
+	status = YDB_OK;
+	if (include_root) {
+		YDBPY_CALL(status, get, &root.varname, root.subs_used, root.subsarray, value_buffer);
+		if (YDB_ERR_INVSTRLEN == status) {
+			grow_value_buffer(value_buffer);
+			YDBPY_CALL(status, get, &root.varname, root.subs_used, root.subsarray, value_buffer);
+			assert(YDB_ERR_INVSTRLEN != status);
+		}
+		if (YDB_OK == status) {
+			failed = !set_tree_value(tree, value_buffer);
+		} else if ((YDB_ERR_LVUNDEF == status) || (YDB_ERR_GVUNDEF == status)) {
+			status = YDB_OK;
+		}
+	}
 
-	/* Call the wrapped function */
-	status = ydb_subscript_next_s(&varname_ydb, subs_used, subsarray_ydb, &ret_value);
-	/* Check whether length of string was longer than YDBPY_DEFAULT_SUBSCRIPT_LEN is so, try again
-	 * with proper length */
+	in_subsarray = root.subsarray;
+	in_subs_used = root.subs_used;
+	for (int i = 0; (YDB_OK == status) && !failed; i++) {
+		out_subsarray = subs_buffers->arrays[i % 2];
+		out_subs_used = YDB_MAX_SUBS;
+		YDBPY_CALL(status, node_next, &root.varname, in_subs_used, in_subsarray, &out_subs_used, out_subsarray);
+		while (YDB_ERR_INVSTRLEN == status) {
+			grow_value_buffer(&out_subsarray[out_subs_used]);
+			out_subs_used = YDB_MAX_SUBS;
+			YDBPY_CALL(status, node_next, &root.varname, in_subs_used, in_subsarray, &out_subs_used, out_subsarray);
+		}
+		if (YDB_ERR_NODEEND == status) {
+			status = YDB_OK;
+			break;
+		} else if (YDB_OK != status) {
+			break;
+		}
+		/* Stop at the first node outside of the subtree */
+		if ((out_subs_used <= root.subs_used) || !has_subs_prefix(out_subsarray, out_subs_used, root.subsarray, root.subs_used)) {
+			break;
+		}
+
+		YDBPY_CALL(status, get, &root.varname, out_subs_used, out_subsarray, value_buffer);
+		if (YDB_ERR_INVSTRLEN == status) {
+			grow_value_buffer(value_buffer);
+			YDBPY_CALL(status, get, &root.varname, out_subs_used, out_subsarray, value_buffer);
+			assert(YDB_ERR_INVSTRLEN != status);
+		}
+		if (YDB_OK != status) {
+			break;
+		}
+		/* Reuse the dictionaries of the levels shared with the previous node, then add or look up the others */
+		common = root.subs_used;
+		while ((common < in_subs_used) && (common < out_subs_used)
+		       && (in_subsarray[common].len_used == out_subsarray[common].len_used)
+		       && (0 == memcmp(in_subsarray[common].buf_addr, out_subsarray[common].buf_addr, out_subsarray[common].len_used))) {
+			common++;
+		}
+		for (int level = common; !failed && (level < out_subs_used); level++) {
+			levels[level - root.subs_used + 1] = get_subtree_dict(levels[level - root.subs_used], &out_subsarray[level]);
+			failed = (NULL == levels[level - root.subs_used + 1]);
+		}
+		if (!failed) {
+			failed = !set_tree_value(levels[out_subs_used - root.subs_used], value_buffer);
+		}
+		in_subsarray = out_subsarray;
+		in_subs_used = out_subs_used;
+	}
+	free_YDBKey(&root);
+
+	if (!failed && (YDB_OK != status)) {
+		raise_YDBError(status);
+		failed = TRUE;
+	}
+	if (failed) {
+		DECREF_AND_RETURN(tree, NULL);
+	}
+	return tree;
+}
+
+/* Write out the contents of the output buffer of `writer` with write(2), releasing the GIL while doing so.
+ * Returns FALSE with a Python exception raised on error.
+ */
+static bool flush_zwr_output(YDBZwrWriter *writer) {
+	char *	pos;
+	ssize_t written;
+	int	save_errno;
+
+	pos = writer->buf;
+	while (pos < writer->buf + writer->used) {
+		Py_BEGIN_ALLOW_THREADS;
+		written = write(writer->fd, pos, writer->buf + writer->used - pos);
+		save_errno = errno;
+		Py_END_ALLOW_THREADS;
+		if (0 > written) {
+			if (EINTR == save_errno) {
+				if (0 > PyErr_CheckSignals()) {
+					return FALSE;
+				}
+				continue;
+			}
+			errno = save_errno;
+			PyErr_SetFromErrno(PyExc_OSError);
+			return FALSE;
+		}
+		pos += written;
+	}
+	writer->used = 0;
+	return TRUE;
+}
+
+/* Append `len` bytes at `data` to the output buffer of `writer`, writing out the buffer first if they do not fit.
+ * Returns FALSE with a Python exception raised on error.
+ */
+static bool append_zwr_output(YDBZwrWriter *writer, const char *data, size_t len) {
+	while (writer->size - writer->used < len) {
+		size_t part = writer->size - writer->used;
+
+		/* Fill the buffer up, so that each write(2) is of the full chunk size */
+		memcpy(writer->buf + writer->used, data, part);
+		writer->used += part;
+		data += part;
+		len -= part;
+		if (!flush_zwr_output(writer)) {
+			return FALSE;
+		}
+	}
+	memcpy(writer->buf + writer->used, data, len);
+	writer->used += len;
+	return TRUE;
+}
+
+/* Append `str` to the output buffer of `writer` in $ZWRITE format, as converted by ydb_str2zwr_s() into `zwr`.
+ * Returns FALSE with a Python exception raised on error.
+ */
+static bool append_zwr_string(YDBZwrWriter *writer, ydb_buffer_t *str, ydb_buffer_t *zwr) {
+	int status;
+
+	YDBPY_CALL(status, str2zwr, str, zwr);
 	if (YDB_ERR_INVSTRLEN == status) {
-		FIX_BUFFER_LENGTH(ret_value);
-		/* recall the wrapped function */
-		status = ydb_subscript_next_s(&varname_ydb, subs_used, subsarray_ydb, &ret_value);
+		grow_value_buffer(zwr);
+		YDBPY_CALL(status, str2zwr, str, zwr);
 		assert(YDB_ERR_INVSTRLEN != status);
 	}
-	FREE_BUFFER_ARRAY(subsarray_ydb, subs_used);
-	YDB_FREE_BUFFER(&varname_ydb);
-
 	if (YDB_OK != status) {
 		raise_YDBError(status);
-	} else {
-		/* Create Python object to return. Creates new reference */
-		ret = Py_BuildValue("y#", ret_value.buf_addr, (Py_ssize_t)ret_value.len_used);
+		return FALSE;
 	}
-	YDB_FREE_BUFFER(&ret_value);
-	return ret;
+	return append_zwr_output(writer, zwr->buf_addr, zwr->len_used);
 }
 
-/* Wrapper for ydb_subscript_previous_s() */
-static PyObject *subscript_previous(PyObject *self, PyObject *args, PyObject *kwds) {
-	int	      status, subs_used;
-	PyObject *    varname_py;
-	PyObject *    subsarray_py, *ret;
-	ydb_buffer_t  ret_value, varname_ydb;
-	ydb_buffer_t *subsarray_ydb;
+/* Append the line of ZWR format for the node given by `varname` and `subsarray`, whose value is `value`, to the output
+ * buffer of `writer`, e.g. ^g("a",1)="value". Returns FALSE with a Python exception raised on error.
+ */
+static bool append_zwr_node(YDBZwrWriter *writer, ydb_buffer_t *varname, int subs_used, ydb_buffer_t *subsarray,
+			    ydb_buffer_t *value, ydb_buffer_t *zwr) {
+	if (!append_zwr_output(writer, varname->buf_addr, varname->len_used)) {
+		return FALSE;
+	}
+	for (int i = 0; i < subs_used; i++) {
+		if (!append_zwr_output(writer, (0 == i) ? "(" : ",", 1) || !append_zwr_string(writer, &subsarray[i], zwr)) {
+			return FALSE;
+		}
+	}
+	if ((0 < subs_used) && !append_zwr_output(writer, ")", 1)) {
+		return FALSE;
+	}
+	return append_zwr_output(writer, "=", 1) && append_zwr_string(writer, value, zwr) && append_zwr_output(writer, "\n", 1);
+}
+
+/* Wrapper for ydb_node_next_s(), ydb_get_s() and ydb_str2zwr_s(), used to export the subtree given by `varname` and
+ * `subsarray` to `file`, either a file descriptor or an object with a fileno() method, in ZWR format, i.e. one line
+ * per node with a value, in the order of ydb_node_next_s(). Lines are formatted into a buffer of `chunk_size` bytes,
+ * which is written out with write(2) each time it is full, so that memory use does not depend on the size of the
+ * subtree. Returns the number of nodes exported.
+ */
+static PyObject *export_zwr(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	bool		failed;
+	int		status, in_subs_used, out_subs_used;
+	unsigned long	chunk_size, count;
+	PyObject *	varname_py, *subsarray_py, *file_py, *ret;
+	ydb_buffer_t *	value_buffer, *in_subsarray, *out_subsarray, zwr;
+	YDBSubsBuffers *subs_buffers;
+	YDBZwrWriter	writer;
+	YDBKey		root;
 
 	UNUSED(self);
-	ret = NULL;	      // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
-	subs_used = 0;	      // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
-	subsarray_ydb = NULL; // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
 	/* Default values for optional arguments passed from Python */
-	subsarray_py = Py_None;
+	chunk_size = YDBPY_DEFAULT_ZWR_CHUNK_SIZE;
 
 	/* Parse and validate */
-	static char *kwlist[] = {"varname", "subsarray", NULL};
+	static char *kwlist[] = {"varname", "subsarray", "file", "chunk_size", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!parse_fastcall_args(args, nargs, kwnames, "OOO|k", "export_zwr", kwlist, &varname_py, &subsarray_py, &file_py,
+				 &chunk_size))
+		return NULL;
+	RETURN_IF_INVALID_SEQUENCE(subsarray_py, YDBPython_SubsarraySequence);
+	if (0 == chunk_size) {
+		PyErr_Format(PyExc_ValueError, YDBPY_ERR_CHUNK_SIZE, chunk_size);
+		return NULL;
+	}
+	writer.fd = PyObject_AsFileDescriptor(file_py);
+	if (0 > writer.fd) {
+		return NULL;
+	}
+	if (!PyLong_Check(file_py)) {
+		/* Write out anything left in the buffer of a file object before writing to its file descriptor directly */
+		ret = PyObject_CallMethod(file_py, "flush", NULL); // New Reference
+		if (NULL == ret) {
+			return NULL;
+		}
+		Py_DECREF(ret);
+	}
+
+	/* Setup for calls */
+	value_buffer = get_value_buffer();
+	if (NULL == value_buffer) {
+		return NULL;
+	}
+	subs_buffers = get_subs_buffers();
+	if (NULL == subs_buffers) {
+		return NULL;
+	}
+	writer.buf = malloc(chunk_size);
+	if (NULL == writer.buf) {
+		return PyErr_NoMemory();
+	}
+	writer.size = chunk_size;
+	writer.used = 0;
+	if (!load_YDBKey(&root, varname_py, subsarray_py)) {
+		free(writer.buf);
+		return NULL;
+	}
+	YDB_MALLOC_BUFFER(&zwr, YDBPY_DEFAULT_VALUE_LEN);
+	failed = FALSE;
+	count = 0;
+
+	/* Start with the root of the subtree, which is only exported if it has a value */
+	YDBPY_CALL(status, get, &root.varname, root.subs_used, root.subsarray, value_buffer);
+	if (YDB_ERR_INVSTRLEN == status) {
+		grow_value_buffer(value_buffer);
+		YDBPY_CALL(status, get, &root.varname, root.subs_used, root.subsarray, value_buffer);
+		assert(YDB_ERR_INVSTRLEN != status);
+	}
+	if (YDB_OK == status) {
+		failed = !append_zwr_node(&writer, &root.varname, root.subs_used, root.subsarray, value_buffer, &zwr);
+		count++;
+	} else if ((YDB_ERR_LVUNDEF == status) || (YDB_ERR_GVUNDEF == status)) {
+		status = YDB_OK;
+	}
+
+	in_subsarray = root.subsarray;
+	in_subs_used = root.subs_used;
+	for (int i = 0; (YDB_OK == status) && !failed; i++) {
+		out_subsarray = subs_buffers->arrays[i % 2];
+		out_subs_used = YDB_MAX_SUBS;
+		YDBPY_CALL(status, node_next, &root.varname, in_subs_used, in_subsarray, &out_subs_used, out_subsarray);
+		while (YDB_ERR_INVSTRLEN == status) {
+			grow_value_buffer(&out_subsarray[out_subs_used]);
+			out_subs_used = YDB_MAX_SUBS;
+			YDBPY_CALL(status, node_next, &root.varname, in_subs_used, in_subsarray, &out_subs_used, out_subsarray);
+		}
+		if (YDB_ERR_NODEEND == status) {
+			status = YDB_OK;
+			break;
+		} else if (YDB_OK != status) {
+			break;
+		}
+		/* Stop at the first node outside of the subtree */
+		if ((out_subs_used <= root.subs_used) || !has_subs_prefix(out_subsarray, out_subs_used, root.subsarray, root.subs_used)) {
+			break;
+		}
+
+		YDBPY_CALL(status, get, &root.varname, out_subs_used, out_subsarray, value_buffer);
+		if (YDB_ERR_INVSTRLEN == status) {
+			grow_value_buffer(value_buffer);
+			YDBPY_CALL(status, get, &root.varname, out_subs_used, out_subsarray, value_buffer);
+			assert(YDB_ERR_INVSTRLEN != status);
+		}
+		if (YDB_OK != status) {
+			break;
+		}
+		failed = !append_zwr_node(&writer, &root.varname, out_subs_used, out_subsarray, value_buffer, &zwr);
+		count++;
+		in_subsarray = out_subsarray;
+		in_subs_used = out_subs_used;
+	}
+	if (!failed && (YDB_OK == status)) {
+		failed = !flush_zwr_output(&writer);
+	}
+	YDB_FREE_BUFFER(&zwr);
+	free_YDBKey(&root);
+	free(writer.buf);
+
+	if (!failed && (YDB_OK != status)) {
+		raise_YDBError(status);
+		failed = TRUE;
+	}
+	if (failed) {
+		return NULL;
+	}
+	return PyLong_FromUnsignedLong(count);
+}
+
+/* Wrapper for ydb_set_s() */
+static PyObject *set(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int	     status = YDB_OK;
+	PyObject *   varname_py, *value_py, *subsarray_py;
+	PyObject *   ret;
+	PyObject *   value_owner;
+	ydb_buffer_t value_ydb;
+	YDBKey	     key;
+
+	UNUSED(self);
+	ret = NULL;
+	/* Default values for optional arguments passed from Python */
+	subsarray_py = Py_None;
+	value_py = Py_None;
+
+	/* Parse and validate */
+	static char *kwlist[] = {"varname", "subsarray", "value", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!parse_fastcall_args(args, nargs, kwnames, "O|OO", "set", kwlist, &varname_py, &subsarray_py, &value_py)) {
+		return NULL;
+	}
+	RETURN_IF_INVALID_SEQUENCE(subsarray_py, YDBPython_SubsarraySequence);
+
+	/* Setup for Call */
+	INVOKE_LOAD_YDBKEY(key, varname_py, subsarray_py);
+	if (Py_None == value_py) {
+		// No value was specified, or it was None, so set node to empty string.
+		YDB_LITERAL_TO_BUFFER("", &value_ydb);
+		value_owner = NULL;
+	} else {
+		status = anystr_to_borrowed_buffer(value_py, &value_ydb, FALSE, &value_owner);
+		if (YDB_OK != status) {
+			free_YDBKey(&key);
+			return NULL;
+		}
+	}
+
+	/* Call the wrapped function */
+	YDBPY_CALL(status, set, &key.varname, key.subs_used, key.subsarray, &value_ydb);
+	free_YDBKey(&key);
+	Py_XDECREF(value_owner);
+
+	if (YDB_OK != status) {
+		raise_YDBError(status);
+	} else {
+		Py_INCREF(Py_None);
+		ret = Py_None;
+	}
+	return ret;
+}
+
+/* Wrapper for ydb_str2zwr_s() */
+static PyObject *str2zwr(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int	     status;
+	PyObject *   str_py, *str_owner, *ret;
+	ydb_buffer_t str_ydb, *zwr_ydb;
+
+	UNUSED(self);
+	ret = NULL;
+
+	/* Parse */
+	static char *kwlist[] = {"input", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!parse_fastcall_args(args, nargs, kwnames, "O", "str2zwr", kwlist, &str_py))
+		return NULL;
+
+	/* Setup for Call */
+	zwr_ydb = get_value_buffer();
+	if (NULL == zwr_ydb) {
+		return NULL;
+	}
+	INVOKE_ANYSTR_TO_BORROWED_BUFFER(str_py, str_ydb, FALSE, str_owner);
+
+	/* Call the wrapped function */
+	YDBPY_CALL(status, str2zwr, &str_ydb, zwr_ydb);
+	/* Re-call with properly sized buffer if zwr_buf is not long enough */
+	if (YDB_ERR_INVSTRLEN == status) {
+		grow_value_buffer(zwr_ydb);
+		/* recall the wrapped function */
+		YDBPY_CALL(status, str2zwr, &str_ydb, zwr_ydb);
+		assert(YDB_ERR_INVSTRLEN != status);
+	}
+	Py_DECREF(str_owner);
+
+	/* Check status for Errors and Raise Exception */
+	if (YDB_OK != status) {
+		raise_YDBError(status);
+	} else {
+		/* Create Python object to return. Creates a new reference */
+		ret = Py_BuildValue("y#", zwr_ydb->buf_addr, (Py_ssize_t)zwr_ydb->len_used);
+	}
+	return ret;
+}
+
+/* Wrapper for ydb_subscript_next_s() */
+static PyObject *subscript_next(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int	      status;
+	PyObject *    varname_py;
+	PyObject *    subsarray_py, *default_py, *ret;
+	ydb_buffer_t *ret_value;
+	YDBKey	      key;
+
+	UNUSED(self);
+	ret = NULL; // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
+	/* Default values for optional arguments passed from Python */
+	subsarray_py = Py_None;
+	default_py = NULL; // Distinguishes an omitted default from an explicit default of None
+
+	/* Parse and validate */
+	static char *kwlist[] = {"varname", "subsarray", "default", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!parse_fastcall_args(args, nargs, kwnames, "O|OO", "subscript_next", kwlist, &varname_py, &subsarray_py, &default_py)) {
+		return NULL;
+	}
+	RETURN_IF_INVALID_SEQUENCE(subsarray_py, YDBPython_SubsarraySequence);
+
+	/* Setup for Call */
+	ret_value = get_value_buffer();
+	if (NULL == ret_value) {
+		return NULL;
+	}
+	INVOKE_LOAD_YDBKEY(key, varname_py, subsarray_py);
+
+	/* Call the wrapped function */
+	YDBPY_CALL(status, subscript_next, &key.varname, key.subs_used, key.subsarray, ret_value);
+	/* Check whether length of string was longer than the reusable value buffer. If so, grow the buffer
+	 * and try again */
+	if (YDB_ERR_INVSTRLEN == status) {
+		grow_value_buffer(ret_value);
+		/* recall the wrapped function */
+		YDBPY_CALL(status, subscript_next, &key.varname, key.subs_used, key.subsarray, ret_value);
+		assert(YDB_ERR_INVSTRLEN != status);
+	}
+	free_YDBKey(&key);
+
+	if ((YDB_ERR_NODEEND == status) && (NULL != default_py)) {
+		/* No more nodes, so signal the end of the traversal with the default rather than by raising YDBNodeEnd */
+		Py_INCREF(default_py);
+		ret = default_py;
+	} else if (YDB_OK != status) {
+		raise_YDBError(status);
+	} else {
+		/* Create Python object to return. Creates new reference */
+		ret = Py_BuildValue("y#", ret_value->buf_addr, (Py_ssize_t)ret_value->len_used);
+	}
+	return ret;
+}
+
+/* Wrapper for ydb_subscript_previous_s() */
+static PyObject *subscript_previous(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int	      status;
+	PyObject *    varname_py;
+	PyObject *    subsarray_py, *default_py, *ret;
+	ydb_buffer_t *ret_value;
+	YDBKey	      key;
+
+	UNUSED(self);
+	ret = NULL; // Initialize to prevent "maybe-uninitialized" compiler warning on old versions of GCC
+	/* Default values for optional arguments passed from Python */
+	subsarray_py = Py_None;
+	default_py = NULL; // Distinguishes an omitted default from an explicit default of None
+
+	/* Parse and validate */
+	static char *kwlist[] = {"varname", "subsarray", "default", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!parse_fastcall_args(args, nargs, kwnames, "O|OO", "subscript_previous", kwlist, &varname_py, &subsarray_py,
+				 &default_py)) {
+		return NULL;
+	}
+	RETURN_IF_INVALID_SEQUENCE(subsarray_py, YDBPython_SubsarraySequence);
+
+	/* Setup for call */
+	ret_value = get_value_buffer();
+	if (NULL == ret_value) {
+		return NULL;
+	}
+	INVOKE_LOAD_YDBKEY(key, varname_py, subsarray_py);
+
+	/* Call the wrapped function */
+	YDBPY_CALL(status, subscript_previous, &key.varname, key.subs_used, key.subsarray, ret_value);
+
+	/* Check whether length of string was longer than the reusable value buffer.
+	 * If so, grow the buffer and try again
+	 */
+	if (YDB_ERR_INVSTRLEN == status) {
+		grow_value_buffer(ret_value);
+		YDBPY_CALL(status, subscript_previous, &key.varname, key.subs_used, key.subsarray, ret_value);
+		assert(YDB_ERR_INVSTRLEN != status);
+	}
+	free_YDBKey(&key);
+
+	/* Check status for Errors and Raise Exception */
+	if ((YDB_ERR_NODEEND == status) && (NULL != default_py)) {
+		/* No more nodes, so signal the end of the traversal with the default rather than by raising YDBNodeEnd */
+		Py_INCREF(default_py);
+		ret = default_py;
+	} else if (YDB_OK != status) {
+		raise_YDBError(status);
+	} else {
+		/* Create Python object to return. Creates a new reference */
+		ret = Py_BuildValue("y#", ret_value->buf_addr, (Py_ssize_t)ret_value->len_used);
+	}
+	return ret;
+}
+
+/* Callback functions used by Wrapper for ydb_tp_s() */
+
+/* Callback Wrapper used by tp_st. The approach of calling a Python function is a
+ * bit of a hack. Here's how it works:
+ *      1) This is the callback function that is always passed to the ydb_tp_st
+ *              Simple API function and should only ever be called by ydb_tp_st
+ *              via tp() below. It assumes that everything passed to it was validated.
+ *      2) The actual Python function to be called is passed to this function
+ *              as the first element in a Python tuple.
+ *      3) The positional arguments are passed as the second element and the
+ *              keyword args are passed as the third.
+ *      4) This function calls calls the Python callback function with the args and
+ *              kwargs arguments.
+ *      5) if a function raises an exception then this function returns TPCALLBACKINVRETVAL
+ *              as a way of indicating an error.
+ *      Note: the PyErr String is already set so the the function receiving the return
+ *              value (tp()) just needs to return NULL.
+ */
+static int callback_wrapper(void *tp_call_args) {
+	int		   ret_value;
+	bool		   decref_args = false;
+	bool		   decref_kwargs = false;
+	unsigned long long start;
+	YDBTPCallArgs *	   call_args;
+	PyObject *	   function_with_arguments, *function, *args, *kwargs, *ret;
+	PyObject *	   err_object;
+
+	call_args = (YDBTPCallArgs *)tp_call_args;
+	call_args->attempts++;
+	function_with_arguments = call_args->function_with_arguments;
+	function = PyTuple_GetItem(function_with_arguments, 0); // Borrowed Reference
+	args = PyTuple_GetItem(function_with_arguments, 1);	// Borrowed Reference
+	kwargs = PyTuple_GetItem(function_with_arguments, 2);	// Borrowed Reference
+
+	if (Py_None == args) {
+		args = PyTuple_New(0);
+		decref_args = true;
+	}
+	if (Py_None == kwargs) {
+		kwargs = PyDict_New();
+		decref_kwargs = true;
+	}
+
+	start = call_args->timed ? stats_clock() : 0;
+	ret = PyObject_Call(function, args, kwargs); // New Reference
+	if (call_args->timed) {
+		call_args->callback_ns += stats_clock() - start;
+	}
+
+	if (decref_args)
+		Py_DECREF(args);
+	if (decref_kwargs)
+		Py_DECREF(kwargs);
+
+	if (NULL == ret) {
+		/* No return value was specified, signalling that `function` raised an exception.
+		 * So, confirm that an exception was actually raised and determine the value to
+		 * return to ydb_tp_s based on that, specifically looking out for YDB_TP_RESTART
+		 * and YDB_TP_ROLLBACK.
+		 *
+		 *      Note: Do not need to `PyErr_SetString` because this or similar operation
+		 *              was done when the exception was raised by `function`
+		 */
+		err_object = PyErr_Occurred();
+		/* An exception should have been raised, but PyErr_Occurred() returned NULL.
+		 * This should not happen, so assert that here.
+		 */
+		assert(err_object);
+		if (PyErr_GivenExceptionMatches(err_object, YDBTPRestart)) {
+			PyErr_Clear();
+			return YDB_TP_RESTART;
+		} else if (PyErr_GivenExceptionMatches(err_object, YDBTPRollback)) {
+			PyErr_Clear();
+			return YDB_TP_ROLLBACK;
+		} else {
+			/* If no TP-related exceptions occurred, return a default of YDB_ERR_TPCALLBACKINVRETVAL
+			 * to signal to ydb_tp_s() that callback function is invalid without specifying a particular
+			 * TP handling scenario, i.e. YDB_TP_RESTART or YDB_TP_ROLLBACK.
+			 */
+			return YDB_ERR_TPCALLBACKINVRETVAL;
+		}
+	} else if (!PyLong_Check(ret)) {
+		PyErr_SetString(PyExc_TypeError, "Callback function must return value of type int.");
+		return YDB_ERR_TPCALLBACKINVRETVAL;
+	}
+	ret_value = (int)PyLong_AsLong(ret);
+	Py_DECREF(ret);
+	return ret_value;
+}
+
+/* Callback passed to ydb_tp_st() by call_tp(). Runs the Simple API style callback described by `tp_callback`
+ * with the GIL held, and with the calling thread's tptoken set to that of the transaction, so that the calls made
+ * by the callback take part in it. The previous tptoken is restored afterwards, which supports nested transactions.
+ */
+static int tp_callback_st(uint64_t tptoken, ydb_buffer_t *errstr, void *tp_callback) {
+	int		 status;
+	uint64_t	 outer_tptoken;
+	YDBTPCallback *	 callback;
+	PyGILState_STATE gil_state;
+
+	UNUSED(errstr);
+	callback = (YDBTPCallback *)tp_callback;
+	gil_state = PyGILState_Ensure();
+	outer_tptoken = thread_state.tptoken;
+	thread_state.tptoken = tptoken;
+	status = callback->function(callback->args);
+	thread_state.tptoken = outer_tptoken;
+	PyGILState_Release(gil_state);
+	return status;
+}
+
+/* Run `function` in a transaction with ydb_tp_s(), or with ydb_tp_st() in threaded mode. In that case, the GIL is
+ * released while YottaDB runs the transaction, so that other threads can keep making calls outside of a transaction, and
+ * reacquired by tp_callback_st() for each invocation of `function`. YottaDB runs one TP transaction per process at a time,
+ * so a transaction started by another thread waits for this one to finish. A transaction started by a thread that is
+ * already inside one is nested within it.
+ */
+static int call_tp(ydb_tpfnptr_t function, void *args, const char *transid, int namecount, ydb_buffer_t *varnames) {
+	int	      status;
+	YDBTPCallback callback;
+
+	callback.function = function;
+	callback.args = args;
+	YDBPY_CALL_COUNTED(status, YDBPY_OP_tp,
+			   ydb_tp_st(thread_state.tptoken, errstr, tp_callback_st, &callback, transid, namecount, varnames),
+			   ydb_tp_s(function, args, transid, namecount, varnames), YDBPY_NO_BYTES, YDBPY_NO_KEY);
+	return status;
+}
+
+/* Add a call to tp() with `transid` that returned `status` after `call_args->attempts` attempts and `elapsed_ns`
+ * nanoseconds to the counters reported by tp_stats(). The time not spent in the callback is counted as commit time, as it
+ * is mostly spent by YottaDB committing the transaction, or finding that it must be restarted. Must be called while
+ * holding the GIL.
+ */
+static void record_tp_stats(const char *transid, int status, YDBTPCallArgs *call_args, unsigned long long elapsed_ns) {
+	unsigned int i;
+	size_t	     transid_len;
+	YDBTPStats * stats, *entries;
+
+	for (i = 0; (i < tp_stats_used) && (0 != strcmp(tp_stats_entries[i].transid, transid)); i++)
+		;
+	if (i == tp_stats_used) {
+		// First call with this transid. If memory runs out, the call is left uncounted rather than failing tp().
+		if (tp_stats_used == tp_stats_allocated) {
+			entries = realloc(tp_stats_entries, ((0 == tp_stats_allocated) ? 8 : 2 * tp_stats_allocated) * sizeof(YDBTPStats));
+			if (NULL == entries)
+				return;
+			tp_stats_entries = entries;
+			tp_stats_allocated = (0 == tp_stats_allocated) ? 8 : 2 * tp_stats_allocated;
+		}
+		stats = &tp_stats_entries[i];
+		memset(stats, 0, sizeof(YDBTPStats));
+		transid_len = strlen(transid);
+		stats->transid = malloc(transid_len + 1);
+		if (NULL == stats->transid)
+			return;
+		memcpy(stats->transid, transid, transid_len + 1);
+		tp_stats_used++;
+	}
+	stats = &tp_stats_entries[i];
+	stats->attempts += call_args->attempts;
+	// Every attempt after the first follows a restart, whether requested by the callback or by YottaDB
+	stats->restarts += (0 < call_args->attempts) ? call_args->attempts - 1 : 0;
+	if (YDB_OK == status) {
+		stats->commits++;
+	} else if (YDB_TP_ROLLBACK == status) {
+		stats->rollbacks++;
+	} else {
+		stats->errors++;
+	}
+	stats->callback_ns += call_args->callback_ns;
+	stats->commit_ns += (elapsed_ns > call_args->callback_ns) ? elapsed_ns - call_args->callback_ns : 0;
+}
+
+/* Wrapper for ydb_tp_s() and ydb_tp_st() */
+static PyObject *tp(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	bool		   return_null = false;
+	int		   namecount, status, return_restarts;
+	unsigned long long start;
+	const char *	   transid;
+	PyObject *	   callback, *callback_args, *callback_kwargs, *varnames_py;
+	PyObject *	   varnames_owners[YDB_MAX_NAMES];
+	ydb_buffer_t	   varnames_ydb[YDB_MAX_NAMES];
+	YDBTPCallArgs	   call_args;
+
+	UNUSED(self);
+	/* Default values for optional arguments passed from Python */
+	callback_args = Py_None;
+	callback_kwargs = Py_None;
+	transid = "";
+	namecount = 0;
+	varnames_py = Py_None;
+	return_restarts = FALSE;
+
+	/* parse and validate */
+	static char *kwlist[] = {"callback", "args", "kwargs", "transid", "varnames", "return_restarts", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!parse_fastcall_args(args, nargs, kwnames, "O|OOsOp", "tp", kwlist, &callback, &callback_args, &callback_kwargs,
+				 &transid, &varnames_py, &return_restarts)) {
+		return NULL;
+	}
+
+	/* validate input */
+	if (!PyCallable_Check(callback)) {
+		PyErr_SetString(PyExc_TypeError, "'callback' must be a callable.");
+		return_null = true;
+	}
+	if ((Py_None != callback_args) && !PyTuple_Check(callback_args)) {
+		PyErr_SetString(PyExc_TypeError, "'args' must be a tuple. "
+						 "(It will be passed to the callback "
+						 "function as positional arguments.)");
+		return_null = true;
+	}
+	if ((Py_None != callback_kwargs) && !PyDict_Check(callback_kwargs)) {
+		PyErr_SetString(PyExc_TypeError, "'kwargs' must be a dictionary. "
+						 "(It will be passed to the callback function as keyword arguments.)");
+		return_null = true;
+	}
+	RETURN_IF_INVALID_SEQUENCE(varnames_py, YDBPython_VarnameSequence);
+	if (!return_null) {
+		/* Setup for Call */
+		/* New Reference */
+		call_args.function_with_arguments = Py_BuildValue("(OOO)", callback, callback_args, callback_kwargs);
+		call_args.timed = stats_enabled;
+		call_args.attempts = 0;
+		call_args.callback_ns = 0;
+		if (Py_None != varnames_py)
+			namecount = PySequence_Length(varnames_py);
+
+		if (0 < namecount) {
+			status = borrow_py_sequence_as_buffer_array(varnames_py, namecount, varnames_ydb, varnames_owners);
+			if (YDB_OK != status) {
+				Py_DECREF(call_args.function_with_arguments);
+				return NULL;
+			}
+		}
+
+		/* Call the wrapped function */
+		start = call_args.timed ? stats_clock() : 0;
+		status = call_tp(callback_wrapper, &call_args, transid, namecount, varnames_ydb);
+		if (call_args.timed) {
+			record_tp_stats(transid, status, &call_args, stats_clock() - start);
+		}
+		/* Check status for errors and raise exception */
+		if (YDB_ERR_TPCALLBACKINVRETVAL == status) {
+			// Exception already raised in callback_wrapper
+			return_null = true;
+		} else if (YDB_OK != status) {
+			raise_YDBError(status);
+			return_null = true;
+		}
+		/* Release references */
+		Py_DECREF(call_args.function_with_arguments);
+		RELEASE_BUFFER_OWNERS(varnames_owners, namecount);
+	}
+
+	if (return_null) {
+		return NULL;
+	} else if (return_restarts) {
+		return Py_BuildValue("(iI)", status, (0 < call_args.attempts) ? call_args.attempts - 1 : 0);
+	} else {
+		return Py_BuildValue("i", status);
+	}
+}
+
+/* Set the nodes of `tree`, a dictionary in the format returned by load_tree(), under the node given by `varname` and
+ * the `subs_used` subscripts of `subsarray`, for save_tree_callback(). The subscript of each nested dictionary is
+ * pushed onto `subsarray` for the duration of the call for that dictionary, so that a single array of subscripts is
+ * used for the whole tree. Returns YDB_OK, the status of a failed ydb_set_s() call, or YDB_ERR_TPCALLBACKINVRETVAL
+ * with a Python exception raised.
+ */
+static int save_tree_level(ydb_buffer_t *varname, ydb_buffer_t *subsarray, int subs_used, PyObject *tree) {
+	int	     status;
+	Py_ssize_t   pos;
+	PyObject *   sub, *item, *owner;
+	ydb_buffer_t value_ydb;
+
+	pos = 0;
+	while (PyDict_Next(tree, &pos, &sub, &item)) { // Borrowed References
+		if (PyDict_Check(item)) {
+			if (YDB_MAX_SUBS <= subs_used) {
+				raise_ValidationError(YDBPython_ValueError, "'tree' argument invalid: ", YDBPY_ERR_SEQUENCE_TOO_LONG,
+						      (long)subs_used + 1, YDB_MAX_SUBS);
+				return YDB_ERR_TPCALLBACKINVRETVAL;
+			}
+			if (YDB_OK != anystr_to_borrowed_buffer(sub, &subsarray[subs_used], FALSE, &owner)) {
+				return YDB_ERR_TPCALLBACKINVRETVAL;
+			}
+			status = save_tree_level(varname, subsarray, subs_used + 1, item);
+			Py_DECREF(owner);
+		} else if (PyUnicode_Check(sub) && (0 == PyUnicode_CompareWithASCIIString(sub, "value"))) {
+			if (Py_None == item) {
+				// The value is None, so set node to empty string, as done for Key.value.
+				YDB_LITERAL_TO_BUFFER("", &value_ydb);
+				owner = NULL;
+			} else if (YDB_OK != anystr_to_borrowed_buffer(item, &value_ydb, FALSE, &owner)) {
+				return YDB_ERR_TPCALLBACKINVRETVAL;
+			}
+			YDBPY_CALL(status, set, varname, subs_used, subsarray, &value_ydb);
+			Py_XDECREF(owner);
+		} else {
+			PyErr_Format(PyExc_TypeError, YDBPY_ERR_TREE_ITEM_INVALID, sub);
+			return YDB_ERR_TPCALLBACKINVRETVAL;
+		}
+		if (YDB_OK != status) {
+			return status;
+		}
+	}
+	return YDB_OK;
+}
+
+/* Does the work of save_tree() both with and without TP */
+static int save_tree_callback(void *save_tree_args) {
+	int		 status;
+	YDBSaveTreeArgs *args;
+
+	args = (YDBSaveTreeArgs *)save_tree_args;
+	if (args->replace) {
+		YDBPY_CALL(status, delete, &args->key->varname, args->key->subs_used, args->key->subsarray, YDB_DEL_TREE);
+		if (YDB_OK != status) {
+			return status;
+		}
+	}
+	return save_tree_level(&args->key->varname, args->key->subsarray, args->key->subs_used, args->tree);
+}
+
+/* Wrapper for ydb_set_s(), used to store `tree`, a dictionary in the format returned by load_tree(), under the node
+ * given by `varname` and `subsarray`. If `replace` is True, the subtree of that node is first deleted with
+ * ydb_delete_s(). If `in_tp` is True, this is all done in a single transaction, identified by `transid`, so that
+ * other processes see either the previous subtree or the new one, and never a partially written one.
+ */
+static PyObject *save_tree(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int		status, replace, in_tp;
+	const char *	transid;
+	PyObject *	varname_py, *subsarray_py, *tree;
+	YDBKey		key;
+	YDBSaveTreeArgs save_tree_args;
+
+	UNUSED(self);
+	/* Default values for optional arguments passed from Python */
+	replace = FALSE;
+	in_tp = FALSE;
+	transid = "";
+
+	/* Parse and validate */
+	static char *kwlist[] = {"varname", "subsarray", "tree", "replace", "in_tp", "transid", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!parse_fastcall_args(args, nargs, kwnames, "OOO|pps", "save_tree", kwlist, &varname_py, &subsarray_py, &tree,
+				 &replace, &in_tp, &transid)) {
+		return NULL;
+	}
+	RETURN_IF_INVALID_SEQUENCE(subsarray_py, YDBPython_SubsarraySequence);
+	if (!PyDict_Check(tree)) {
+		PyErr_SetString(PyExc_TypeError, YDBPY_ERR_TREE_NOT_DICT_ARG);
+		return NULL;
+	}
+
+	/* Setup for calls */
+	INVOKE_LOAD_YDBKEY(key, varname_py, subsarray_py);
+	save_tree_args.key = &key;
+	save_tree_args.tree = tree;
+	save_tree_args.replace = replace;
+
+	/* Call the wrapped functions for each node */
+	if (in_tp) {
+		status = call_tp(save_tree_callback, &save_tree_args, transid, 0, NULL);
+	} else {
+		status = save_tree_callback(&save_tree_args);
+	}
+	free_YDBKey(&key);
+
+	if (YDB_OK != status) {
+		if (YDB_ERR_TPCALLBACKINVRETVAL != status) {
+			raise_YDBError(status);
+		} // Otherwise, the exception was already raised in save_tree_level()
+		return NULL;
+	}
+	Py_RETURN_NONE;
+}
+
+/* Store `json`, a Python object representing a JSON value, under the node given by `varname` and the `subs_used`
+ * subscripts of `subsarray`, in the layout read back by load_json(). Objects store each of their members under the
+ * member name, and arrays each of their elements under its index, starting from 1, with a "\l" node marking an empty
+ * array. Any other value is stored as a string, along with an empty "\s" node if it is a str, to tell it apart from
+ * numbers, booleans and None. Returns YDB_OK, the status of a failed ydb_set_s() call, or YDB_ERR_TPCALLBACKINVRETVAL
+ * with a Python exception raised.
+ */
+static int save_json_level(ydb_buffer_t *varname, ydb_buffer_t *subsarray, int subs_used, PyObject *json) {
+	int	     status;
+	Py_ssize_t   pos;
+	PyObject *   sub, *item, *owner, *str;
+	ydb_buffer_t value_ydb, empty;
+	char	     index[CANONICAL_NUMBER_TO_STRING_MAX];
+
+	YDB_LITERAL_TO_BUFFER("", &empty);
+	if ((PyDict_Check(json) || PyList_Check(json)) && (YDB_MAX_SUBS <= subs_used)) {
+		raise_ValidationError(YDBPython_ValueError, "'json' argument invalid: ", YDBPY_ERR_SEQUENCE_TOO_LONG,
+				      (long)subs_used + 1, YDB_MAX_SUBS);
+		return YDB_ERR_TPCALLBACKINVRETVAL;
+	}
+	if (PyDict_Check(json)) {
+		pos = 0;
+		while (PyDict_Next(json, &pos, &sub, &item)) { // Borrowed References
+			if (YDB_OK != anystr_to_borrowed_buffer(sub, &subsarray[subs_used], FALSE, &owner)) {
+				return YDB_ERR_TPCALLBACKINVRETVAL;
+			}
+			status = save_json_level(varname, subsarray, subs_used + 1, item);
+			Py_DECREF(owner);
+			if (YDB_OK != status) {
+				return status;
+			}
+		}
+		return YDB_OK;
+	} else if (PyList_Check(json)) {
+		if (0 == PyList_GET_SIZE(json)) {
+			YDB_LITERAL_TO_BUFFER("\\l", &subsarray[subs_used]);
+			YDBPY_CALL(status, set, varname, subs_used + 1, subsarray, &empty);
+			return status;
+		}
+		for (Py_ssize_t i = 0; i < PyList_GET_SIZE(json); i++) {
+			subsarray[subs_used].buf_addr = index;
+			subsarray[subs_used].len_alloc = sizeof(index);
+			subsarray[subs_used].len_used = snprintf(index, sizeof(index), "%zd", i + 1);
+			status = save_json_level(varname, subsarray, subs_used + 1, PyList_GET_ITEM(json, i));
+			if (YDB_OK != status) {
+				return status;
+			}
+		}
+		return YDB_OK;
+	}
+	if (PyUnicode_Check(json)) {
+		YDB_LITERAL_TO_BUFFER("\\s", &subsarray[subs_used]);
+		YDBPY_CALL(status, set, varname, subs_used + 1, subsarray, &empty);
+		if (YDB_OK != status) {
+			return status;
+		}
+		Py_INCREF(json);
+		str = json;
+	} else {
+		str = PyObject_Str(json); // New Reference
+		if (NULL == str) {
+			return YDB_ERR_TPCALLBACKINVRETVAL;
+		}
+	}
+	if (YDB_OK != anystr_to_borrowed_buffer(str, &value_ydb, FALSE, &owner)) {
+		Py_DECREF(str);
+		return YDB_ERR_TPCALLBACKINVRETVAL;
+	}
+	YDBPY_CALL(status, set, varname, subs_used, subsarray, &value_ydb);
+	Py_DECREF(owner);
+	Py_DECREF(str);
+	return status;
+}
+
+/* Wrapper for ydb_set_s(), used to store `json`, a Python object representing a JSON value, under the node given by
+ * `varname` and `subsarray`, in the layout read back by load_json().
+ */
+static PyObject *save_json(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int	  status;
+	PyObject *varname_py, *subsarray_py, *json;
+	YDBKey	  key;
+
+	UNUSED(self);
+
+	/* Parse and validate */
+	static char *kwlist[] = {"varname", "subsarray", "json", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!parse_fastcall_args(args, nargs, kwnames, "OOO", "save_json", kwlist, &varname_py, &subsarray_py, &json)) {
+		return NULL;
+	}
+	RETURN_IF_INVALID_SEQUENCE(subsarray_py, YDBPython_SubsarraySequence);
+
+	/* Call the wrapped function for each node */
+	INVOKE_LOAD_YDBKEY(key, varname_py, subsarray_py);
+	status = save_json_level(&key.varname, key.subsarray, key.subs_used, json);
+	free_YDBKey(&key);
+
+	if (YDB_OK != status) {
+		if (YDB_ERR_TPCALLBACKINVRETVAL != status) {
+			raise_YDBError(status);
+		} // Otherwise, the exception was already raised in save_json_level()
+		return NULL;
+	}
+	Py_RETURN_NONE;
+}
+
+/* Move `reader` to the next node with a value, in the order of ydb_node_next_s(), and get its value. Sets
+ * `reader->done` once past the last node of the subtree being read. Returns FALSE with a Python exception raised
+ * on error.
+ */
+static bool next_json_node(YDBJSONReader *reader) {
+	int	      status, out_subs_used, common;
+	ydb_buffer_t *out_subsarray;
+
+	out_subsarray = reader->subs_buffers->arrays[reader->count++ % 2];
+	out_subs_used = YDB_MAX_SUBS;
+	YDBPY_CALL(status, node_next, &reader->root->varname, reader->subs_used, reader->subsarray, &out_subs_used,
+		   out_subsarray);
+	while (YDB_ERR_INVSTRLEN == status) {
+		grow_value_buffer(&out_subsarray[out_subs_used]);
+		out_subs_used = YDB_MAX_SUBS;
+		YDBPY_CALL(status, node_next, &reader->root->varname, reader->subs_used, reader->subsarray, &out_subs_used,
+			   out_subsarray);
+	}
+	/* Stop at the first node outside of the subtree */
+	if ((YDB_ERR_NODEEND == status)
+	    || ((YDB_OK == status)
+		&& ((out_subs_used <= reader->root->subs_used)
+		    || !has_subs_prefix(out_subsarray, out_subs_used, reader->root->subsarray, reader->root->subs_used)))) {
+		reader->done = TRUE;
+		return TRUE;
+	} else if (YDB_OK != status) {
+		raise_YDBError(status);
+		return FALSE;
+	}
+	for (common = 0; (common < reader->subs_used) && (common < out_subs_used); common++) {
+		if ((reader->subsarray[common].len_used != out_subsarray[common].len_used)
+		    || (0 != memcmp(reader->subsarray[common].buf_addr, out_subsarray[common].buf_addr, out_subsarray[common].len_used))) {
+			break;
+		}
+	}
+	reader->common = common;
+	reader->subsarray = out_subsarray;
+	reader->subs_used = out_subs_used;
+
+	YDBPY_CALL(status, get, &reader->root->varname, out_subs_used, out_subsarray, reader->value_buffer);
+	if (YDB_ERR_INVSTRLEN == status) {
+		grow_value_buffer(reader->value_buffer);
+		YDBPY_CALL(status, get, &reader->root->varname, out_subs_used, out_subsarray, reader->value_buffer);
+		assert(YDB_ERR_INVSTRLEN != status);
+	}
+	if (YDB_OK != status) {
+		raise_YDBError(status);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/* Returns whether the current node of `reader` is in the subtree of the node at which it was when it was at a depth
+ * of `subs_used` subscripts. This is so if none of the nodes read since then differed from the node before them in
+ * those subscripts.
+ */
+#define JSON_READER_IN_SUBTREE(READER, SUBS_USED) (!(READER)->done && ((SUBS_USED) <= (READER)->common))
+
+/* Returns whether the last subscript of the current node of `reader` is the JSON marker node `MARKER`. */
+#define JSON_READER_AT_MARKER(READER, MARKER)                                                          \
+	((sizeof(MARKER) - 1 == (READER)->subsarray[(READER)->subs_used - 1].len_used)                 \
+	 && (0 == memcmp((READER)->subsarray[(READER)->subs_used - 1].buf_addr, MARKER, sizeof(MARKER) - 1)))
+
+/* Convert the value of the current node of `reader`, which is a JSON value other than an object or an array, to the
+ * Python object it was stored from by save_json(). Strings are marked by a "\s" node, while None, integers, floats
+ * and booleans are recognized from their string representation. Returns a new reference, or NULL with a Python
+ * exception raised.
+ */
+static PyObject *convert_json_value(YDBJSONReader *reader, int subs_used) {
+	PyObject *value, *ret;
+
+	value = PyUnicode_DecodeUTF8(reader->value_buffer->buf_addr, reader->value_buffer->len_used, NULL); // New Reference
+	if ((NULL == value) || !next_json_node(reader)) {
+		Py_XDECREF(value);
+		return NULL;
+	}
+	if (JSON_READER_IN_SUBTREE(reader, subs_used) && (subs_used + 1 == reader->subs_used)
+	    && JSON_READER_AT_MARKER(reader, "\\s")) {
+		if (!next_json_node(reader)) {
+			DECREF_AND_RETURN(value, NULL);
+		}
+		return value;
+	}
+	if (0 == PyUnicode_CompareWithASCIIString(value, "None")) {
+		Py_DECREF(value);
+		Py_RETURN_NONE;
+	} else if (0 == PyUnicode_CompareWithASCIIString(value, "True")) {
+		Py_DECREF(value);
+		Py_RETURN_TRUE;
+	} else if (0 == PyUnicode_CompareWithASCIIString(value, "False")) {
+		Py_DECREF(value);
+		Py_RETURN_FALSE;
+	}
+	ret = PyLong_FromUnicodeObject(value, 10); // New Reference
+	if ((NULL == ret) && PyErr_ExceptionMatches(PyExc_ValueError)) {
+		PyErr_Clear();
+		ret = PyFloat_FromString(value); // New Reference
+		if ((NULL == ret) && PyErr_ExceptionMatches(PyExc_ValueError)) {
+			PyErr_Clear();
+			Py_INCREF(value);
+			ret = value;
+		}
+	}
+	Py_DECREF(value);
+	return ret;
+}
+
+/* Read the JSON value stored under the current node of `reader`, which has `subs_used` subscripts, and leave `reader`
+ * at the first node past its subtree. The current node is either the node itself, if the JSON value is stored as its
+ * value, or the first of its descendants, if it is an object or an array. Arrays are told apart from objects by their
+ * subscripts being their indices starting from 1. Returns a new reference, or NULL with a Python exception raised.
+ */
+static PyObject *load_json_level(YDBJSONReader *reader, int subs_used) {
+	bool	      is_array;
+	Py_ssize_t    index;
+	PyObject *    ret, *sub, *item;
+	ydb_buffer_t *sub_ydb;
+	char	      index_str[CANONICAL_NUMBER_TO_STRING_MAX];
+	int	      index_len, status;
+
+	if (subs_used == reader->subs_used) {
+		ret = convert_json_value(reader, subs_used); // New Reference
+	} else if ((subs_used + 1 == reader->subs_used) && JSON_READER_AT_MARKER(reader, "\\l")) {
+		ret = PyList_New(0); // New Reference
+		if ((NULL != ret) && !next_json_node(reader)) {
+			Py_CLEAR(ret);
+		}
+	} else {
+		sub_ydb = &reader->subsarray[subs_used];
+		is_array = (1 == sub_ydb->len_used) && ('1' == sub_ydb->buf_addr[0]);
+		ret = is_array ? PyList_New(0) : PyDict_New(); // New Reference
+		/* The first node is in the subtree, but was reached from a node that may not have been */
+		for (index = 1; (NULL != ret) && ((1 == index) || JSON_READER_IN_SUBTREE(reader, subs_used)); index++) {
+			sub_ydb = &reader->subsarray[subs_used];
+			sub = PyUnicode_DecodeUTF8(sub_ydb->buf_addr, sub_ydb->len_used, NULL); // New Reference
+			index_len = snprintf(index_str, sizeof(index_str), "%zd", index);
+			if (is_array && (NULL != sub)
+			    && ((index_len != (int)sub_ydb->len_used) || (0 != memcmp(index_str, sub_ydb->buf_addr, index_len)))) {
+				/* Not the next index of the array */
+				PyErr_Format(PyExc_ValueError, YDBPY_ERR_JSON_ARRAY_INDEX, sub, index);
+				Py_DECREF(sub);
+				Py_CLEAR(ret);
+				break;
+			}
+			item = (NULL == sub) ? NULL : load_json_level(reader, subs_used + 1); // New Reference
+			if (NULL == item) {
+				status = -1;
+			} else {
+				status = is_array ? PyList_Append(ret, item) : PyDict_SetItem(ret, sub, item);
+			}
+			Py_XDECREF(sub);
+			Py_XDECREF(item);
+			if (0 > status) {
+				Py_CLEAR(ret);
+			}
+		}
+		return ret;
+	}
+	/* Skip any other descendants of a value, as they are not part of the layout written by save_json() */
+	while ((NULL != ret) && JSON_READER_IN_SUBTREE(reader, subs_used)) {
+		if (!next_json_node(reader)) {
+			Py_CLEAR(ret);
+		}
+	}
+	return ret;
+}
+
+/* Wrapper for ydb_node_next_s() and ydb_get_s(), used to read back the JSON value stored by save_json() under the node
+ * given by `varname` and `subsarray` in a single walk of its subtree. Returns the JSON value as the Python object it
+ * was stored from.
+ */
+static PyObject *load_json(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int	      status;
+	PyObject *    varname_py, *subsarray_py, *ret;
+	YDBKey	      root;
+	YDBJSONReader reader;
+
+	UNUSED(self);
+	/* Default values for optional arguments passed from Python */
+	subsarray_py = Py_None;
+
+	/* Parse and validate */
+	static char *kwlist[] = {"varname", "subsarray", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!parse_fastcall_args(args, nargs, kwnames, "O|O", "load_json", kwlist, &varname_py, &subsarray_py)) {
+		return NULL;
+	}
+	RETURN_IF_INVALID_SEQUENCE(subsarray_py, YDBPython_SubsarraySequence);
+
+	/* Setup for calls */
+	reader.value_buffer = get_value_buffer();
+	if (NULL == reader.value_buffer) {
+		return NULL;
+	}
+	reader.subs_buffers = get_subs_buffers();
+	if (NULL == reader.subs_buffers) {
+		return NULL;
+	}
+	INVOKE_LOAD_YDBKEY(root, varname_py, subsarray_py);
+	reader.root = &root;
+	reader.subsarray = root.subsarray;
+	reader.subs_used = root.subs_used;
+	reader.common = root.subs_used;
+	reader.count = 0;
+	reader.done = FALSE;
+
+	/* Start with the root itself if it has a value, or else with the first of its descendants */
+	YDBPY_CALL(status, get, &root.varname, root.subs_used, root.subsarray, reader.value_buffer);
+	if (YDB_ERR_INVSTRLEN == status) {
+		grow_value_buffer(reader.value_buffer);
+		YDBPY_CALL(status, get, &root.varname, root.subs_used, root.subsarray, reader.value_buffer);
+		assert(YDB_ERR_INVSTRLEN != status);
+	}
+	ret = NULL;
+	if ((YDB_ERR_LVUNDEF == status) || (YDB_ERR_GVUNDEF == status)) {
+		if (next_json_node(&reader)) {
+			if (reader.done) {
+				/* Nothing is stored under the node */
+				raise_YDBError(status);
+			} else {
+				ret = load_json_level(&reader, root.subs_used); // New Reference
+			}
+		}
+	} else if (YDB_OK != status) {
+		raise_YDBError(status);
+	} else {
+		ret = load_json_level(&reader, root.subs_used); // New Reference
+	}
+	free_YDBKey(&root);
+	return ret;
+}
+
+/* Returns the length of the ZWR expression at the start of the `len` bytes at `zwr`, e.g. "a"_$C(9), which ends at the
+ * first ',' or ')' outside of quotes and parentheses if `in_subs` is set, as for a subscript, or at the end otherwise.
+ */
+static size_t zwr_expression_len(const char *zwr, size_t len, bool in_subs) {
+	bool   in_quotes;
+	int    depth;
+	size_t i;
+
+	in_quotes = FALSE;
+	depth = 0;
+	for (i = 0; i < len; i++) {
+		if ('"' == zwr[i]) {
+			// A quote doubled inside quotes ends them and starts them again
+			in_quotes = !in_quotes;
+		} else if (in_quotes) {
+			continue;
+		} else if ('(' == zwr[i]) {
+			depth++;
+		} else if ((0 < depth) && (')' == zwr[i])) {
+			depth--;
+		} else if (in_subs && (0 == depth) && ((',' == zwr[i]) || (')' == zwr[i]))) {
+			break;
+		}
+	}
+	return i;
+}
+
+/* Returns the length of the varname at the start of the `len` bytes at `line`, or 0 if the line does not start with a
+ * varname followed by '(' or '=', as a line of ZWR format does.
+ */
+static size_t zwr_varname_len(const char *line, size_t len) {
+	size_t i;
+
+	i = ((0 < len) && ('^' == line[0])) ? 1 : 0;
+	if ((i == len) || !(('%' == line[i]) || isalpha((unsigned char)line[i]))) {
+		return 0;
+	}
+	for (i++; (i < len) && isalnum((unsigned char)line[i]); i++)
+		;
+	return ((i < len) && (('(' == line[i]) || ('=' == line[i]))) ? i : 0;
+}
+
+/* Decode the `len` bytes of ZWR format at `zwr` into `out` with ydb_zwr2str_s(), growing it if needed. Returns the
+ * status of that call, or YDB_ERR_TPCALLBACKINVRETVAL if `zwr` is not valid ZWR format, which ydb_zwr2str_s() signals
+ * by returning an empty string.
+ */
+static int decode_zwr(char *zwr, size_t len, ydb_buffer_t *out) {
+	int	     status;
+	ydb_buffer_t in;
+
+	in.buf_addr = zwr;
+	in.len_alloc = in.len_used = len;
+	YDBPY_CALL(status, zwr2str, &in, out);
+	if (YDB_ERR_INVSTRLEN == status) {
+		grow_value_buffer(out);
+		YDBPY_CALL(status, zwr2str, &in, out);
+		assert(YDB_ERR_INVSTRLEN != status);
+	}
+	if ((YDB_OK == status) && (0 == out->len_used) && !((2 == len) && (0 == memcmp(zwr, "\"\"", 2)))) {
+		return YDB_ERR_TPCALLBACKINVRETVAL;
+	}
+	return status;
+}
+
+/* Set the node given by `line`, a line of ZWR format such as ^g("a",1)="value", with ydb_set_s(), decoding its
+ * subscripts and value into the calling thread's subscript and value buffers. Returns the status of a YottaDB call,
+ * or YDB_ERR_TPCALLBACKINVRETVAL if the line is invalid.
+ */
+static int import_zwr_line(char *line, size_t len) {
+	int		status, subs_used;
+	size_t		pos, expr_len;
+	ydb_buffer_t	varname, *value_buffer, *subsarray;
+	YDBSubsBuffers *subs_buffers;
+
+	value_buffer = get_value_buffer();
+	subs_buffers = get_subs_buffers();
+	if ((NULL == value_buffer) || (NULL == subs_buffers)) {
+		return YDB_ERR_TPCALLBACKINVRETVAL;
+	}
+	subsarray = subs_buffers->arrays[0];
+	varname.buf_addr = line;
+	varname.len_alloc = varname.len_used = zwr_varname_len(line, len);
+	if (0 == varname.len_used) {
+		return YDB_ERR_TPCALLBACKINVRETVAL;
+	}
+	pos = varname.len_used;
+	subs_used = 0;
+	if ('(' == line[pos]) {
+		do {
+			pos++;
+			expr_len = zwr_expression_len(line + pos, len - pos, TRUE);
+			if ((0 == expr_len) || (YDB_MAX_SUBS <= subs_used) || (pos + expr_len == len)) {
+				return YDB_ERR_TPCALLBACKINVRETVAL;
+			}
+			status = decode_zwr(line + pos, expr_len, &subsarray[subs_used++]);
+			if (YDB_OK != status) {
+				return status;
+			}
+			pos += expr_len;
+		} while (',' == line[pos]);
+		pos++; // Past the closing parenthesis
+	}
+	if ((pos == len) || ('=' != line[pos])) {
+		return YDB_ERR_TPCALLBACKINVRETVAL;
+	}
+	pos++;
+	status = decode_zwr(line + pos, len - pos, value_buffer);
+	if (YDB_OK != status) {
+		return status;
+	}
+	YDBPY_CALL(status, set, &varname, subs_used, subsarray, value_buffer);
+	return status;
+}
+
+/* Does the work of import_zwr() for a batch of lines, both with and without TP */
+static int import_zwr_callback(void *import_args) {
+	int	       status;
+	char *	       line, *end;
+	unsigned long  line_no;
+	YDBImportArgs *args;
+
+	args = (YDBImportArgs *)import_args;
+	line_no = args->first_line;
+	for (line = args->batch; line < args->batch + args->batch_used; line = end + 1, line_no++) {
+		end = memchr(line, '\n', args->batch + args->batch_used - line);
+		if (end == line) {
+			continue; // Blank or header line
+		}
+		status = import_zwr_line(line, end - line);
+		if (YDB_OK != status) {
+			if ((YDB_ERR_TPCALLBACKINVRETVAL == status) && !PyErr_Occurred()) {
+				PyErr_Format(PyExc_ValueError, YDBPY_ERR_ZWR_LINE_INVALID, line_no,
+					     (int)((YDBPY_MAX_ZWR_LINE_IN_ERROR < end - line) ? YDBPY_MAX_ZWR_LINE_IN_ERROR : end - line),
+					     line);
+			}
+			return status;
+		}
+	}
+	return YDB_OK;
+}
+
+/* Set the nodes of the batch of lines in `args`, in a transaction if `transid` is not NULL, and start a new batch.
+ * Returns the status of the transaction or of the last call made.
+ */
+static int import_zwr_batch(YDBImportArgs *args, const char *transid) {
+	int status;
+
+	if (NULL != transid) {
+		status = call_tp(import_zwr_callback, args, transid, 0, NULL);
+	} else {
+		status = import_zwr_callback(args);
+	}
+	if (YDB_OK == status) {
+		args->count += args->batch_records;
+		args->first_line += args->batch_lines;
+		args->batch_used = args->batch_records = args->batch_lines = 0;
+	}
+	return status;
+}
+
+/* Add the `len` bytes of `line`, line number `line_no` of the input, to the batch in `args`, replacing it with a blank
+ * line if it is one of the header lines written by MUPIP EXTRACT. Returns FALSE with a Python exception raised if
+ * memory could not be allocated.
+ */
+static bool add_zwr_line(YDBImportArgs *args, const char *line, size_t len, unsigned long line_no) {
+	char *batch;
+
+	if ((0 < len) && ('\r' == line[len - 1])) {
+		len--;
+	}
+	if ((YDBPY_ZWR_HEADER_LINES >= line_no) && (0 == zwr_varname_len(line, len))) {
+		len = 0;
+	}
+	if (args->batch_size - args->batch_used < len + 1) {
+		args->batch_size = 2 * (args->batch_used + len + 1);
+		batch = realloc(args->batch, args->batch_size);
+		if (NULL == batch) {
+			PyErr_NoMemory();
+			return FALSE;
+		}
+		args->batch = batch;
+	}
+	memcpy(args->batch + args->batch_used, line, len);
+	args->batch[args->batch_used + len] = '\n';
+	args->batch_used += len + 1;
+	args->batch_lines++;
+	if (0 < len) {
+		args->batch_records++;
+	}
+	return TRUE;
+}
+
+/* Wrapper for ydb_zwr2str_s() and ydb_set_s(), used to import nodes from `file`, either a file descriptor or an object
+ * with a fileno() method, in ZWR format, i.e. one line per node such as ^g("a",1)="value", as written by export_zwr()
+ * or MUPIP EXTRACT, whose header lines are skipped. The input is read with read(2) from the current position of the
+ * file descriptor, and parsed in C, with subscripts and values decoded by ydb_zwr2str_s().
+ *
+ * Lines are set in batches of `batch` records, each in a transaction identified by `transid`, which defaults to
+ * "BATCH" so that commits do not wait for the journal to be hardened, or without transactions if `batch` is 0. If a
+ * line is invalid or fails to be set, the batches before its own remain set. Returns the number of nodes set.
+ */
+static PyObject *import_zwr(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	bool	      failed, eof;
+	int	      status, save_errno;
+	unsigned long batch;
+	char *	      buf, *line, *end, *grown;
+	size_t	      buf_size, buf_used;
+	ssize_t	      nread;
+	const char *  transid;
+	PyObject *    file_py;
+	YDBImportArgs import_args;
+
+	UNUSED(self);
+	/* Default values for optional arguments passed from Python */
+	batch = YDBPY_DEFAULT_ZWR_BATCH;
+	transid = "BATCH";
+
+	/* Parse and validate */
+	static char *kwlist[] = {"file", "batch", "transid", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!parse_fastcall_args(args, nargs, kwnames, "O|ks", "import_zwr", kwlist, &file_py, &batch, &transid))
+		return NULL;
+	import_args.fd = PyObject_AsFileDescriptor(file_py);
+	if (0 > import_args.fd) {
+		return NULL;
+	}
+
+	/* Setup for calls */
+	buf_size = YDBPY_DEFAULT_ZWR_CHUNK_SIZE;
+	buf = malloc(buf_size);
+	if (NULL == buf) {
+		return PyErr_NoMemory();
+	}
+	buf_used = 0;
+	import_args.batch = NULL;
+	import_args.batch_size = import_args.batch_used = 0;
+	import_args.batch_records = import_args.batch_lines = 0;
+	import_args.first_line = 1;
+	import_args.count = 0;
+	failed = eof = FALSE;
+	status = YDB_OK;
+
+	/* Read the input a chunk at a time, adding each complete line to the current batch */
+	while (!eof && !failed && (YDB_OK == status)) {
+		if (buf_used == buf_size) {
+			/* The buffer holds part of a single line, which is longer than the buffer */
+			grown = realloc(buf, 2 * buf_size);
+			if (NULL == grown) {
+				PyErr_NoMemory();
+				failed = TRUE;
+				break;
+			}
+			buf = grown;
+			buf_size *= 2;
+		}
+		Py_BEGIN_ALLOW_THREADS;
+		nread = read(import_args.fd, buf + buf_used, buf_size - buf_used);
+		save_errno = errno;
+		Py_END_ALLOW_THREADS;
+		if (0 > nread) {
+			if ((EINTR == save_errno) && (0 <= PyErr_CheckSignals())) {
+				continue;
+			} else if (EINTR != save_errno) {
+				errno = save_errno;
+				PyErr_SetFromErrno(PyExc_OSError);
+			}
+			failed = TRUE;
+			break;
+		}
+		eof = (0 == nread);
+		buf_used += nread;
+		line = buf;
+		while (!failed && (YDB_OK == status) && (line < buf + buf_used)) {
+			end = memchr(line, '\n', buf + buf_used - line);
+			if (NULL == end) {
+				if (!eof) {
+					break;
+				}
+				end = buf + buf_used; // Last line, without a newline
+			}
+			failed = !add_zwr_line(&import_args, line, end - line, import_args.first_line + import_args.batch_lines);
+			if (!failed && (import_args.batch_records == ((0 == batch) ? YDBPY_DEFAULT_ZWR_BATCH : batch))) {
+				status = import_zwr_batch(&import_args, (0 == batch) ? NULL : transid);
+			}
+			line = end + 1;
+		}
+		/* Keep the start of the next line for the next read */
+		if (line < buf + buf_used) {
+			memmove(buf, line, buf + buf_used - line);
+			buf_used = buf + buf_used - line;
+		} else {
+			buf_used = 0;
+		}
+	}
+	if (!failed && (YDB_OK == status) && (0 < import_args.batch_records)) {
+		status = import_zwr_batch(&import_args, (0 == batch) ? NULL : transid);
+	}
+	free(import_args.batch);
+	free(buf);
+
+	if (failed) {
+		return NULL;
+	}
+	if (YDB_OK != status) {
+		if (YDB_ERR_TPCALLBACKINVRETVAL != status) {
+			raise_YDBError(status);
+		} // Otherwise, the exception was already raised in import_zwr_callback()
+		return NULL;
+	}
+	return PyLong_FromUnsignedLong(import_args.count);
+}
+
+/* Wrapper for ydb_zwr2str_s() */
+static PyObject *zwr2str(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int	     status;
+	PyObject *   zwr_py, *zwr_owner;
+	PyObject *   ret;
+	ydb_buffer_t zwr_ydb, *str_ydb;
+
+	UNUSED(self);
+	ret = NULL;
+
+	/* Parse */
+	static char *kwlist[] = {"input", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!parse_fastcall_args(args, nargs, kwnames, "O", "zwr2str", kwlist, &zwr_py))
+		return NULL;
+
+	/* Setup for Call */
+	str_ydb = get_value_buffer();
+	if (NULL == str_ydb) {
+		return NULL;
+	}
+	INVOKE_ANYSTR_TO_BORROWED_BUFFER(zwr_py, zwr_ydb, FALSE, zwr_owner);
+
+	/* Call the wrapped function */
+	YDBPY_CALL(status, zwr2str, &zwr_ydb, str_ydb);
+	/* recall with properly sized buffer if str_ydb is not long enough */
+	if (YDB_ERR_INVSTRLEN == status) {
+		grow_value_buffer(str_ydb);
+		/* recall the wrapped function */
+		YDBPY_CALL(status, zwr2str, &zwr_ydb, str_ydb);
+		assert(YDB_ERR_INVSTRLEN != status);
+	}
+	Py_DECREF(zwr_owner);
+
+	/* Check status for errors and raise Exception */
+	if (YDB_OK != status) {
+		raise_YDBError(status);
+	} else {
+		/* New Reference */
+		ret = Py_BuildValue("y#", str_ydb->buf_addr, (Py_ssize_t)str_ydb->len_used);
+	}
+	return ret;
+}
+
+/*Comprehensive API
+ *Utility Functions
+ *
+ *    ydb_child_init()
+ *    ydb_exit()
+ *    ydb_file_id_free() / ydb_file_id_free_t()
+ *    ydb_file_is_identical() / ydb_file_is_identical_t()
+ *    ydb_file_name_to_id() / ydb_file_name_to_id_t()
+ *    ydb_fork_n_core()
+ *    ydb_free()
+ *    ydb_hiber_start()
+ *    ydb_hiber_start_wait_any()
+ *    ydb_init()
+ *    ydb_malloc()
+ *    ydb_message() / ydb_message_t()
+ *    ydb_stdout_stderr_adjust() / ydb_stdout_stderr_adjust_t()
+ *    ydb_thread_is_main()
+ *    ydb_timer_cancel() / ydb_timer_cancel_t()
+ *    ydb_timer_start() / ydb_timer_start_t()
+
+ *Calling M Routines
+ */
+
+/* Key type */
+
+static PyTypeObject KeyType;
+
+/* Allocate a new Key of the given type for the node identified by `varname` and `subsarray`, whose encoded
+ * forms are the items of `encoded`. The buffers of the first `num_copied` items are copied from `copy_from`,
+ * which must be a Key for an ancestor of (or the same node as) the new one, and only the remaining items have
+ * their buffers set up here. `parent` may be NULL, in which case it is created on first access.
+ *
+ * Steals the references to `subsarray` and `encoded`, even on failure. On failure, returns NULL with a Python
+ * exception raised.
+ */
+static PyObject *alloc_Key(PyTypeObject *type, PyObject *varname, PyObject *subsarray, PyObject *encoded, PyObject *parent,
+			   YDBKeyObject *copy_from, int num_copied) {
+	int	      num_buffers;
+	YDBKeyObject *key;
+
+	key = (YDBKeyObject *)type->tp_alloc(type, 0); // New Reference
+	if (NULL == key) {
+		Py_DECREF(subsarray);
+		Py_DECREF(encoded);
+		return NULL;
+	}
+	Py_INCREF(varname);
+	key->varname = varname;
+	key->subsarray = subsarray;
+	key->encoded = encoded;
+	Py_XINCREF(parent);
+	key->parent = parent;
+	key->cursor = NULL;
+	key->hash = -1;
+	num_buffers = Py_SAFE_DOWNCAST(PyTuple_GET_SIZE(encoded), Py_ssize_t, int);
+	key->subs_used = num_buffers - 1;
+	key->buffers = PyMem_Malloc(num_buffers * sizeof(ydb_buffer_t));
+	if (NULL == key->buffers) {
+		Py_DECREF(key);
+		return PyErr_NoMemory();
+	}
+	if (0 < num_copied) {
+		memcpy(key->buffers, copy_from->buffers, num_copied * sizeof(ydb_buffer_t));
+	}
+	for (int i = num_copied; i < num_buffers; i++) {
+		PyObject *owner;
+
+		owner = PyTuple_GET_ITEM(encoded, i); // Borrowed Reference
+		key->buffers[i].buf_addr = PyBytes_AS_STRING(owner);
+		key->buffers[i].len_used = key->buffers[i].len_alloc
+		    = Py_SAFE_DOWNCAST(PyBytes_GET_SIZE(owner), Py_ssize_t, unsigned int);
+	}
+	return (PyObject *)key;
+}
+
+/* Encode a varname or subscript for storage in a Key, returning a new reference to the resulting bytes object,
+ * or NULL with a Python exception raised.
+ */
+static PyObject *encode_Key_item(PyObject *item, bool is_varname) {
+	ydb_buffer_t buffer;
+	PyObject *   owner;
+
+	if (!PyUnicode_Check(item) && !PyBytes_Check(item)) {
+		PyErr_SetString(PyExc_TypeError, YDBPY_ERR_KEY_NAME_NOT_BYTES_LIKE);
+		return NULL;
+	}
+	if (YDB_OK != anystr_to_borrowed_buffer(item, &buffer, is_varname, &owner)) {
+		return NULL;
+	}
+	return owner;
+}
+
+/* Create a Key of the given type representing the child node of `parent` with subscript `name`. The new Key
+ * shares the encoded varname and subscripts of `parent`, so only `name` itself is encoded.
+ */
+static PyObject *new_child_Key(PyTypeObject *type, YDBKeyObject *parent, PyObject *name) {
+	int	  num_subs;
+	PyObject *subsarray, *encoded, *owner;
+
+	num_subs = parent->subs_used + 1;
+	if (YDB_MAX_SUBS < num_subs) {
+		PyErr_Format(PyExc_ValueError, YDBPY_ERR_KEY_TOO_MANY_SUBS, num_subs, YDB_MAX_SUBS);
+		return NULL;
+	}
+	owner = encode_Key_item(name, FALSE); // New Reference
+	if (NULL == owner) {
+		return NULL;
+	}
+	subsarray = PyTuple_New(num_subs); // New Reference
+	encoded = PyTuple_New(1 + num_subs); // New Reference
+	if ((NULL == subsarray) || (NULL == encoded)) {
+		Py_XDECREF(subsarray);
+		Py_XDECREF(encoded);
+		Py_DECREF(owner);
+		return NULL;
+	}
+	for (int i = 0; i < parent->subs_used; i++) {
+		PyObject *item;
+
+		item = PyTuple_GET_ITEM(parent->subsarray, i); // Borrowed Reference
+		Py_INCREF(item);
+		PyTuple_SET_ITEM(subsarray, i, item);
+	}
+	Py_INCREF(name);
+	PyTuple_SET_ITEM(subsarray, parent->subs_used, name);
+	for (int i = 0; i <= parent->subs_used; i++) {
+		PyObject *item;
+
+		item = PyTuple_GET_ITEM(parent->encoded, i); // Borrowed Reference
+		Py_INCREF(item);
+		PyTuple_SET_ITEM(encoded, i, item);
+	}
+	PyTuple_SET_ITEM(encoded, num_subs, owner); // Steals Reference
+	return alloc_Key(type, parent->varname, subsarray, encoded, (PyObject *)parent, parent, num_subs);
+}
+
+/* Create a Key of the same type as `key` for its ancestor with `num_subs` subscripts, reusing the encoded
+ * varname and subscripts of `key`.
+ */
+static PyObject *new_ancestor_Key(YDBKeyObject *key, int num_subs) {
+	PyObject *subsarray, *encoded;
+
+	assert(num_subs < key->subs_used);
+	subsarray = PyTuple_GetSlice(key->subsarray, 0, num_subs); // New Reference
+	if (NULL == subsarray) {
+		return NULL;
+	}
+	encoded = PyTuple_GetSlice(key->encoded, 0, 1 + num_subs); // New Reference
+	if (NULL == encoded) {
+		Py_DECREF(subsarray);
+		return NULL;
+	}
+	return alloc_Key(Py_TYPE(key), key->varname, subsarray, encoded, NULL, key, 1 + num_subs);
+}
+
+/* Implements Key(name, parent=None, subsarray=None). If `parent` is given, the new Key represents the child
+ * node of `parent` with subscript `name`. Otherwise, `name` is a varname and `subsarray` optionally gives
+ * the subscripts of the node under it.
+ */
+static PyObject *Key_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
+	Py_ssize_t num_subs;
+	PyObject * name, *parent, *subsarray_py, *subsarray, *encoded, *owner;
+
+	parent = subsarray_py = Py_None;
+	static char *kwlist[] = {"name", "parent", "subsarray", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|OO:Key", kwlist, &name, &parent, &subsarray_py)) {
+		return NULL;
+	}
+	if (!PyUnicode_Check(name) && !PyBytes_Check(name)) {
+		PyErr_SetString(PyExc_TypeError, YDBPY_ERR_KEY_NAME_NOT_BYTES_LIKE);
+		return NULL;
+	}
+	if (Py_None != parent) {
+		if (Py_None != subsarray_py) {
+			PyErr_SetString(PyExc_ValueError, YDBPY_ERR_KEY_PARENT_AND_SUBS);
+			return NULL;
+		}
+		if (!PyObject_TypeCheck(parent, &KeyType)) {
+			PyErr_SetString(PyExc_TypeError, YDBPY_ERR_KEY_PARENT_NOT_KEY);
+			return NULL;
+		}
+		return new_child_Key(type, (YDBKeyObject *)parent, name);
+	}
+
+	if (Py_None == subsarray_py) {
+		subsarray = PyTuple_New(0); // New Reference
+	} else {
+		subsarray = PySequence_Tuple(subsarray_py); // New Reference
+	}
+	if (NULL == subsarray) {
+		return NULL;
+	}
+	num_subs = PyTuple_GET_SIZE(subsarray);
+	if (YDB_MAX_SUBS < num_subs) {
+		PyErr_Format(PyExc_ValueError, YDBPY_ERR_KEY_TOO_MANY_SUBS, (int)num_subs, YDB_MAX_SUBS);
+		Py_DECREF(subsarray);
+		return NULL;
+	}
+	encoded = PyTuple_New(1 + num_subs); // New Reference
+	if (NULL == encoded) {
+		Py_DECREF(subsarray);
+		return NULL;
+	}
+	for (Py_ssize_t i = 0; i <= num_subs; i++) {
+		owner = encode_Key_item((0 == i) ? name : PyTuple_GET_ITEM(subsarray, i - 1), (0 == i)); // New Reference
+		if (NULL == owner) {
+			Py_DECREF(subsarray);
+			Py_DECREF(encoded);
+			return NULL;
+		}
+		PyTuple_SET_ITEM(encoded, i, owner); // Steals Reference
+	}
+	return alloc_Key(type, name, subsarray, encoded, NULL, NULL, 0);
+}
+
+static void Key_dealloc(YDBKeyObject *self) {
+	Py_XDECREF(self->varname);
+	Py_XDECREF(self->subsarray);
+	Py_XDECREF(self->parent);
+	Py_XDECREF(self->encoded);
+	Py_XDECREF(self->cursor);
+	PyMem_Free(self->buffers);
+	Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+/* Retrieve the value of the node represented by a Key into the calling thread's value buffer. Returns the
+ * status of the ydb_get_s() call, without raising any exception.
+ */
+static int get_Key_value(YDBKeyObject *key, ydb_buffer_t *ret_value) {
+	int status;
+
+	YDBPY_CALL(status, get, &key->buffers[0], key->subs_used, &key->buffers[1], ret_value);
+	if (YDB_ERR_INVSTRLEN == status) {
+		grow_value_buffer(ret_value);
+		YDBPY_CALL(status, get, &key->buffers[0], key->subs_used, &key->buffers[1], ret_value);
+		assert(YDB_ERR_INVSTRLEN != status);
+	}
+	return status;
+}
+
+/* Returns the value of the node represented by a Key as a new bytes object, `default_py` if the node is
+ * undefined, or NULL with an exception raised on error.
+ */
+static PyObject *Key_value_or_default(YDBKeyObject *self, PyObject *default_py) {
+	int	      status;
+	ydb_buffer_t *ret_value;
+
+	ret_value = get_value_buffer();
+	if (NULL == ret_value) {
+		return NULL;
+	}
+	status = get_Key_value(self, ret_value);
+	if ((YDB_ERR_LVUNDEF == status) || (YDB_ERR_GVUNDEF == status)) {
+		Py_INCREF(default_py);
+		return default_py;
+	} else if (YDB_OK != status) {
+		raise_YDBError(status);
+		return NULL;
+	}
+	return PyBytes_FromStringAndSize(ret_value->buf_addr, ret_value->len_used); // New Reference
+}
+
+/* Set the value of the node represented by a Key, returning TRUE on success or FALSE with an exception raised */
+static bool set_Key_value(YDBKeyObject *key, PyObject *value_py) {
+	int	     status;
+	PyObject *   value_owner;
+	ydb_buffer_t value_ydb;
+
+	if ((NULL == value_py) || (Py_None == value_py)) {
+		// No value was specified, or it was None, so set node to empty string.
+		YDB_LITERAL_TO_BUFFER("", &value_ydb);
+		value_owner = NULL;
+	} else if (YDB_OK != anystr_to_borrowed_buffer(value_py, &value_ydb, FALSE, &value_owner)) {
+		return FALSE;
+	}
+	YDBPY_CALL(status, set, &key->buffers[0], key->subs_used, &key->buffers[1], &value_ydb);
+	Py_XDECREF(value_owner);
+	if (YDB_OK != status) {
+		raise_YDBError(status);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/* Returns the ydb_data_s() result for the node represented by a Key, or -1 with an exception raised */
+static int get_Key_data(YDBKeyObject *key) {
+	int	     status;
+	unsigned int ret_value;
+
+	YDBPY_CALL(status, data, &key->buffers[0], key->subs_used, &key->buffers[1], &ret_value);
+	if (YDB_OK != status) {
+		raise_YDBError(status);
+		return -1;
+	}
+	return (int)ret_value;
+}
+
+static PyObject *Key_get_name(YDBKeyObject *self, void *closure) {
+	PyObject *name;
+
+	UNUSED(closure);
+	name = (0 == self->subs_used) ? self->varname : PyTuple_GET_ITEM(self->subsarray, self->subs_used - 1);
+	Py_INCREF(name);
+	return name;
+}
+
+static PyObject *Key_get_parent(YDBKeyObject *self, void *closure) {
+	UNUSED(closure);
+	if (0 == self->subs_used) {
+		Py_RETURN_NONE;
+	}
+	if (NULL == self->parent) {
+		// Keys created from a varname and subsarray create their parent on first access
+		self->parent = new_ancestor_Key(self, self->subs_used - 1);
+		if (NULL == self->parent) {
+			return NULL;
+		}
+	}
+	Py_INCREF(self->parent);
+	return self->parent;
+}
+
+static PyObject *Key_get_varname(YDBKeyObject *self, void *closure) {
+	UNUSED(closure);
+	Py_INCREF(self->varname);
+	return self->varname;
+}
+
+static PyObject *Key_get_varname_key(YDBKeyObject *self, void *closure) {
+	PyObject *ancestor, *parent;
+
+	UNUSED(closure);
+	ancestor = (PyObject *)self;
+	Py_INCREF(ancestor);
+	while (0 < ((YDBKeyObject *)ancestor)->subs_used) {
+		parent = Key_get_parent((YDBKeyObject *)ancestor, NULL); // New Reference
+		Py_DECREF(ancestor);
+		if (NULL == parent) {
+			return NULL;
+		}
+		ancestor = parent;
+	}
+	return ancestor;
+}
+
+static PyObject *Key_get_subsarray(YDBKeyObject *self, void *closure) {
+	UNUSED(closure);
+	return PySequence_List(self->subsarray); // New Reference
+}
+
+static PyObject *Key_get_subsarray_keys(YDBKeyObject *self, void *closure) {
+	PyObject *ret, *ancestor, *parent;
+
+	UNUSED(closure);
+	ret = PyList_New(self->subs_used); // New Reference
+	if (NULL == ret) {
+		return NULL;
+	}
+	ancestor = (PyObject *)self;
+	Py_INCREF(ancestor);
+	for (int i = self->subs_used - 1; 0 <= i; i--) {
+		parent = Key_get_parent((YDBKeyObject *)ancestor, NULL); // New Reference
+		if (NULL == parent) {
+			Py_DECREF(ancestor);
+			Py_DECREF(ret);
+			return NULL;
+		}
+		PyList_SET_ITEM(ret, i, ancestor); // Steals Reference
+		ancestor = parent;
+	}
+	Py_DECREF(ancestor);
+	return ret;
+}
+
+static PyObject *Key_get_value(YDBKeyObject *self, void *closure) {
+	UNUSED(closure);
+	return Key_value_or_default(self, Py_None);
+}
+
+static int Key_set_value(YDBKeyObject *self, PyObject *value, void *closure) {
+	UNUSED(closure);
+	if (NULL == value) {
+		PyErr_SetString(PyExc_AttributeError, "can't delete attribute");
+		return -1;
+	}
+	return set_Key_value(self, value) ? 0 : -1;
+}
+
+static PyObject *Key_get_data(YDBKeyObject *self, void *closure) {
+	int ret_value;
+
+	UNUSED(closure);
+	ret_value = get_Key_data(self);
+	return (0 > ret_value) ? NULL : PyLong_FromLong(ret_value);
+}
+
+static PyObject *Key_get_has_value(YDBKeyObject *self, void *closure) {
+	int ret_value;
+
+	UNUSED(closure);
+	ret_value = get_Key_data(self);
+	if (0 > ret_value) {
+		return NULL;
+	}
+	return PyBool_FromLong((YDB_DATA_VALUE_NODESC == ret_value) || (YDB_DATA_VALUE_DESC == ret_value));
+}
+
+static PyObject *Key_get_has_tree(YDBKeyObject *self, void *closure) {
+	int ret_value;
+
+	UNUSED(closure);
+	ret_value = get_Key_data(self);
+	if (0 > ret_value) {
+		return NULL;
+	}
+	return PyBool_FromLong((YDB_DATA_NOVALUE_DESC == ret_value) || (YDB_DATA_VALUE_DESC == ret_value));
+}
+
+static PyObject *Key_get(YDBKeyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	PyObject *default_py;
+
+	default_py = Py_None;
+	static char *kwlist[] = {"default", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!parse_fastcall_args(args, nargs, kwnames, "|O", "get", kwlist, &default_py))
+		return NULL;
+	return Key_value_or_default(self, default_py);
+}
+
+static PyObject *Key_set(YDBKeyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	PyObject *value_py;
+
+	value_py = Py_None;
+	static char *kwlist[] = {"value", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!parse_fastcall_args(args, nargs, kwnames, "|O", "set", kwlist, &value_py))
+		return NULL;
+	if (!set_Key_value(self, value_py)) {
+		return NULL;
+	}
+	Py_RETURN_NONE;
+}
+
+static PyObject *Key_incr(YDBKeyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int	     status;
+	PyObject *   increment_py, *increment_owner, *ret;
+	ydb_buffer_t increment_ydb, ret_value;
+	char	     ret_buffer[CANONICAL_NUMBER_TO_STRING_MAX];
+
+	increment_py = NULL;
+	static char *kwlist[] = {"increment", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!parse_fastcall_args(args, nargs, kwnames, "|O", "incr", kwlist, &increment_py))
+		return NULL;
+
+	if (!increment_to_borrowed_buffer(increment_py, &increment_ydb, &increment_owner)) {
+		return NULL;
+	}
+	ret_value.buf_addr = ret_buffer;
+	ret_value.len_alloc = CANONICAL_NUMBER_TO_STRING_MAX;
+	ret_value.len_used = 0;
+
+	YDBPY_CALL(status, incr, &self->buffers[0], self->subs_used, &self->buffers[1], &increment_ydb, &ret_value);
+	Py_XDECREF(increment_owner);
+	if (YDB_OK != status) {
+		raise_YDBError(status);
+		return NULL;
+	}
+	ret = PyBytes_FromStringAndSize(ret_value.buf_addr, ret_value.len_used); // New Reference
+	return ret;
+}
+
+static PyObject *Key_delete(YDBKeyObject *self, int deltype) {
+	int status;
+
+	YDBPY_CALL(status, delete, &self->buffers[0], self->subs_used, &self->buffers[1], deltype);
+	if (YDB_OK != status) {
+		raise_YDBError(status);
+		return NULL;
+	}
+	Py_RETURN_NONE;
+}
+
+static PyObject *Key_delete_node(YDBKeyObject *self, PyObject *unused) {
+	UNUSED(unused);
+	return Key_delete(self, YDB_DEL_NODE);
+}
+
+static PyObject *Key_delete_tree(YDBKeyObject *self, PyObject *unused) {
+	UNUSED(unused);
+	return Key_delete(self, YDB_DEL_TREE);
+}
+
+static PyObject *Key_lock_incr(YDBKeyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int		   status;
+	unsigned long long timeout_nsec;
+
+	timeout_nsec = 0;
+	static char *kwlist[] = {"timeout_nsec", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!parse_fastcall_args(args, nargs, kwnames, "|K", "lock_incr", kwlist, &timeout_nsec))
+		return NULL;
+
+	YDBPY_CALL(status, lock_incr, timeout_nsec, &self->buffers[0], self->subs_used, &self->buffers[1]);
+	if (YDB_LOCK_TIMEOUT == status) {
+		PyErr_SetString(YDBLockTimeoutError, "Not able to acquire all requested locks in the specified time.");
+		return NULL;
+	} else if (YDB_OK != status) {
+		raise_YDBError(status);
+		return NULL;
+	}
+	Py_RETURN_NONE;
+}
+
+static PyObject *Key_lock_decr(YDBKeyObject *self, PyObject *unused) {
+	int status;
+
+	UNUSED(unused);
+	YDBPY_CALL(status, lock_decr, &self->buffers[0], self->subs_used, &self->buffers[1]);
+	if (YDB_OK != status) {
+		raise_YDBError(status);
+		return NULL;
+	}
+	Py_RETURN_NONE;
+}
+
+/* Shared implementation of Key.subscript_next() and Key.subscript_previous(). These iterate over the subscripts
+ * at the level of the last subscript of the Key, or under the varname for a varname-level Key, starting from
+ * the subscript last returned by either method. YDBNodeEnd is raised once all subscripts are exhausted, until
+ * the iteration is restarted by passing `reset=True`.
+ */
+static PyObject *Key_subscript_order(YDBKeyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames,
+				     bool is_next) {
+	int	      reset, status, depth;
+	ydb_buffer_t  subsarray[YDB_MAX_SUBS], *ret_value;
+	PyObject *    ret, *cursor;
+	const char *  fname;
+
+	reset = FALSE;
+	fname = is_next ? "subscript_next" : "subscript_previous";
+	static char *kwlist[] = {"reset", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!parse_fastcall_args(args, nargs, kwnames, "|p", fname, kwlist, &reset))
+		return NULL;
+	if (reset) {
+		Py_CLEAR(self->cursor);
+	}
+
+	ret_value = get_value_buffer();
+	if (NULL == ret_value) {
+		return NULL;
+	}
+	/* The iteration replaces the last subscript of the Key with the cursor, or adds it for a varname-level Key */
+	depth = (0 == self->subs_used) ? 1 : self->subs_used;
+	memcpy(subsarray, &self->buffers[1], (depth - 1) * sizeof(ydb_buffer_t));
+	/* Hold a reference to the cursor, which another thread may replace while the GIL is released in threaded mode */
+	cursor = self->cursor;
+	if (NULL == cursor) {
+		YDB_LITERAL_TO_BUFFER("", &subsarray[depth - 1]);
+	} else {
+		Py_INCREF(cursor);
+		subsarray[depth - 1].buf_addr = PyBytes_AS_STRING(cursor);
+		subsarray[depth - 1].len_used = subsarray[depth - 1].len_alloc
+		    = Py_SAFE_DOWNCAST(PyBytes_GET_SIZE(cursor), Py_ssize_t, unsigned int);
+	}
+
+	if (is_next) {
+		YDBPY_CALL(status, subscript_next, &self->buffers[0], depth, subsarray, ret_value);
+	} else {
+		YDBPY_CALL(status, subscript_previous, &self->buffers[0], depth, subsarray, ret_value);
+	}
+	if (YDB_ERR_INVSTRLEN == status) {
+		grow_value_buffer(ret_value);
+		if (is_next) {
+			YDBPY_CALL(status, subscript_next, &self->buffers[0], depth, subsarray, ret_value);
+		} else {
+			YDBPY_CALL(status, subscript_previous, &self->buffers[0], depth, subsarray, ret_value);
+		}
+		assert(YDB_ERR_INVSTRLEN != status);
+	}
+	Py_XDECREF(cursor);
+	if (YDB_OK != status) {
+		raise_YDBError(status);
+		return NULL;
+	}
+	ret = PyBytes_FromStringAndSize(ret_value->buf_addr, ret_value->len_used); // New Reference
+	if (NULL != ret) {
+		Py_INCREF(ret);
+		Py_XSETREF(self->cursor, ret);
+	}
+	return ret;
+}
+
+static PyObject *Key_subscript_next(YDBKeyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	return Key_subscript_order(self, args, nargs, kwnames, TRUE);
+}
+
+static PyObject *Key_subscript_previous(YDBKeyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	return Key_subscript_order(self, args, nargs, kwnames, FALSE);
+}
+
+/* Support pickling and copying by recreating the Key from its varname and subscripts */
+static PyObject *Key_reduce(YDBKeyObject *self, PyObject *unused) {
+	UNUSED(unused);
+	return Py_BuildValue("(O(OOO))", Py_TYPE(self), self->varname, Py_None, self->subsarray); // New Reference
+}
+
+static PyObject *Key_subscript(YDBKeyObject *self, PyObject *item) {
+	return new_child_Key(Py_TYPE(self), self, item);
+}
+
+static int Key_ass_subscript(YDBKeyObject *self, PyObject *item, PyObject *value) {
+	bool	  success;
+	PyObject *child;
+
+	if (NULL == value) {
+		PyErr_Format(PyExc_TypeError, "'%.200s' object doesn't support item deletion", Py_TYPE(self)->tp_name);
+		return -1;
+	}
+	child = new_child_Key(Py_TYPE(self), self, item); // New Reference
+	if (NULL == child) {
+		return -1;
+	}
+	success = set_Key_value((YDBKeyObject *)child, value);
+	Py_DECREF(child);
+	return success ? 0 : -1;
+}
+
+/* Two Keys are equal if they represent the same node. A Key compared to any other object is equal if the value of
+ * the node it represents is equal to that object.
+ */
+static PyObject *Key_richcompare(YDBKeyObject *self, PyObject *other, int op) {
+	int	  equal;
+	PyObject *value, *ret;
+
+	if ((Py_EQ != op) && (Py_NE != op)) {
+		Py_RETURN_NOTIMPLEMENTED;
+	}
+	if (PyObject_TypeCheck(other, &KeyType)) {
+		equal = PyObject_RichCompareBool(self->varname, ((YDBKeyObject *)other)->varname, Py_EQ);
+		if (1 == equal) {
+			equal = PyObject_RichCompareBool(self->subsarray, ((YDBKeyObject *)other)->subsarray, Py_EQ);
+		}
+		if (0 > equal) {
+			return NULL;
+		}
+		return PyBool_FromLong((Py_EQ == op) ? equal : !equal);
+	}
+	value = Key_value_or_default(self, Py_None); // New Reference
+	if (NULL == value) {
+		return NULL;
+	}
+	ret = PyObject_RichCompare(value, other, op);
+	Py_DECREF(value);
+	return ret;
+}
+
+static Py_hash_t Key_hash(YDBKeyObject *self) {
+	PyObject *identity;
+
+	if (-1 == self->hash) {
+		identity = PyTuple_Pack(2, self->varname, self->subsarray); // New Reference
+		if (NULL == identity) {
+			return -1;
+		}
+		self->hash = PyObject_Hash(identity);
+		Py_DECREF(identity);
+	}
+	return self->hash;
+}
+
+static PyGetSetDef Key_getset[] = {
+    {"name", (getter)Key_get_name, NULL, "the last subscript of the node, or its varname if it has no subscripts", NULL},
+    {"parent", (getter)Key_get_parent, NULL, "the Key for the node one level up, or None for an unsubscripted variable", NULL},
+    {"varname", (getter)Key_get_varname, NULL, "the name of the local or global variable the node falls under", NULL},
+    {"varname_key", (getter)Key_get_varname_key, NULL, "the Key for the unsubscripted variable the node falls under", NULL},
+    {"subsarray", (getter)Key_get_subsarray, NULL, "a new list of the subscripts of the node", NULL},
+    {"subsarray_keys", (getter)Key_get_subsarray_keys, NULL, "a list of the Keys for each subscript level down to the node",
+     NULL},
+    {"value", (getter)Key_get_value, (setter)Key_set_value, "the value of the node as bytes, or None if it has no value", NULL},
+    {"data", (getter)Key_get_data, NULL, "0, 1, 10 or 11, per ydb_data_s()", NULL},
+    {"has_value", (getter)Key_get_has_value, NULL, "whether the node has a value", NULL},
+    {"has_tree", (getter)Key_get_has_tree, NULL, "whether the node has a subtree", NULL},
+    {NULL, NULL, NULL, NULL, NULL} /* Sentinel */
+};
+
+static PyMethodDef Key_methods[] = {
+    {"get", (PyCFunction)Key_get, METH_FASTCALL | METH_KEYWORDS,
+     "returns the value of the node, or 'default' (None if omitted) if it has no value"},
+    {"set", (PyCFunction)Key_set, METH_FASTCALL | METH_KEYWORDS, "sets the value of the node"},
+    {"incr", (PyCFunction)Key_incr, METH_FASTCALL | METH_KEYWORDS,
+     "increments the value of the node by 'increment' (1 if omitted) and returns the new value"},
+    {"delete_node", (PyCFunction)Key_delete_node, METH_NOARGS, "deletes the value of the node"},
+    {"delete_tree", (PyCFunction)Key_delete_tree, METH_NOARGS, "deletes the value and any subtree of the node"},
+    {"lock_incr", (PyCFunction)Key_lock_incr, METH_FASTCALL | METH_KEYWORDS,
+     "acquires a lock on the node without releasing other locks, incrementing it if already held"},
+    {"lock_decr", (PyCFunction)Key_lock_decr, METH_NOARGS, "decrements the count of the lock held on the node"},
+    {"subscript_next", (PyCFunction)Key_subscript_next, METH_FASTCALL | METH_KEYWORDS,
+     "returns the next subscript at the level of the node, raising YDBNodeEnd once they are exhausted\n"
+     "until the iteration is reset by passing 'reset=True'"},
+    {"subscript_previous", (PyCFunction)Key_subscript_previous, METH_FASTCALL | METH_KEYWORDS,
+     "returns the previous subscript at the level of the node, raising YDBNodeEnd once they are exhausted\n"
+     "until the iteration is reset by passing 'reset=True'"},
+    {"__reduce__", (PyCFunction)Key_reduce, METH_NOARGS, NULL},
+    {NULL, NULL, 0, NULL} /* Sentinel */
+};
+
+static PyMappingMethods Key_as_mapping = {
+    .mp_subscript = (binaryfunc)Key_subscript,
+    .mp_ass_subscript = (objobjargproc)Key_ass_subscript,
+};
+
+static PyTypeObject KeyType = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "_yottadb.Key",
+    .tp_doc = "Key(name, parent=None, subsarray=None)\n--\n\n"
+	      "A single local or global variable node. The node is named either by a varname 'name' and optional\n"
+	      "'subsarray', or by a parent Key and the subscript 'name' under it.",
+    .tp_basicsize = sizeof(YDBKeyObject),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+    .tp_new = Key_new,
+    .tp_dealloc = (destructor)Key_dealloc,
+    .tp_hash = (hashfunc)Key_hash,
+    .tp_richcompare = (richcmpfunc)Key_richcompare,
+    .tp_as_mapping = &Key_as_mapping,
+    .tp_methods = Key_methods,
+    .tp_getset = Key_getset,
+};
+
+/* Batch operations */
+
+/* Routine to load a YDBKeyRef from an item of a sequence passed to one of the batch wrappers, e.g. get_many().
+ * The item may be either a Key object, whose buffers are used as is, or a list or tuple of a varname and an
+ * optional subsarray, which is loaded into the scratch YDBKey of `dest`. Either way, the caller must release
+ * `dest` with free_YDBKeyRef() once it is no longer needed. On failure, an exception is raised and nothing
+ * needs to be released.
+ *
+ * Parameters:
+ *    dest       - pointer to the YDBKeyRef to fill.
+ *    item       - the Python object representing the key.
+ *    index      - the position of `item` in its sequence, for use in error messages.
+ *    arg_prefix - error message prefix naming the argument `item` was taken from, e.g. YDBPY_ERR_KEYS_INVALID.
+ */
+static bool load_YDBKeyRef(YDBKeyRef *dest, PyObject *item, Py_ssize_t index, char *arg_prefix) {
+	Py_ssize_t len_key_seq;
+	PyObject * varname, *subsarray;
+
+	dest->loaded = FALSE;
+	if (PyObject_TypeCheck(item, &KeyType)) {
+		YDBKeyObject *key = (YDBKeyObject *)item;
+
+		dest->varname = &key->buffers[0];
+		dest->subs_used = key->subs_used;
+		dest->subsarray = &key->buffers[1];
+		return TRUE;
+	}
+	if (!(PyTuple_Check(item) || PyList_Check(item))) {
+		raise_ValidationError(YDBPython_TypeError, arg_prefix, YDBPY_ERR_ITEM_NOT_KEY, index);
+		return FALSE;
+	}
+	len_key_seq = PySequence_Fast_GET_SIZE(item);
+	if ((1 != len_key_seq) && (2 != len_key_seq)) {
+		raise_ValidationError(YDBPython_ValueError, arg_prefix, YDBPY_ERR_KEY_IN_SEQUENCE_INCORRECT_LENGTH, index);
+		return FALSE;
+	}
+	varname = PySequence_Fast_GET_ITEM(item, 0); // Borrowed Reference
+	if ((!PyUnicode_Check(varname)) && (!PyBytes_Check(varname))) {
+		raise_ValidationError(YDBPython_TypeError, arg_prefix, YDBPY_ERR_ITEM_NOT_BYTES_LIKE, index);
+		return FALSE;
+	}
+	subsarray = (2 == len_key_seq) ? PySequence_Fast_GET_ITEM(item, 1) : Py_None; // Borrowed Reference
+	if (Py_None != subsarray) {
+		int  copied;
+		char tmp_prefix[YDBPY_MAX_ERRORMSG];
+		char err_prefix[YDBPY_MAX_ERRORMSG];
+
+		/* Build a nested error prefix noting which key is faulty, as done by is_valid_key_sequence() */
+		copied = snprintf(tmp_prefix, YDBPY_MAX_ERRORMSG, arg_prefix, YDBPY_ERR_KEY_IN_SEQUENCE_SUBSARRAY_INVALID);
+		assert(copied < YDBPY_MAX_ERRORMSG);
+		UNUSED(copied);
+		copied = snprintf(err_prefix, YDBPY_MAX_ERRORMSG, tmp_prefix, index, "%s");
+		assert(copied < YDBPY_MAX_ERRORMSG);
+		UNUSED(copied);
+		if (!is_valid_sequence(subsarray, YDBPython_KeySequence, err_prefix)) {
+			return FALSE;
+		}
+	}
+	if (!load_YDBKey(&dest->storage, varname, subsarray)) {
+		return FALSE;
+	}
+	dest->loaded = TRUE;
+	dest->varname = &dest->storage.varname;
+	dest->subs_used = dest->storage.subs_used;
+	dest->subsarray = dest->storage.subsarray;
+	return TRUE;
+}
+
+/* Routine to release the references held by a YDBKeyRef, if any.
+ *
+ * Parameters:
+ *    key    - pointer to the YDBKeyRef to free.
+ */
+static void free_YDBKeyRef(YDBKeyRef *key) {
+	if (key->loaded) {
+		free_YDBKey(&key->storage);
+		key->loaded = FALSE;
+	}
+}
+
+/* Batch wrapper for ydb_get_s(). Returns a list of the values of each of the nodes in `keys`, with `default`
+ * in place of the value of any undefined node. All keys share the calling thread's value buffer and a single
+ * scratch YDBKey, so no memory is allocated for the calls themselves.
+ */
+static PyObject *get_many(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int	      status;
+	Py_ssize_t    num_keys;
+	PyObject *    keys_py, *default_py, *keys_seq, *value, *ret;
+	ydb_buffer_t *ret_value;
+	YDBKeyRef     key;
+
+	UNUSED(self);
+	/* Default values for optional arguments passed from Python */
+	default_py = Py_None;
+
+	/* Parse */
+	static char *kwlist[] = {"keys", "default", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!parse_fastcall_args(args, nargs, kwnames, "O|O", "get_many", kwlist, &keys_py, &default_py))
+		return NULL;
+
+	/* Setup for calls */
+	ret_value = get_value_buffer();
+	if (NULL == ret_value) {
+		return NULL;
+	}
+	keys_seq = PySequence_Fast(keys_py, "'keys' argument must be iterable"); // New Reference
+	if (NULL == keys_seq) {
+		return NULL;
+	}
+	num_keys = PySequence_Fast_GET_SIZE(keys_seq);
+	ret = PyList_New(num_keys); // New Reference
+	if (NULL == ret) {
+		DECREF_AND_RETURN(keys_seq, NULL);
+	}
+
+	for (Py_ssize_t i = 0; i < num_keys; i++) {
+		if (!load_YDBKeyRef(&key, PySequence_Fast_GET_ITEM(keys_seq, i), i, YDBPY_ERR_KEYS_INVALID)) {
+			value = NULL;
+		} else {
+			/* Call the wrapped function */
+			YDBPY_CALL(status, get, key.varname, key.subs_used, key.subsarray, ret_value);
+			if (YDB_ERR_INVSTRLEN == status) {
+				grow_value_buffer(ret_value);
+				YDBPY_CALL(status, get, key.varname, key.subs_used, key.subsarray, ret_value);
+				assert(YDB_ERR_INVSTRLEN != status);
+			}
+			free_YDBKeyRef(&key);
+			if ((YDB_ERR_LVUNDEF == status) || (YDB_ERR_GVUNDEF == status)) {
+				Py_INCREF(default_py);
+				value = default_py;
+			} else if (YDB_OK != status) {
+				raise_YDBError(status);
+				value = NULL;
+			} else {
+				value = PyBytes_FromStringAndSize(ret_value->buf_addr, ret_value->len_used); // New Reference
+			}
+		}
+		if (NULL == value) {
+			Py_DECREF(ret);
+			DECREF_AND_RETURN(keys_seq, NULL);
+		}
+		PyList_SET_ITEM(ret, i, value); // Steals Reference
+	}
+	Py_DECREF(keys_seq);
+	return ret;
+}
+
+/* Batch wrapper for ydb_set_s(). Sets each node to the corresponding value given by `pairs`, which may be either
+ * a sequence of (key, value) pairs or a dict mapping keys to values. Keys are as accepted by get_many(), except
+ * that only tuples and Key objects may be used as dict keys. The nodes are set in order, stopping at the first
+ * error, such that any nodes before the one that caused the error will remain set.
+ */
+static PyObject *set_many(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int	     status;
+	bool	     success;
+	Py_ssize_t   num_pairs;
+	PyObject *   pairs_py, *pairs_seq, *pair, *value_py, *value_owner;
+	ydb_buffer_t value_ydb;
+	YDBKeyRef    key;
+
+	UNUSED(self);
+
+	/* Parse */
+	static char *kwlist[] = {"pairs", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!parse_fastcall_args(args, nargs, kwnames, "O", "set_many", kwlist, &pairs_py))
+		return NULL;
+
+	/* Setup for calls */
+	if (PyDict_Check(pairs_py)) {
+		pairs_seq = PyDict_Items(pairs_py); // New Reference
+	} else {
+		pairs_seq = PySequence_Fast(pairs_py, "'pairs' argument must be iterable"); // New Reference
+	}
+	if (NULL == pairs_seq) {
+		return NULL;
+	}
+	num_pairs = PySequence_Fast_GET_SIZE(pairs_seq);
+
+	success = TRUE;
+	for (Py_ssize_t i = 0; i < num_pairs; i++) {
+		pair = PySequence_Fast_GET_ITEM(pairs_seq, i); // Borrowed Reference
+		if (!(PyTuple_Check(pair) || PyList_Check(pair)) || (2 != PySequence_Fast_GET_SIZE(pair))) {
+			raise_ValidationError(YDBPython_TypeError, YDBPY_ERR_PAIRS_INVALID, YDBPY_ERR_ITEM_NOT_PAIR, i);
+			success = FALSE;
+			break;
+		}
+		if (!load_YDBKeyRef(&key, PySequence_Fast_GET_ITEM(pair, 0), i, YDBPY_ERR_PAIRS_INVALID)) {
+			success = FALSE;
+			break;
+		}
+		value_py = PySequence_Fast_GET_ITEM(pair, 1); // Borrowed Reference
+		if (Py_None == value_py) {
+			// The value was None, so set node to empty string.
+			YDB_LITERAL_TO_BUFFER("", &value_ydb);
+			value_owner = NULL;
+		} else if (YDB_OK != anystr_to_borrowed_buffer(value_py, &value_ydb, FALSE, &value_owner)) {
+			free_YDBKeyRef(&key);
+			success = FALSE;
+			break;
+		}
+
+		/* Call the wrapped function */
+		YDBPY_CALL(status, set, key.varname, key.subs_used, key.subsarray, &value_ydb);
+		free_YDBKeyRef(&key);
+		Py_XDECREF(value_owner);
+		if (YDB_OK != status) {
+			raise_YDBError(status);
+			success = FALSE;
+			break;
+		}
+	}
+	Py_DECREF(pairs_seq);
+	if (!success) {
+		return NULL;
+	}
+	Py_RETURN_NONE;
+}
+
+/* Batch wrapper for ydb_data_s(). Returns a list of the ydb_data_s() results for each of the nodes in `keys`. */
+static PyObject *data_many(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int	     status;
+	unsigned int ret_value;
+	Py_ssize_t   num_keys;
+	PyObject *   keys_py, *keys_seq, *value, *ret;
+	YDBKeyRef    key;
+
+	UNUSED(self);
+
+	/* Parse */
+	static char *kwlist[] = {"keys", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!parse_fastcall_args(args, nargs, kwnames, "O", "data_many", kwlist, &keys_py))
+		return NULL;
+
+	/* Setup for calls */
+	keys_seq = PySequence_Fast(keys_py, "'keys' argument must be iterable"); // New Reference
+	if (NULL == keys_seq) {
+		return NULL;
+	}
+	num_keys = PySequence_Fast_GET_SIZE(keys_seq);
+	ret = PyList_New(num_keys); // New Reference
+	if (NULL == ret) {
+		DECREF_AND_RETURN(keys_seq, NULL);
+	}
+
+	for (Py_ssize_t i = 0; i < num_keys; i++) {
+		if (!load_YDBKeyRef(&key, PySequence_Fast_GET_ITEM(keys_seq, i), i, YDBPY_ERR_KEYS_INVALID)) {
+			value = NULL;
+		} else {
+			/* Call the wrapped function */
+			YDBPY_CALL(status, data, key.varname, key.subs_used, key.subsarray, &ret_value);
+			free_YDBKeyRef(&key);
+			if (YDB_OK != status) {
+				raise_YDBError(status);
+				value = NULL;
+			} else {
+				value = PyLong_FromUnsignedLong(ret_value); // New Reference
+			}
+		}
+		if (NULL == value) {
+			Py_DECREF(ret);
+			DECREF_AND_RETURN(keys_seq, NULL);
+		}
+		PyList_SET_ITEM(ret, i, value); // Steals Reference
+	}
+	Py_DECREF(keys_seq);
+	return ret;
+}
+
+/* Perform each of the increments requested of incr_many(), storing the new value of each node in `args->values`
+ * if requested. This is called either directly or as a transaction callback by call_tp(), so as in callback_wrapper(),
+ * YDB_ERR_TPCALLBACKINVRETVAL is returned if a Python exception was raised. Otherwise, the status of the first
+ * failing ydb_incr_s() call is returned, such that a transaction is restarted when YottaDB requires it.
+ */
+static int incr_many_callback(void *incr_many_args) {
+	int		 status, subs_used;
+	Py_ssize_t	 num_items;
+	PyObject *	 item, *subsarray_py, *increment_py, *increment_owner, *value;
+	PyObject *	 subs_owners[YDB_MAX_SUBS];
+	ydb_buffer_t	 subsarray_ydb[YDB_MAX_SUBS], increment_ydb, *increment, ret_value;
+	char		 ret_buffer[CANONICAL_NUMBER_TO_STRING_MAX];
+	YDBIncrManyArgs *args;
+
+	args = (YDBIncrManyArgs *)incr_many_args;
+	ret_value.buf_addr = ret_buffer;
+	ret_value.len_alloc = CANONICAL_NUMBER_TO_STRING_MAX;
+	num_items = PySequence_Fast_GET_SIZE(args->items);
+	for (Py_ssize_t i = 0; i < num_items; i++) {
+		/* Each item is either the subscripts of a node, or a pair of those and an increment specific to that node */
+		item = PySequence_Fast_GET_ITEM(args->items, i); // Borrowed Reference
+		subsarray_py = item;
+		increment_py = NULL;
+		if ((PyTuple_Check(item) || PyList_Check(item)) && (2 == PySequence_Fast_GET_SIZE(item))) {
+			PyObject *first = PySequence_Fast_GET_ITEM(item, 0); // Borrowed Reference
+
+			if (PyTuple_Check(first) || PyList_Check(first)) {
+				subsarray_py = first;
+				increment_py = PySequence_Fast_GET_ITEM(item, 1); // Borrowed Reference
+			}
+		}
+		if (PyUnicode_Check(subsarray_py) || PyBytes_Check(subsarray_py)) {
+			// A single subscript may be given on its own
+			subs_used = 1;
+			if (YDB_OK != anystr_to_borrowed_buffer(subsarray_py, &subsarray_ydb[0], FALSE, &subs_owners[0])) {
+				return YDB_ERR_TPCALLBACKINVRETVAL;
+			}
+		} else {
+			if ((Py_None == subsarray_py) || !is_valid_sequence(subsarray_py, YDBPython_SubsarraySequence, NULL)) {
+				if (!PyErr_Occurred()) {
+					raise_ValidationError(YDBPython_TypeError, YDBPY_ERR_SUBSARRAY_INVALID,
+							      YDBPY_ERR_NOT_LIST_OR_TUPLE);
+				}
+				return YDB_ERR_TPCALLBACKINVRETVAL;
+			}
+			subs_used = Py_SAFE_DOWNCAST(PySequence_Fast_GET_SIZE(subsarray_py), Py_ssize_t, int);
+			if (YDB_OK != borrow_py_sequence_as_buffer_array(subsarray_py, subs_used, subsarray_ydb, subs_owners)) {
+				return YDB_ERR_TPCALLBACKINVRETVAL;
+			}
+		}
+		if (NULL == increment_py) {
+			increment = args->increment;
+			increment_owner = NULL;
+		} else {
+			if (!increment_to_borrowed_buffer(increment_py, &increment_ydb, &increment_owner)) {
+				RELEASE_BUFFER_OWNERS(subs_owners, subs_used);
+				return YDB_ERR_TPCALLBACKINVRETVAL;
+			}
+			increment = &increment_ydb;
+		}
+
+		/* Call the wrapped function */
+		ret_value.len_used = 0;
+		YDBPY_CALL(status, incr, args->varname, subs_used, subsarray_ydb, increment, &ret_value);
+		RELEASE_BUFFER_OWNERS(subs_owners, subs_used);
+		Py_XDECREF(increment_owner);
+		if (YDB_OK != status) {
+			return status;
+		}
+		if (NULL != args->values) {
+			value = PyBytes_FromStringAndSize(ret_value.buf_addr, ret_value.len_used); // New Reference
+			if (NULL == value) {
+				return YDB_ERR_TPCALLBACKINVRETVAL;
+			}
+			// Steals Reference, and releases any value stored by an earlier try of a restarted transaction
+			PyList_SetItem(args->values, i, value);
+		}
+	}
+	return YDB_OK;
+}
+
+/* Batch wrapper for ydb_incr_s(). Increments each of the nodes under `varname` given by `subscripts`, using
+ * either the increment paired with the node's subscripts or `increment`. If `return_values` is set, returns a
+ * list of the new value of each node in the same order. If `in_tp` is set, all increments are done in a single
+ * transaction, identified by `transid`, so that they either all take effect or none do.
+ */
+static PyObject *incr_many(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int		status, return_values, in_tp;
+	const char *	transid;
+	PyObject *	varname_py, *subscripts_py, *increment_py, *varname_owner, *increment_owner, *values;
+	ydb_buffer_t	varname_ydb, increment_ydb;
+	YDBIncrManyArgs incr_many_args;
+
+	UNUSED(self);
+	/* Default values for optional arguments passed from Python */
+	increment_py = NULL;
+	return_values = FALSE;
+	in_tp = FALSE;
+	transid = "";
+
+	/* Parse */
+	static char *kwlist[] = {"varname", "subscripts", "increment", "return_values", "in_tp", "transid", NULL};
 	/* Parsed values are borrowed references, do not Py_DECREF them. */
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O", kwlist, &varname_py, &subsarray_py)) {
+	if (!parse_fastcall_args(args, nargs, kwnames, "OO|Opps", "incr_many", kwlist, &varname_py, &subscripts_py,
+				 &increment_py, &return_values, &in_tp, &transid)) {
 		return NULL;
 	}
-	RETURN_IF_INVALID_SEQUENCE(subsarray_py, YDBPython_SubsarraySequence);
-
-	/* Setup for call */
-	INVOKE_ANYSTR_TO_BUFFER(varname_py, varname_ydb, TRUE);
-	INVOKE_POPULATE_SUBS_USED_AND_SUBSARRAY_AND_CLEANUP_VARNAME(subsarray_py, subs_used, subsarray_ydb, varname_ydb);
-	YDB_MALLOC_BUFFER(&ret_value, YDBPY_DEFAULT_SUBSCRIPT_LEN);
 
-	/* Call the wrapped function */
-	status = ydb_subscript_previous_s(&varname_ydb, subs_used, subsarray_ydb, &ret_value);
+	/* Setup for calls */
+	if (YDB_OK != anystr_to_borrowed_buffer(varname_py, &varname_ydb, TRUE, &varname_owner)) {
+		return NULL;
+	}
+	if (!increment_to_borrowed_buffer((Py_None == increment_py) ? NULL : increment_py, &increment_ydb,
+					  &increment_owner)) {
+		Py_DECREF(varname_owner);
+		return NULL;
+	}
+	incr_many_args.items = PySequence_Fast(subscripts_py, "'subscripts' argument must be iterable"); // New Reference
+	if (NULL == incr_many_args.items) {
+		Py_DECREF(varname_owner);
+		Py_XDECREF(increment_owner);
+		return NULL;
+	}
+	values = NULL;
+	if (return_values) {
+		values = PyList_New(PySequence_Fast_GET_SIZE(incr_many_args.items)); // New Reference
+		if (NULL == values) {
+			Py_DECREF(incr_many_args.items);
+			Py_DECREF(varname_owner);
+			Py_XDECREF(increment_owner);
+			return NULL;
+		}
+	}
+	incr_many_args.varname = &varname_ydb;
+	incr_many_args.increment = &increment_ydb;
+	incr_many_args.values = values;
 
-	/* Check whether length of string was longer than YDBPY_DEFAULT_SUBSCRIPT_LEN.
-	 * If so, try again with proper length
-	 */
-	if (YDB_ERR_INVSTRLEN == status) {
-		FIX_BUFFER_LENGTH(ret_value);
-		status = ydb_subscript_previous_s(&varname_ydb, subs_used, subsarray_ydb, &ret_value);
-		assert(YDB_ERR_INVSTRLEN != status);
+	/* Call the wrapped function for each node */
+	if (in_tp) {
+		status = call_tp(incr_many_callback, &incr_many_args, transid, 0, NULL);
+	} else {
+		status = incr_many_callback(&incr_many_args);
 	}
-	YDB_FREE_BUFFER(&varname_ydb);
-	FREE_BUFFER_ARRAY(subsarray_ydb, subs_used);
+	Py_DECREF(incr_many_args.items);
+	Py_DECREF(varname_owner);
+	Py_XDECREF(increment_owner);
 
-	/* Check status for Errors and Raise Exception */
 	if (YDB_OK != status) {
-		raise_YDBError(status);
-	} else {
-		/* Create Python object to return. Creates a new reference */
-		ret = Py_BuildValue("y#", ret_value.buf_addr, (Py_ssize_t)ret_value.len_used);
+		if (YDB_ERR_TPCALLBACKINVRETVAL != status) {
+			raise_YDBError(status);
+		} // Otherwise, the exception was already raised in incr_many_callback()
+		Py_XDECREF(values);
+		return NULL;
 	}
-	YDB_FREE_BUFFER(&ret_value);
-	return ret;
+	if (NULL == values) {
+		Py_RETURN_NONE;
+	}
+	return values;
 }
 
-/* Callback functions used by Wrapper for ydb_tp_s() */
-
-/* Callback Wrapper used by tp_st. The approach of calling a Python function is a
- * bit of a hack. Here's how it works:
- *      1) This is the callback function that is always passed to the ydb_tp_st
- *              Simple API function and should only ever be called by ydb_tp_st
- *              via tp() below. It assumes that everything passed to it was validated.
- *      2) The actual Python function to be called is passed to this function
- *              as the first element in a Python tuple.
- *      3) The positional arguments are passed as the second element and the
- *              keyword args are passed as the third.
- *      4) This function calls calls the Python callback function with the args and
- *              kwargs arguments.
- *      5) if a function raises an exception then this function returns TPCALLBACKINVRETVAL
- *              as a way of indicating an error.
- *      Note: the PyErr String is already set so the the function receiving the return
- *              value (tp()) just needs to return NULL.
+/* Does the work of merge() both with and without TP, copying the next `chunk_size` nodes of the source subtree, or
+ * all of them if it is 0. Starts with the root of the subtree on the first call, or after the last node copied by
+ * the previous call otherwise. The position reached is only saved in `args->position` for the next call, so that a
+ * restarted transaction copies the same nodes again.
  */
-static int callback_wrapper(void *function_with_arguments) {
-	int	  ret_value;
-	bool	  decref_args = false;
-	bool	  decref_kwargs = false;
-	PyObject *function, *args, *kwargs, *ret;
-	PyObject *err_object;
-
-	function = PyTuple_GetItem(function_with_arguments, 0); // Borrowed Reference
-	args = PyTuple_GetItem(function_with_arguments, 1);	// Borrowed Reference
-	kwargs = PyTuple_GetItem(function_with_arguments, 2);	// Borrowed Reference
-
-	if (Py_None == args) {
-		args = PyTuple_New(0);
-		decref_args = true;
+static int merge_callback(void *merge_args) {
+	int		status, in_subs_used, out_subs_used, depth;
+	unsigned long	count, root_count;
+	ydb_buffer_t *	value_buffer, *in_subsarray, *out_subsarray, *next;
+	ydb_buffer_t	dst_subsarray[YDB_MAX_SUBS];
+	YDBSubsBuffers *subs_buffers;
+	YDBMergeArgs *	args;
+
+	args = (YDBMergeArgs *)merge_args;
+	value_buffer = get_value_buffer();
+	subs_buffers = get_subs_buffers();
+	if ((NULL == value_buffer) || (NULL == subs_buffers)) {
+		return YDB_ERR_TPCALLBACKINVRETVAL;
 	}
-	if (Py_None == kwargs) {
-		kwargs = PyDict_New();
-		decref_kwargs = true;
+	memcpy(dst_subsarray, args->dst->subsarray, args->dst->subs_used * sizeof(ydb_buffer_t));
+	status = YDB_OK;
+	root_count = 0;
+	if (args->started) {
+		in_subsarray = args->position[args->current];
+		in_subs_used = args->position_used[args->current];
+	} else {
+		/* As with the M MERGE command, the value of the root of the subtree is copied too */
+		in_subsarray = args->src->subsarray;
+		in_subs_used = args->src->subs_used;
+		YDBPY_CALL(status, get, args->src->varname, args->src->subs_used, args->src->subsarray, value_buffer);
+		if (YDB_ERR_INVSTRLEN == status) {
+			grow_value_buffer(value_buffer);
+			YDBPY_CALL(status, get, args->src->varname, args->src->subs_used, args->src->subsarray, value_buffer);
+			assert(YDB_ERR_INVSTRLEN != status);
+		}
+		if (YDB_OK == status) {
+			YDBPY_CALL(status, set, args->dst->varname, args->dst->subs_used, dst_subsarray, value_buffer);
+			root_count = 1;
+		} else if ((YDB_ERR_LVUNDEF == status) || (YDB_ERR_GVUNDEF == status)) {
+			status = YDB_OK;
+		}
 	}
 
-	ret = PyObject_Call(function, args, kwargs); // New Reference
-
-	if (decref_args)
-		Py_DECREF(args);
-	if (decref_kwargs)
-		Py_DECREF(kwargs);
-
-	if (NULL == ret) {
-		/* No return value was specified, signalling that `function` raised an exception.
-		 * So, confirm that an exception was actually raised and determine the value to
-		 * return to ydb_tp_s based on that, specifically looking out for YDB_TP_RESTART
-		 * and YDB_TP_ROLLBACK.
-		 *
-		 *      Note: Do not need to `PyErr_SetString` because this or similar operation
-		 *              was done when the exception was raised by `function`
-		 */
-		err_object = PyErr_Occurred();
-		/* An exception should have been raised, but PyErr_Occurred() returned NULL.
-		 * This should not happen, so assert that here.
-		 */
-		assert(err_object);
-		if (PyErr_GivenExceptionMatches(err_object, YDBTPRestart)) {
-			PyErr_Clear();
-			return YDB_TP_RESTART;
-		} else if (PyErr_GivenExceptionMatches(err_object, YDBTPRollback)) {
-			PyErr_Clear();
-			return YDB_TP_ROLLBACK;
-		} else {
-			/* If no TP-related exceptions occurred, return a default of YDB_ERR_TPCALLBACKINVRETVAL
-			 * to signal to ydb_tp_s() that callback function is invalid without specifying a particular
-			 * TP handling scenario, i.e. YDB_TP_RESTART or YDB_TP_ROLLBACK.
-			 */
+	args->done = FALSE;
+	args->chunk_count = 0;
+	for (count = 0; (YDB_OK == status) && ((0 == args->chunk_size) || (count < args->chunk_size)); count++) {
+		out_subsarray = subs_buffers->arrays[count % 2];
+		out_subs_used = YDB_MAX_SUBS;
+		YDBPY_CALL(status, node_next, args->src->varname, in_subs_used, in_subsarray, &out_subs_used, out_subsarray);
+		while (YDB_ERR_INVSTRLEN == status) {
+			grow_value_buffer(&out_subsarray[out_subs_used]);
+			out_subs_used = YDB_MAX_SUBS;
+			YDBPY_CALL(status, node_next, args->src->varname, in_subs_used, in_subsarray, &out_subs_used, out_subsarray);
+		}
+		/* Stop at the first node outside of the subtree */
+		if ((YDB_ERR_NODEEND == status)
+		    || ((YDB_OK == status)
+			&& ((out_subs_used <= args->src->subs_used)
+			    || !has_subs_prefix(out_subsarray, out_subs_used, args->src->subsarray, args->src->subs_used)))) {
+			args->done = TRUE;
+			status = YDB_OK;
+			break;
+		} else if (YDB_OK != status) {
+			break;
+		}
+		depth = args->dst->subs_used + out_subs_used - args->src->subs_used;
+		if (YDB_MAX_SUBS < depth) {
+			raise_ValidationError(YDBPython_ValueError, "'dst_key' argument invalid: ", YDBPY_ERR_SEQUENCE_TOO_LONG,
+					      (long)depth, YDB_MAX_SUBS);
 			return YDB_ERR_TPCALLBACKINVRETVAL;
 		}
-	} else if (!PyLong_Check(ret)) {
-		PyErr_SetString(PyExc_TypeError, "Callback function must return value of type int.");
-		return YDB_ERR_TPCALLBACKINVRETVAL;
+
+		YDBPY_CALL(status, get, args->src->varname, out_subs_used, out_subsarray, value_buffer);
+		if (YDB_ERR_INVSTRLEN == status) {
+			grow_value_buffer(value_buffer);
+			YDBPY_CALL(status, get, args->src->varname, out_subs_used, out_subsarray, value_buffer);
+			assert(YDB_ERR_INVSTRLEN != status);
+		}
+		if (YDB_OK != status) {
+			break;
+		}
+		/* Swap the subscripts of the source root for those of the destination */
+		memcpy(&dst_subsarray[args->dst->subs_used], &out_subsarray[args->src->subs_used],
+		       (out_subs_used - args->src->subs_used) * sizeof(ydb_buffer_t));
+		YDBPY_CALL(status, set, args->dst->varname, depth, dst_subsarray, value_buffer);
+		in_subsarray = out_subsarray;
+		in_subs_used = out_subs_used;
 	}
-	ret_value = (int)PyLong_AsLong(ret);
-	Py_DECREF(ret);
-	return ret_value;
+	if (YDB_OK != status) {
+		return status;
+	}
+	args->chunk_count = root_count + count;
+	if (!args->done) {
+		/* Save the position reached for the next chunk, which the subscript buffer arrays are reused by */
+		next = args->position[1 - args->current];
+		for (int i = 0; i < in_subs_used; i++) {
+			if (next[i].len_alloc < in_subsarray[i].len_used) {
+				YDB_FREE_BUFFER(&next[i]);
+				YDB_MALLOC_BUFFER(&next[i], in_subsarray[i].len_used);
+			}
+			memcpy(next[i].buf_addr, in_subsarray[i].buf_addr, in_subsarray[i].len_used);
+			next[i].len_used = in_subsarray[i].len_used;
+		}
+		args->position_used[1 - args->current] = in_subs_used;
+	}
+	return YDB_OK;
 }
 
-/* Wrapper for ydb_tp_s() */
-static PyObject *tp(PyObject *self, PyObject *args, PyObject *kwds) {
-	bool	      return_null = false;
-	int	      namecount, status;
-	char *	      transid;
-	PyObject *    callback, *callback_args, *callback_kwargs, *varnames_py, *function_with_arguments;
-	ydb_buffer_t *varnames_ydb;
+/* Copies the subtree of the node given by `src_key` to the node given by `dst_key`, as done by the M MERGE command:
+ * each node of the source, including its root, is set at the destination with the subscripts of the source root
+ * replaced by those of the destination, leaving any other node of the destination in place. Both keys are either
+ * Key objects or (varname, subsarray) sequences. Returns the number of nodes copied.
+ *
+ * If `in_tp` is True, the nodes are copied in transactions identified by `transid`, each of `chunk_size` nodes, or a
+ * single one for the whole subtree if it is 0, so that large subtrees can be merged without exceeding the limits of
+ * a single transaction. Otherwise, `chunk_size` only changes how the nodes are copied, not their end result.
+ */
+static PyObject *merge(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	bool	      same_node;
+	int	      status, in_tp;
+	unsigned long chunk_size;
+	const char *  transid;
+	PyObject *    src_py, *dst_py;
+	YDBKeyRef     src, dst;
+	YDBMergeArgs  merge_args;
 
 	UNUSED(self);
 	/* Default values for optional arguments passed from Python */
-	callback_args = Py_None;
-	callback_kwargs = Py_None;
+	in_tp = FALSE;
 	transid = "";
-	namecount = 0;
-	varnames_py = Py_None;
+	chunk_size = 0;
 
-	/* parse and validate */
-	static char *kwlist[] = {"callback", "args", "kwargs", "transid", "varnames", NULL};
+	/* Parse and validate */
+	static char *kwlist[] = {"src_key", "dst_key", "in_tp", "transid", "chunk_size", NULL};
 	/* Parsed values are borrowed references, do not Py_DECREF them. */
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|OOsO", kwlist, &callback, &callback_args, &callback_kwargs, &transid,
-					 &varnames_py)) {
-		return_null = true;
+	if (!parse_fastcall_args(args, nargs, kwnames, "OO|psk", "merge", kwlist, &src_py, &dst_py, &in_tp, &transid,
+				 &chunk_size)) {
+		return NULL;
 	}
-
-	/* validate input */
-	if (!PyCallable_Check(callback)) {
-		PyErr_SetString(PyExc_TypeError, "'callback' must be a callable.");
-		return_null = true;
+	if (!load_YDBKeyRef(&src, src_py, 0, "'src_key' argument invalid: ")) {
+		return NULL;
 	}
-	if ((Py_None != callback_args) && !PyTuple_Check(callback_args)) {
-		PyErr_SetString(PyExc_TypeError, "'args' must be a tuple. "
-						 "(It will be passed to the callback "
-						 "function as positional arguments.)");
-		return_null = true;
+	if (!load_YDBKeyRef(&dst, dst_py, 0, "'dst_key' argument invalid: ")) {
+		free_YDBKeyRef(&src);
+		return NULL;
 	}
-	if ((Py_None != callback_kwargs) && !PyDict_Check(callback_kwargs)) {
-		PyErr_SetString(PyExc_TypeError, "'kwargs' must be a dictionary. "
-						 "(It will be passed to the callback function as keyword arguments.)");
-		return_null = true;
+	if ((src.varname->len_used == dst.varname->len_used)
+	    && (0 == memcmp(src.varname->buf_addr, dst.varname->buf_addr, src.varname->len_used))
+	    && (has_subs_prefix(src.subsarray, src.subs_used, dst.subsarray, dst.subs_used)
+		|| has_subs_prefix(dst.subsarray, dst.subs_used, src.subsarray, src.subs_used))) {
+		/* As with the M MERGE command, merging a node into itself does nothing, while merging it into one of its
+		 * descendants or ancestors is an error, as the copy would change the subtree being copied.
+		 */
+		same_node = (src.subs_used == dst.subs_used);
+		free_YDBKeyRef(&dst);
+		free_YDBKeyRef(&src);
+		if (same_node) {
+			return PyLong_FromLong(0);
+		}
+		PyErr_SetString(PyExc_ValueError, YDBPY_ERR_MERGE_DESCENDANT);
+		return NULL;
 	}
-	RETURN_IF_INVALID_SEQUENCE(varnames_py, YDBPython_VarnameSequence);
-	if (!return_null) {
-		/* Setup for Call */
-		/* New Reference */
-		function_with_arguments = Py_BuildValue("(OOO)", callback, callback_args, callback_kwargs);
-		if (Py_None != varnames_py)
-			namecount = PySequence_Length(varnames_py);
 
-		if (0 < namecount) {
-			varnames_ydb = (ydb_buffer_t *)malloc(namecount * sizeof(ydb_buffer_t));
-			status = convert_py_sequence_to_ydb_buffer_array(varnames_py, namecount, varnames_ydb);
-			if (YDB_OK != status) {
-				Py_DECREF(function_with_arguments);
-				return NULL;
-			}
+	/* Call the wrapped functions for each chunk of nodes */
+	memset(&merge_args, 0, sizeof(merge_args));
+	merge_args.src = &src;
+	merge_args.dst = &dst;
+	merge_args.chunk_size = chunk_size;
+	do {
+		if (in_tp) {
+			status = call_tp(merge_callback, &merge_args, transid, 0, NULL);
 		} else {
-			varnames_ydb = NULL;
+			status = merge_callback(&merge_args);
+		}
+		if (YDB_OK != status) {
+			break;
+		}
+		/* The chunk is committed, so the next one starts where it stopped */
+		merge_args.count += merge_args.chunk_count;
+		merge_args.current = 1 - merge_args.current;
+		merge_args.started = TRUE;
+	} while (!merge_args.done);
+	for (int i = 0; i < 2; i++) {
+		for (int j = 0; j < YDB_MAX_SUBS; j++) {
+			YDB_FREE_BUFFER(&merge_args.position[i][j]);
 		}
+	}
+	free_YDBKeyRef(&dst);
+	free_YDBKeyRef(&src);
 
-		/* Call the wrapped function */
-		status = ydb_tp_s(callback_wrapper, function_with_arguments, transid, namecount, varnames_ydb);
-		/* Check status for errors and raise exception */
-		if (YDB_ERR_TPCALLBACKINVRETVAL == status) {
-			// Exception already raised in callback_wrapper
-			return_null = true;
-		} else if (YDB_OK != status) {
+	if (YDB_OK != status) {
+		if (YDB_ERR_TPCALLBACKINVRETVAL != status) {
 			raise_YDBError(status);
-			return_null = true;
-		}
-		/* Free allocated memory */
-		Py_DECREF(function_with_arguments);
-		FREE_BUFFER_ARRAY(varnames_ydb, namecount);
+		} // Otherwise, the exception was already raised in merge_callback()
+		return NULL;
 	}
+	return PyLong_FromUnsignedLongLong(merge_args.count);
+}
 
-	if (return_null) {
+/* Convert each item of `strings`, an iterable of str or bytes objects, to or from $ZWRITE format with ydb_str2zwr_s()
+ * if `to_zwr` is set or ydb_zwr2str_s() otherwise. All conversions share the calling thread's value buffer, which is
+ * only grown for a result longer than any before it. Returns a new list of the results as bytes objects, or NULL with
+ * a Python exception raised.
+ */
+static PyObject *convert_zwr_many(PyObject *strings_py, bool to_zwr) {
+	int	      status;
+	Py_ssize_t    num_items;
+	PyObject *    items, *item_owner, *converted, *ret;
+	ydb_buffer_t  item_ydb, *out;
+
+	out = get_value_buffer();
+	if (NULL == out) {
 		return NULL;
-	} else {
-		return Py_BuildValue("i", status);
 	}
+	items = PySequence_Fast(strings_py, "'strings' argument must be iterable"); // New Reference
+	if (NULL == items) {
+		return NULL;
+	}
+	num_items = PySequence_Fast_GET_SIZE(items);
+	ret = PyList_New(num_items); // New Reference
+	if (NULL == ret) {
+		DECREF_AND_RETURN(items, NULL);
+	}
+	for (Py_ssize_t i = 0; i < num_items; i++) {
+		if (YDB_OK != anystr_to_borrowed_buffer(PySequence_Fast_GET_ITEM(items, i), &item_ydb, FALSE, &item_owner)) {
+			Py_DECREF(ret);
+			DECREF_AND_RETURN(items, NULL);
+		}
+		if (to_zwr) {
+			YDBPY_CALL(status, str2zwr, &item_ydb, out);
+		} else {
+			YDBPY_CALL(status, zwr2str, &item_ydb, out);
+		}
+		if (YDB_ERR_INVSTRLEN == status) {
+			grow_value_buffer(out);
+			if (to_zwr) {
+				YDBPY_CALL(status, str2zwr, &item_ydb, out);
+			} else {
+				YDBPY_CALL(status, zwr2str, &item_ydb, out);
+			}
+			assert(YDB_ERR_INVSTRLEN != status);
+		}
+		Py_DECREF(item_owner);
+		if (YDB_OK != status) {
+			raise_YDBError(status);
+			Py_DECREF(ret);
+			DECREF_AND_RETURN(items, NULL);
+		}
+		converted = PyBytes_FromStringAndSize(out->buf_addr, out->len_used); // New Reference
+		if (NULL == converted) {
+			Py_DECREF(ret);
+			DECREF_AND_RETURN(items, NULL);
+		}
+		PyList_SET_ITEM(ret, i, converted); // Steals Reference
+	}
+	Py_DECREF(items);
+	return ret;
 }
 
-/* Wrapper for ydb_zwr2str_s() */
-static PyObject *zwr2str(PyObject *self, PyObject *args, PyObject *kwds) {
-	int	     status;
-	Py_ssize_t   zwr_py_len;
-	PyObject *   zwr_py;
-	PyObject *   ret;
-	ydb_buffer_t zwr_ydb, str_ydb;
+/* Batch wrapper for ydb_str2zwr_s(). Returns a list of each item of `strings` in $ZWRITE format. */
+static PyObject *str2zwr_many(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	PyObject *strings_py;
 
 	UNUSED(self);
-	ret = NULL;
-
 	/* Parse */
-	static char *kwlist[] = {"input", NULL};
+	static char *kwlist[] = {"strings", NULL};
 	/* Parsed values are borrowed references, do not Py_DECREF them. */
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|K", kwlist, &zwr_py, &zwr_py_len))
+	if (!parse_fastcall_args(args, nargs, kwnames, "O", "str2zwr_many", kwlist, &strings_py)) {
 		return NULL;
-
-	/* Setup for Call */
-	INVOKE_ANYSTR_TO_BUFFER(zwr_py, zwr_ydb, FALSE);
-	YDB_MALLOC_BUFFER(&str_ydb, YDBPY_DEFAULT_VALUE_LEN);
-
-	/* Call the wrapped function */
-	status = ydb_zwr2str_s(&zwr_ydb, &str_ydb);
-	/* recall with properly sized buffer if zwr_ydb is not long enough */
-	if (YDB_ERR_INVSTRLEN == status) {
-		FIX_BUFFER_LENGTH(str_ydb);
-		/* recall the wrapped function */
-		status = ydb_zwr2str_s(&zwr_ydb, &str_ydb);
-		assert(YDB_ERR_INVSTRLEN != status);
-	}
-	YDB_FREE_BUFFER(&zwr_ydb);
-
-	/* Check status for errors and raise Exception */
-	if (YDB_OK != status) {
-		raise_YDBError(status);
-	} else {
-		/* New Reference */
-		ret = Py_BuildValue("y#", str_ydb.buf_addr, (Py_ssize_t)str_ydb.len_used);
 	}
-	YDB_FREE_BUFFER(&str_ydb);
-	return ret;
+	return convert_zwr_many(strings_py, TRUE);
 }
 
-/*Comprehensive API
- *Utility Functions
- *
- *    ydb_child_init()
- *    ydb_exit()
- *    ydb_file_id_free() / ydb_file_id_free_t()
- *    ydb_file_is_identical() / ydb_file_is_identical_t()
- *    ydb_file_name_to_id() / ydb_file_name_to_id_t()
- *    ydb_fork_n_core()
- *    ydb_free()
- *    ydb_hiber_start()
- *    ydb_hiber_start_wait_any()
- *    ydb_init()
- *    ydb_malloc()
- *    ydb_message() / ydb_message_t()
- *    ydb_stdout_stderr_adjust() / ydb_stdout_stderr_adjust_t()
- *    ydb_thread_is_main()
- *    ydb_timer_cancel() / ydb_timer_cancel_t()
- *    ydb_timer_start() / ydb_timer_start_t()
+/* Batch wrapper for ydb_zwr2str_s(). Returns a list of each item of `strings` converted from $ZWRITE format. */
+static PyObject *zwr2str_many(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	PyObject *strings_py;
 
- *Calling M Routines
- */
+	UNUSED(self);
+	/* Parse */
+	static char *kwlist[] = {"strings", NULL};
+	/* Parsed values are borrowed references, do not Py_DECREF them. */
+	if (!parse_fastcall_args(args, nargs, kwnames, "O", "zwr2str_many", kwlist, &strings_py)) {
+		return NULL;
+	}
+	return convert_zwr_many(strings_py, FALSE);
+}
 
 /* Pull everything together into a Python Module */
 /* First we will create an array of structs that represent the methods in the module.
@@ -2314,81 +6323,163 @@ static PyObject *zwr2str(PyObject *self, PyObject *args, PyObject *kwds) {
  * Each struct has 4 elements:
  *      1. The Python name of the method
  *      2. The C function that is to be called when the method is called
- *      3. How the function can be called (all these functions allow for calling with both positional and keyword arguments)
+ *      3. How the function can be called (all these functions allow for calling with both positional and keyword arguments,
+ *         using the vectorcall protocol via METH_FASTCALL)
  *      4. The docstring for this method (to be used by help() in the Python REPL)
  * The final struct is a sentinel value to indicate the end of the array (i.e. {NULL, NULL, 0, NULL})
  */
 static PyMethodDef methods[] = {
     /* Simple and Simple API Functions */
-    {"ci", (PyCFunction)ci, METH_VARARGS | METH_KEYWORDS,
+    {"ci", (PyCFunction)ci, METH_FASTCALL | METH_KEYWORDS,
      "call an M routine defined in the call-in table specified by either the ydb_ci environment variable\n"
      "or switch_ci_table() using the arguments passed, if any"},
-    {"cip", (PyCFunction)cip, METH_VARARGS | METH_KEYWORDS,
+    {"cip", (PyCFunction)cip, METH_FASTCALL | METH_KEYWORDS,
      "call an M routine defined in the call-in table specified by the ydb_ci environment variable\n"
      "or switch_ci_table() using the arguments passed, if any, while using cached call-in\n"
      "information for performance"},
-    {"data", (PyCFunction)data, METH_VARARGS | METH_KEYWORDS,
+    {"data", (PyCFunction)data, METH_FASTCALL | METH_KEYWORDS,
      "used to learn what type of data is at a node.\n "
      "0 : There is neither a value nor a subtree, "
      "i.e., it is undefined.\n"
      "1 : There is a value, but no subtree\n"
      "10 : There is no value, but there is a subtree.\n"
      "11 : There are both a value and a subtree.\n"},
-    {"delete", (PyCFunction)delete_wrapper, METH_VARARGS | METH_KEYWORDS, "deletes node value or tree data at node"},
-    {"delete_excel", (PyCFunction)delete_excel, METH_VARARGS | METH_KEYWORDS,
+    {"data_many", (PyCFunction)data_many, METH_FASTCALL | METH_KEYWORDS,
+     "returns a list of the results of data() for each node in 'keys', a sequence of Key objects\n"
+     "or (varname, subsarray) lists or tuples"},
+    {"delete", (PyCFunction)delete_wrapper, METH_FASTCALL | METH_KEYWORDS, "deletes node value or tree data at node"},
+    {"delete_excel", (PyCFunction)delete_excel, METH_FASTCALL | METH_KEYWORDS,
      "delete the trees of all local variables "
      "except those in the 'varnames' array"},
-    {"get", (PyCFunction)get, METH_VARARGS | METH_KEYWORDS, "returns the value of a node or raises exception"},
-    {"incr", (PyCFunction)incr, METH_VARARGS | METH_KEYWORDS, "increments value by the value specified by 'increment'"},
-
-    {"lock", (PyCFunction)lock, METH_VARARGS | METH_KEYWORDS, "..."},
-
-    {"lock_decr", (PyCFunction)lock_decr, METH_VARARGS | METH_KEYWORDS,
+    {"export_zwr", (PyCFunction)export_zwr, METH_FASTCALL | METH_KEYWORDS,
+     "writes the nodes of the subtree at 'varname' and 'subsarray' to 'file', a file descriptor or file object, in ZWR\n"
+     "format through a buffer of 'chunk_size' bytes, and returns the number of nodes written"},
+    {"get", (PyCFunction)get, METH_FASTCALL | METH_KEYWORDS,
+     "returns the value of a node or raises exception. If 'default' is given, it is returned instead of\n"
+     "raising an exception when the node is undefined (YDB_ERR_LVUNDEF or YDB_ERR_GVUNDEF)"},
+    {"get_many", (PyCFunction)get_many, METH_FASTCALL | METH_KEYWORDS,
+     "returns a list of the values of each node in 'keys', a sequence of Key objects or (varname, subsarray)\n"
+     "lists or tuples. Undefined nodes are given the value 'default' (None if omitted) instead of raising an exception"},
+    {"import_zwr", (PyCFunction)import_zwr, METH_FASTCALL | METH_KEYWORDS,
+     "sets the nodes read from 'file', a file descriptor or file object, in ZWR format, in transactions of 'batch'\n"
+     "records identified by 'transid', or without transactions if 'batch' is 0, and returns the number of nodes set"},
+    {"incr", (PyCFunction)incr, METH_FASTCALL | METH_KEYWORDS, "increments value by the value specified by 'increment'"},
+    {"incr_many", (PyCFunction)incr_many, METH_FASTCALL | METH_KEYWORDS,
+     "increments each node under 'varname' given by 'subscripts', a sequence of subscript arrays or of\n"
+     "(subscript array, increment) pairs, by its paired increment or 'increment' (1 if omitted). If\n"
+     "'return_values' is True, returns a list of the new values. If 'in_tp' is True, all increments are\n"
+     "done in a single transaction identified by 'transid'"},
+
+    {"load_tree", (PyCFunction)load_tree, METH_FASTCALL | METH_KEYWORDS,
+     "returns a dictionary of nested dictionaries, one per subscript, holding the values of the nodes in the subtree\n"
+     "at 'varname' and 'subsarray' under their \"value\" key, loaded into 'tree' if given"},
+    {"load_json", (PyCFunction)load_json, METH_FASTCALL | METH_KEYWORDS,
+     "returns the JSON value stored by save_json() under 'varname' and 'subsarray', read in a single walk of its subtree"},
+    {"lock", (PyCFunction)lock, METH_FASTCALL | METH_KEYWORDS, "..."},
+
+    {"lock_decr", (PyCFunction)lock_decr, METH_FASTCALL | METH_KEYWORDS,
      "Decrements the count of the specified lock held "
      "by the process. As noted in the Concepts section, a "
      "lock whose count goes from 1 to 0 is released. A lock "
      "whose name is specified, but which the process does "
      "not hold, is ignored."},
-    {"lock_incr", (PyCFunction)lock_incr, METH_VARARGS | METH_KEYWORDS,
+    {"lock_incr", (PyCFunction)lock_incr, METH_FASTCALL | METH_KEYWORDS,
      "Without releasing any locks held by the process, "
      "attempt to acquire the requested lock incrementing it"
      " if already held."},
-    {"message", (PyCFunction)message, METH_VARARGS | METH_KEYWORDS,
+    {"merge", (PyCFunction)merge, METH_FASTCALL | METH_KEYWORDS,
+     "copies the subtree of 'src_key' to 'dst_key' as done by the M MERGE command, in transactions of 'chunk_size'\n"
+     "nodes, or a single one if 0, identified by 'transid' if 'in_tp' is True, and returns the number of nodes copied"},
+    {"message", (PyCFunction)message, METH_FASTCALL | METH_KEYWORDS,
      "return the message string corresponding to the specified error code number\n"},
-    {"node_next", (PyCFunction)node_next, METH_VARARGS | METH_KEYWORDS,
+    {"node_next", (PyCFunction)node_next, METH_FASTCALL | METH_KEYWORDS,
      "facilitate depth-first traversal of a local or global"
      " variable tree. returns string tuple of subscripts of"
-     " next node with value."},
-    {"node_previous", (PyCFunction)node_previous, METH_VARARGS | METH_KEYWORDS,
+     " next node with value. If 'default' is given, it is returned"
+     " instead of raising YDBNodeEnd when there is no next node."},
+    {"node_previous", (PyCFunction)node_previous, METH_FASTCALL | METH_KEYWORDS,
      "facilitate depth-first traversal of a local "
      "or global variable tree. returns string tuple"
-     "of subscripts of previous node with value."},
-    {"open_ci_table", (PyCFunction)open_ci_table, METH_VARARGS | METH_KEYWORDS,
+     "of subscripts of previous node with value. If 'default' is"
+     " given, it is returned instead of raising YDBNodeEnd when"
+     " there is no previous node."},
+    {"open_ci_table", (PyCFunction)open_ci_table, METH_FASTCALL | METH_KEYWORDS,
      "open the specified call-in table file to allow calls to functions specified therein using ci() and cip()\n"},
     {"release", (PyCFunction)release, METH_NOARGS,
      "returns the release number of the active YottaDB installation. Equivalent to $ZYRELEASE in M.\n"},
     {"adjust_stdout_stderr", (PyCFunction)adjust_stdout_stderr, METH_NOARGS,
      "Check whether stdout (file descriptor 1) and stderr (file descriptor 2) are the same file, and if so, route stderr writes to "
      "stdout instead.\n"},
-    {"set", (PyCFunction)set, METH_VARARGS | METH_KEYWORDS, "sets the value of a node or raises exception"},
-    {"str2zwr", (PyCFunction)str2zwr, METH_VARARGS | METH_KEYWORDS,
+    {"buffer_stats", (PyCFunction)buffer_stats, METH_FASTCALL | METH_KEYWORDS,
+     "returns a dict with the number of YottaDB calls repeated because a result buffer was too short\n"
+     "('invstrlen_retries') and the size of the calling thread's reusable value buffer ('value_buffer_len').\n"
+     "If 'reset' is True, the retry count is reset to zero after it is read.\n"},
+    {"drain_trace", (PyCFunction)drain_trace, METH_NOARGS,
+     "returns a list of the calls recorded as set up by enable_trace() since the last call, oldest first, and the\n"
+     "number of calls that were not kept because the ring buffer was full, emptying the ring buffer.\n"
+     "Each call is a dict of the 'op', 'varname', ZWR format 'subs', 'status', 'duration_ns' and wall clock 'time_ns'.\n"},
+    {"enable_stats", (PyCFunction)enable_stats, METH_FASTCALL | METH_KEYWORDS,
+     "start counting and timing the calls made to YottaDB, as reported by stats(), or stop if 'enable' is False.\n"},
+    {"enable_threads", (PyCFunction)enable_threads, METH_NOARGS,
+     "switch to the threaded API of YottaDB, releasing the GIL for the duration of each call to YottaDB.\n"
+     "Must be called before any other call to YottaDB in the process.\n"},
+    {"enable_trace", (PyCFunction)enable_trace, METH_FASTCALL | METH_KEYWORDS,
+     "start recording the calls made to YottaDB that take at least 'threshold_ns' nanoseconds in a ring buffer of\n"
+     "'size' entries, as returned by drain_trace(), or stop if 'enable' is False.\n"},
+    {"scan", (PyCFunction)scan, METH_FASTCALL | METH_KEYWORDS,
+     "returns a tuple of a list of up to 'limit' (subscripts, value) pairs for the nodes in the subtree at\n"
+     "'varname' and 'subsarray', starting with its root or after 'start' if given and ending before 'stop' if given,\n"
+     "and the subscripts to pass as 'start' to resume the scan, or None once the subtree is exhausted"},
+    {"scan_range", (PyCFunction)scan_range, METH_FASTCALL | METH_KEYWORDS,
+     "returns a tuple of a list of up to 'limit' (subscript, value) pairs for the subscripts at the level below\n"
+     "'varname' and 'subs_prefix' from 'start', inclusive, to 'stop', exclusive, in collation order or in reverse\n"
+     "if 'reverse' is True, and the token to pass as 'token' to get the next page, or None once the range is exhausted"},
+    {"save_json", (PyCFunction)save_json, METH_FASTCALL | METH_KEYWORDS,
+     "stores 'json', a Python object representing a JSON value, under 'varname' and 'subsarray'"},
+    {"save_tree", (PyCFunction)save_tree, METH_FASTCALL | METH_KEYWORDS,
+     "sets the nodes of 'tree', a dictionary in the format returned by load_tree(), under 'varname' and 'subsarray',\n"
+     "after deleting the existing subtree if 'replace' is True, in a single transaction if 'in_tp' is True"},
+    {"set", (PyCFunction)set, METH_FASTCALL | METH_KEYWORDS, "sets the value of a node or raises exception"},
+    {"set_many", (PyCFunction)set_many, METH_FASTCALL | METH_KEYWORDS,
+     "sets the value of each node in 'pairs', a sequence of (key, value) pairs or a dict mapping keys to values,\n"
+     "where each key is a Key object or a (varname, subsarray) list or tuple"},
+    {"stats", (PyCFunction)stats, METH_FASTCALL | METH_KEYWORDS,
+     "returns a dict mapping the name of each YottaDB operation called since stats were enabled by enable_stats()\n"
+     "to a dict of its number of calls ('calls'), failed calls ('errors') and failed calls by error code ('statuses'),\n"
+     "value bytes passed to and received from YottaDB ('bytes_in', 'bytes_out'), total time in nanoseconds ('total_ns')\n"
+     "and a latency histogram ('latency') listing (start_ns, end_ns, count) for each non-empty bucket.\n"
+     "If 'reset' is True, all counters are reset to zero after they are read.\n"},
+    {"str2zwr", (PyCFunction)str2zwr, METH_FASTCALL | METH_KEYWORDS,
      "returns the zwrite formatted (Bytes Object) version of the"
      " Bytes object provided as input."},
-    {"subscript_next", (PyCFunction)subscript_next, METH_VARARGS | METH_KEYWORDS,
+    {"str2zwr_many", (PyCFunction)str2zwr_many, METH_FASTCALL | METH_KEYWORDS,
+     "returns a list of each item of 'strings' converted to $ZWRITE format"},
+    {"subscript_next", (PyCFunction)subscript_next, METH_FASTCALL | METH_KEYWORDS,
      "returns the name of the next subscript at "
-     "the same level as the one given"},
-    {"subscript_previous", (PyCFunction)subscript_previous, METH_VARARGS | METH_KEYWORDS,
+     "the same level as the one given. If 'default' "
+     "is given, it is returned instead of raising "
+     "YDBNodeEnd when there is no next subscript"},
+    {"subscript_previous", (PyCFunction)subscript_previous, METH_FASTCALL | METH_KEYWORDS,
      "returns the name of the previous "
      "subscript at the same level as the "
-     "one given"},
-    {"switch_ci_table", (PyCFunction)switch_ci_table, METH_VARARGS | METH_KEYWORDS,
+     "one given. If 'default' is given, it is "
+     "returned instead of raising YDBNodeEnd "
+     "when there is no previous subscript"},
+    {"switch_ci_table", (PyCFunction)switch_ci_table, METH_FASTCALL | METH_KEYWORDS,
      "switch to the call-in table referenced by the integer held in the passed handle\n"
      "and return the value of the previous handle"},
-    {"tp", (PyCFunction)tp, METH_VARARGS | METH_KEYWORDS, "transaction"},
-
-    {"zwr2str", (PyCFunction)zwr2str, METH_VARARGS | METH_KEYWORDS,
+    {"tp", (PyCFunction)tp, METH_FASTCALL | METH_KEYWORDS, "transaction"},
+    {"tp_stats", (PyCFunction)tp_stats, METH_FASTCALL | METH_KEYWORDS,
+     "returns a dict mapping the transid of the calls to tp() made while stats were enabled by enable_stats() to a\n"
+     "dict of their number of 'attempts', 'restarts', 'rollbacks', 'commits' and 'errors', and the nanoseconds spent\n"
+     "in their callbacks ('callback_ns') and in YottaDB otherwise, mostly committing ('commit_ns').\n"
+     "If 'reset' is True, all counters are reset to zero after they are read.\n"},
+
+    {"zwr2str", (PyCFunction)zwr2str, METH_FASTCALL | METH_KEYWORDS,
      "returns the Bytes Object from the zwrite formated Bytes "
      "object provided as input."},
+    {"zwr2str_many", (PyCFunction)zwr2str_many, METH_FASTCALL | METH_KEYWORDS,
+     "returns a list of each item of 'strings' converted from $ZWRITE format to a string"},
     /* API Utility Functions */
     {NULL, NULL, 0, NULL} /* Sentinel */
 };
@@ -2416,9 +6507,35 @@ static struct PyModuleDef _yottadbmodule = {PyModuleDef_HEAD_INIT,
  * This function must be named PyInit_{name of Module}
  */
 PyMODINIT_FUNC PyInit__yottadb(void) {
+	int status;
+
 	/* Initialize the module */
 	PyObject *module = PyModule_Create(&_yottadbmodule);
 
+	/* Create the key for the per-thread reusable value buffer, which is freed when each thread exits */
+	status = pthread_key_create(&value_buffer_key, free_value_buffer);
+	if (0 != status) {
+		raise_ValidationError(YDBPython_OSError, NULL, YDBPY_ERR_SYSCALL, "pthread_key_create", status, strerror(status));
+		Py_XDECREF(module);
+		return NULL;
+	}
+
+	/* Likewise for the per-thread reusable subscript buffers */
+	status = pthread_key_create(&subs_buffers_key, free_subs_buffers);
+	if (0 != status) {
+		raise_ValidationError(YDBPython_OSError, NULL, YDBPY_ERR_SYSCALL, "pthread_key_create", status, strerror(status));
+		Py_XDECREF(module);
+		return NULL;
+	}
+
+	/* Add the Key type */
+	if (0 > PyType_Ready(&KeyType)) {
+		Py_XDECREF(module);
+		return NULL;
+	}
+	Py_INCREF(&KeyType);
+	PyModule_AddObject(module, "Key", (PyObject *)&KeyType);
+
 	/* Defining Module 'Constants' */
 	PyObject *module_dictionary = PyModule_GetDict(module);
 
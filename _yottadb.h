@@ -2,7 +2,7 @@
  *                                                              *
  * Copyright (c) 2020-2021 Peter Goss All rights reserved.      *
  *                                                              *
- * Copyright (c) 2020-2022 YottaDB LLC and/or its subsidiaries. *
+ * Copyright (c) 2020-2026 YottaDB LLC and/or its subsidiaries. *
  * All rights reserved.                                         *
  *                                                              *
  *  This source code contains the intellectual property         *
@@ -17,13 +17,37 @@
 
 #define YDBPY_DEFAULT_VALUE_LEN	       32
 #define YDBPY_DEFAULT_SUBSCRIPT_LEN    16
-#define YDBPY_DEFAULT_SUBSCRIPT_COUNT  2
 #define CANONICAL_NUMBER_TO_STRING_MAX 48
+#define YDBPY_DEFAULT_SCAN_LIMIT       1024
+#define YDBPY_DEFAULT_ZWR_CHUNK_SIZE   (1 << 20)
+#define YDBPY_DEFAULT_ZWR_BATCH	       1000
+#define YDBPY_ZWR_HEADER_LINES	       2
+#define YDBPY_MAX_ZWR_LINE_IN_ERROR    80
+
+/* Latency histograms kept by stats() split each power of two of nanoseconds into 1 << YDBPY_STATS_SUB_BUCKET_BITS
+ * buckets, up to 1 << YDBPY_STATS_MAX_LATENCY_BITS nanoseconds (about 9 minutes), above which all calls share the
+ * last bucket. Up to YDBPY_STATS_MAX_STATUSES distinct error codes are counted individually for each operation.
+ */
+#define YDBPY_STATS_SUB_BUCKET_BITS  2
+#define YDBPY_STATS_SUB_BUCKETS	     (1 << YDBPY_STATS_SUB_BUCKET_BITS)
+#define YDBPY_STATS_MAX_LATENCY_BITS 39
+#define YDBPY_STATS_LATENCY_BUCKETS  ((YDBPY_STATS_MAX_LATENCY_BITS - YDBPY_STATS_SUB_BUCKET_BITS + 1) * YDBPY_STATS_SUB_BUCKETS)
+#define YDBPY_STATS_MAX_STATUSES     8
+
+/* Calls slower than the threshold passed to enable_trace() are kept in a ring buffer of YDBPY_DEFAULT_TRACE_SIZE entries
+ * by default, each holding up to YDBPY_TRACE_SUBS_LEN bytes of the subscripts of the node the call was made on.
+ */
+#define YDBPY_DEFAULT_TRACE_THRESHOLD_NS 1000000
+#define YDBPY_DEFAULT_TRACE_SIZE	 1024
+#define YDBPY_TRACE_SUBS_LEN		 128
 
 #define YDB_LOCK_MIN_ARGS		2
 #define YDB_LOCK_ARGS_PER_KEY		3
 #define YDB_CALL_VARIADIC_MAX_ARGUMENTS 36
 #define YDB_LOCK_MAX_KEYS		(YDB_CALL_VARIADIC_MAX_ARGUMENTS - YDB_LOCK_MIN_ARGS) / YDB_LOCK_ARGS_PER_KEY
+// The tptoken and errstr arguments taken first by every function of the threaded API
+#define YDBPY_THREADED_ARGS  2
+#define YDB_LOCK_ST_MAX_KEYS (YDB_CALL_VARIADIC_MAX_ARGUMENTS - YDBPY_THREADED_ARGS - YDB_LOCK_MIN_ARGS) / YDB_LOCK_ARGS_PER_KEY
 
 /* Large enough to fit any YDB error message, per
  * https://docs.yottadb.com/ProgrammersGuide/extrout.html#ydb-zstatus
@@ -70,6 +94,12 @@ typedef enum YDBPythonSequenceType {
 #define YDBPY_ERR_ITEM_NOT_BYTES_LIKE		    "item %ld is not a bytes-like object (bytes or str)"
 #define YDBPY_ERR_KEY_IN_SEQUENCE_NOT_LIST_OR_TUPLE "item %ld is not a list or tuple."
 #define YDBPY_ERR_KEY_IN_SEQUENCE_VARNAME_NOT_BYTES "item %ld in key sequence invalid: first element must be of type 'bytes'"
+#define YDBPY_ERR_ITEM_NOT_KEY			    "item %ld is not a Key, list or tuple."
+#define YDBPY_ERR_ITEM_NOT_PAIR			    "item %ld is not a (key, value) pair."
+#define YDBPY_ERR_INCR_TYPE			    "unsupported operand type(s) for +=: must be 'int', 'float', 'str', or 'bytes'"
+#define YDBPY_ERR_TREE_NOT_DICT_ARG		    "'tree' argument invalid: must be a dict"
+#define YDBPY_ERR_TREE_NOT_DICT			    "tree entry for subscript '%.*s' is not a dict"
+#define YDBPY_ERR_TREE_ITEM_INVALID		    "tree entry %R invalid: must be a dict, or the node value under the 'value' key"
 
 // ValueError messages
 #define YDBPY_ERR_EMPTY_FILENAME		   "YottaDB filenames must be one character or longer"
@@ -77,6 +107,12 @@ typedef enum YDBPythonSequenceType {
 #define YDBPY_ERR_SEQUENCE_TOO_LONG		   "invalid sequence length %ld: max %d"
 #define YDBPY_ERR_BYTES_TOO_LONG		   "invalid bytes length %ld: max %d"
 #define YDBPY_ERR_KEY_IN_SEQUENCE_INCORRECT_LENGTH "item %lu must be length 1 or 2."
+#define YDBPY_ERR_SCAN_LIMIT			   "invalid scan limit %d: must be greater than 0"
+#define YDBPY_ERR_CHUNK_SIZE			   "invalid chunk size %lu: must be greater than 0"
+#define YDBPY_ERR_TRACE_SIZE			   "invalid trace size %lu: must be greater than 0"
+#define YDBPY_ERR_ZWR_LINE_INVALID		   "invalid ZWR record at line %lu: %.*s"
+#define YDBPY_ERR_MERGE_DESCENDANT		   "invalid merge: source and destination nodes must not be descendants of each other"
+#define YDBPY_ERR_JSON_ARRAY_INDEX		   "invalid JSON array subscript %R: expected %zd"
 #define YDBPY_ERR_KEY_IN_SEQUENCE_VARNAME_TOO_LONG "item %ld in key sequence has invalid varname length %ld: max %d."
 
 #define YDBPY_ERR_KEY_IN_SEQUENCE_SUBSARRAY_INVALID "item %ld in key sequence has invalid subsarray: %s"
@@ -84,12 +120,33 @@ typedef enum YDBPythonSequenceType {
 #define YDBPY_ERR_VARNAME_INVALID     "'varnames' argument invalid: %s"
 #define YDBPY_ERR_SUBSARRAY_INVALID   "'subsarray' argument invalid: %s"
 #define YDBPY_ERR_KEYS_INVALID	      "'keys' argument invalid: %s"
+#define YDBPY_ERR_PAIRS_INVALID	      "'pairs' argument invalid: %s"
 #define YDBPY_ERR_ROUTINE_UNSPECIFIED "No call-in routine specified. Routine name required for M call-in."
 
 #define YDBPY_ERR_SYSCALL "System call failed: %s, return %d (%s)"
 
+// Threaded mode messages
+#define YDBPY_ERR_SIMPLE_API_USED "enable_threads() must be called before any other call to YottaDB in the process"
+
 #define YDBPY_ERR_FAILED_NUMERIC_CONVERSION "Failed to convert Python numeric value to internal representation"
 
+// Argument parsing messages, matching those issued by PyArg_ParseTupleAndKeywords()
+#define YDBPY_MAX_FASTCALL_ARGS	     8
+#define YDBPY_ERR_TOO_MANY_ARGS	     "%s() takes at most %d argument%s (%zd given)"
+#define YDBPY_ERR_INVALID_KEYWORD    "'%U' is an invalid keyword argument for %s()"
+#define YDBPY_ERR_DUPLICATE_ARGUMENT "argument for %s() given by name ('%s') and position (%d)"
+#define YDBPY_ERR_MISSING_ARGUMENT   "%s() missing required argument '%s' (pos %d)"
+#define YDBPY_ERR_ARGUMENT_TYPE	     "%s() argument '%s' must be %s, not %.50s"
+#define YDBPY_ERR_EMBEDDED_NULL	     "%s() argument '%s': embedded null character"
+#define YDBPY_ERR_INT_TOO_LARGE	     "signed integer is greater than maximum"
+#define YDBPY_ERR_INT_TOO_SMALL	     "signed integer is less than minimum"
+
+// Key messages
+#define YDBPY_ERR_KEY_NAME_NOT_BYTES_LIKE "'name' must be an instance of str or bytes"
+#define YDBPY_ERR_KEY_PARENT_NOT_KEY	  "'parent' must be of type Key"
+#define YDBPY_ERR_KEY_PARENT_AND_SUBS	  "Cannot create Key from both a parent key and a subsarray. Please specify one or the other."
+#define YDBPY_ERR_KEY_TOO_MANY_SUBS	  "Cannot create Key with %d subscripts (max: %d)"
+
 // Prevents compiler warnings for variables used only in asserts
 #define UNUSED(x) (void)(x)
 
@@ -103,13 +160,312 @@ void __assert_fail(const char *assertion, const char *file, unsigned int line, c
 }
 
 /* A structure that represents a key using YDB C types. used internally for
- * converting between Python and YDB C types.
+ * converting between Python and YDB C types. The buffers point directly into the
+ * storage of Python bytes objects, which are kept alive by the references held in
+ * `owners` (the varname first, followed by one per subscript) until the key is released
+ * with free_YDBKey(). Buffers are sized for the maximum number of subscripts so that a
+ * key can be declared on the stack without any allocation.
+ */
+typedef struct {
+	ydb_buffer_t varname;
+	int	     subs_used;
+	ydb_buffer_t subsarray[YDB_MAX_SUBS];
+	PyObject *   owners[1 + YDB_MAX_SUBS];
+} YDBKey;
+
+/* The Python-level _yottadb.Key type, representing a single local or global variable node. Unlike YDBKey, which
+ * only lives for the duration of a single call, a Key encodes its varname and subscripts once when it is created
+ * and keeps the resulting buffers for its whole lifetime, so that they can be passed straight to YottaDB on every
+ * operation. The node a Key represents never changes, which allows Keys to be hashed and used as dictionary keys.
+ *
+ * `buffers` holds `1 + subs_used` buffers: the varname followed by each subscript. They point into the bytes objects
+ * held by the `encoded` tuple, in the same order.
+ */
+typedef struct {
+	PyObject_HEAD
+	PyObject *    varname;	 // str or bytes, as passed by the caller
+	PyObject *    subsarray; // Tuple of str or bytes, as passed by the caller
+	PyObject *    parent;	 // Key one level up, or NULL for a varname-level Key or one not yet created
+	PyObject *    encoded;	 // Tuple of the bytes objects backing `buffers`
+	PyObject *    cursor;	 // Last subscript returned by Key.subscript_next()/subscript_previous(), or NULL
+	Py_hash_t     hash;	 // Cached hash, or -1 if not yet computed
+	int	      subs_used;
+	ydb_buffer_t *buffers;
+} YDBKeyObject;
+
+/* A reference to the varname and subscripts of a node, as taken from one of the keys passed to a batch wrapper,
+ * e.g. get_many(). For a Key object, the buffers are those of the Key itself. Otherwise, they are those of
+ * `storage`, which is then `loaded` and must be released with free_YDBKeyRef().
  */
 typedef struct {
 	ydb_buffer_t *varname;
 	int	      subs_used;
 	ydb_buffer_t *subsarray;
-} YDBKey;
+	bool	      loaded;
+	YDBKey	      storage;
+} YDBKeyRef;
+
+/* Per-thread arrays of buffers reused across calls to receive subscripts from YottaDB, e.g. by node_next(). Each array
+ * has room for the maximum number of subscripts, so YDB_ERR_INSUFFSUBS never occurs. Two arrays are kept so that
+ * scan() can pass the subscripts of one node back to YottaDB while receiving those of the next.
+ */
+typedef struct {
+	ydb_buffer_t arrays[2][YDB_MAX_SUBS];
+} YDBSubsBuffers;
+
+/* Arguments to incr_many_callback(), which does the work of incr_many() both with and without TP */
+typedef struct {
+	ydb_buffer_t *varname;
+	PyObject *    items;	 // Sequence of subscripts or (subscripts, increment) pairs, as returned by PySequence_Fast()
+	ydb_buffer_t *increment; // Increment for items that are not paired with their own
+	PyObject *    values;	 // List to receive the new value of each node, or NULL if not requested
+} YDBIncrManyArgs;
+
+/* Arguments to save_tree_callback(), which does the work of save_tree() both with and without TP */
+typedef struct {
+	YDBKey *  key;	   // Root of the tree, whose subsarray is extended with the subscripts of each nested level
+	PyObject *tree;	   // Dictionary in the format returned by load_tree()
+	bool	  replace; // Whether to delete the subtree of the root first
+} YDBSaveTreeArgs;
+
+/* Arguments to merge_callback(), which does the work of merge() both with and without TP. `position` holds the
+ * subscripts of the last node copied by the previous chunk in `position[current]`, while the next chunk saves its own
+ * in the other one, which only becomes current once that chunk is committed.
+ */
+typedef struct {
+	YDBKeyRef *    src;
+	YDBKeyRef *    dst;
+	unsigned long  chunk_size;  // Maximum number of nodes to copy per chunk, or 0 for no limit
+	unsigned long  chunk_count; // Number of nodes copied by the last chunk
+	unsigned long  count;	    // Number of nodes copied by all committed chunks
+	bool	       started;	    // Whether a chunk was committed, so that `position` is set
+	bool	       done;	    // Whether the last chunk reached the end of the source subtree
+	int	       current;
+	int	       position_used[2];
+	ydb_buffer_t   position[2][YDB_MAX_SUBS];
+} YDBMergeArgs;
+
+/* Output buffer of export_zwr(), which is written out to `fd` each time it is full */
+typedef struct {
+	int    fd;
+	char * buf;
+	size_t size;
+	size_t used;
+} YDBZwrWriter;
+
+/* Arguments to import_zwr_callback(), which does the work of import_zwr() both with and without TP. `batch` holds the
+ * lines of the current batch, each followed by a newline, with blank lines in place of any header lines.
+ */
+typedef struct {
+	int	      fd;
+	char *	      batch;
+	size_t	      batch_size;
+	size_t	      batch_used;
+	unsigned long batch_records; // Number of non-blank lines in the batch
+	unsigned long batch_lines;
+	unsigned long first_line; // Line number of the first line of the batch in the input
+	unsigned long count;	  // Number of nodes set by all committed batches
+} YDBImportArgs;
+
+/* State of load_json() as it walks the subtree of a JSON value, in which it is at the node given by `subsarray`. As in
+ * scan(), `subsarray` is the root of the subtree at first and then one of the per-thread subscript buffer arrays.
+ */
+typedef struct {
+	YDBKey *	root;
+	YDBSubsBuffers *subs_buffers;
+	ydb_buffer_t *	value_buffer; // Value of the current node
+	ydb_buffer_t *	subsarray;
+	int		subs_used;
+	int		common; // Number of leading subscripts shared with the previous node
+	int		count;	// Number of nodes read, to alternate between the subscript buffer arrays
+	bool		done;	// Whether the walk went past the last node of the subtree
+} YDBJSONReader;
+
+/* Per-thread state used by the threaded API, see enable_threads(). `errstr` points to `errstr_buf` once the state has
+ * been set up by reset_errstr(), and receives the message of any error returned by a call made by the thread.
+ */
+typedef struct {
+	uint64_t     tptoken;
+	ydb_buffer_t errstr;
+	ydb_char_t   errstr_buf[YDB_MAX_ERRORMSG];
+} YDBThreadState;
+
+/* A Simple API style transaction callback and its argument, as run by tp_callback_st() in threaded mode */
+typedef struct {
+	ydb_tpfnptr_t function;
+	void *	      args;
+} YDBTPCallback;
+
+/* The YottaDB operations counted by stats(), named after the functions called through YDBPY_CALL() and
+ * YDBPY_CALL_UTILITY(), plus those called through call_variadic_plist_func() and call_tp().
+ */
+#define YDBPY_FOR_EACH_OP(OP)                                                                                   \
+	OP(ci) OP(ci_get_info) OP(ci_tab_open) OP(ci_tab_switch) OP(cip) OP(data) OP(delete) OP(delete_excl) OP(get) \
+	OP(incr) OP(lock) OP(lock_decr) OP(lock_incr) OP(message) OP(node_next) OP(node_previous) OP(set)            \
+	OP(str2zwr) OP(subscript_next) OP(subscript_previous) OP(tp) OP(zwr2str)
+
+#define YDBPY_OP_ENUM(NAME) YDBPY_OP_##NAME,
+typedef enum YDBPyOp { YDBPY_FOR_EACH_OP(YDBPY_OP_ENUM) YDBPY_NUM_OPS } YDBPyOp;
+
+/* Counters kept by stats() for each operation. Only updated while holding the GIL. */
+typedef struct {
+	unsigned long long calls;
+	unsigned long long errors;
+	unsigned long long bytes_in;
+	unsigned long long bytes_out;
+	unsigned long long total_ns;
+	unsigned long long latency[YDBPY_STATS_LATENCY_BUCKETS];
+	int		   statuses[YDBPY_STATS_MAX_STATUSES];
+	unsigned long long status_counts[YDBPY_STATS_MAX_STATUSES];
+} YDBOpStats;
+
+/* A call to tp(), as passed to callback_wrapper(), which counts the attempts made to run the callback and, if `timed`,
+ * the time spent in it.
+ */
+typedef struct {
+	PyObject *	   function_with_arguments;
+	bool		   timed;
+	unsigned int	   attempts;
+	unsigned long long callback_ns;
+} YDBTPCallArgs;
+
+/* Counters kept by tp_stats() for the calls to tp() with a given transid. Only updated while holding the GIL. */
+typedef struct {
+	char *		   transid;
+	unsigned long long attempts;
+	unsigned long long restarts;
+	unsigned long long rollbacks;
+	unsigned long long commits;
+	unsigned long long errors;
+	unsigned long long callback_ns;
+	unsigned long long commit_ns;
+} YDBTPStats;
+
+/* A call slower than the threshold passed to enable_trace(), as reported by drain_trace(). The subscripts of the node the
+ * call was made on, if any, are stored back to back in `subs`, up to YDBPY_TRACE_SUBS_LEN bytes in all, beyond which they
+ * are truncated and `subs_truncated` is set.
+ */
+typedef struct {
+	YDBPyOp		   op;
+	int		   status;
+	unsigned long long duration_ns;
+	unsigned long long time_ns; // Wall clock time at which the call returned
+	unsigned int	   varname_len;
+	char		   varname[YDB_MAX_IDENT + 1];
+	int		   subs_used;
+	bool		   subs_truncated;
+	unsigned short	   subs_lens[YDB_MAX_SUBS];
+	char		   subs[YDBPY_TRACE_SUBS_LEN];
+} YDBTraceEntry;
+
+/* The number of value bytes passed to and received from YottaDB by a call to `ydb_<FUNC>_s()`, as recorded by stats(),
+ * given the status and arguments of the call. Expands to two comma-separated expressions.
+ */
+#define YDBPY_NO_BYTES 0, 0
+#define YDBPY_BYTES_ci_get_info(STATUS, ...)   YDBPY_NO_BYTES
+#define YDBPY_BYTES_ci_tab_open(STATUS, ...)   YDBPY_NO_BYTES
+#define YDBPY_BYTES_ci_tab_switch(STATUS, ...) YDBPY_NO_BYTES
+#define YDBPY_BYTES_data(STATUS, ...)	       YDBPY_NO_BYTES
+#define YDBPY_BYTES_delete(STATUS, ...)	       YDBPY_NO_BYTES
+#define YDBPY_BYTES_delete_excl(STATUS, ...)   YDBPY_NO_BYTES
+#define YDBPY_BYTES_get(STATUS, VARNAME, SUBS_USED, SUBSARRAY, RET_VALUE) \
+	0, ((YDB_OK == (STATUS)) ? (RET_VALUE)->len_used : 0)
+#define YDBPY_BYTES_incr(STATUS, VARNAME, SUBS_USED, SUBSARRAY, INCREMENT, RET_VALUE) \
+	((NULL == (INCREMENT)) ? 0 : (INCREMENT)->len_used), ((YDB_OK == (STATUS)) ? (RET_VALUE)->len_used : 0)
+#define YDBPY_BYTES_lock_decr(STATUS, ...)     YDBPY_NO_BYTES
+#define YDBPY_BYTES_lock_incr(STATUS, ...)     YDBPY_NO_BYTES
+#define YDBPY_BYTES_message(STATUS, ...)       YDBPY_NO_BYTES
+#define YDBPY_BYTES_node_next(STATUS, ...)     YDBPY_NO_BYTES
+#define YDBPY_BYTES_node_previous(STATUS, ...) YDBPY_NO_BYTES
+#define YDBPY_BYTES_set(STATUS, VARNAME, SUBS_USED, SUBSARRAY, VALUE) (VALUE)->len_used, 0
+#define YDBPY_BYTES_str2zwr(STATUS, STR, ZWR)			      (STR)->len_used, ((YDB_OK == (STATUS)) ? (ZWR)->len_used : 0)
+#define YDBPY_BYTES_subscript_next(STATUS, VARNAME, SUBS_USED, SUBSARRAY, RET_VALUE) \
+	0, ((YDB_OK == (STATUS)) ? (RET_VALUE)->len_used : 0)
+#define YDBPY_BYTES_subscript_previous(STATUS, VARNAME, SUBS_USED, SUBSARRAY, RET_VALUE) \
+	0, ((YDB_OK == (STATUS)) ? (RET_VALUE)->len_used : 0)
+#define YDBPY_BYTES_zwr2str(STATUS, ZWR, STR) (ZWR)->len_used, ((YDB_OK == (STATUS)) ? (STR)->len_used : 0)
+
+/* The node a call to `ydb_<FUNC>_s()` is made on, as recorded by enable_trace(), given the arguments of the call.
+ * Expands to the three comma-separated varname, subs_used and subsarray arguments of the call, or a NULL varname.
+ */
+#define YDBPY_NO_KEY				      NULL, 0, NULL
+#define YDBPY_KEY_FIRST(VARNAME, SUBS_USED, SUBSARRAY, ...) VARNAME, SUBS_USED, SUBSARRAY
+#define YDBPY_KEY_ci_get_info(...)		      YDBPY_NO_KEY
+#define YDBPY_KEY_ci_tab_open(...)		      YDBPY_NO_KEY
+#define YDBPY_KEY_ci_tab_switch(...)		      YDBPY_NO_KEY
+#define YDBPY_KEY_data(...)			      YDBPY_KEY_FIRST(__VA_ARGS__)
+#define YDBPY_KEY_delete(...)			      YDBPY_KEY_FIRST(__VA_ARGS__)
+#define YDBPY_KEY_delete_excl(...)		      YDBPY_NO_KEY
+#define YDBPY_KEY_get(...)			      YDBPY_KEY_FIRST(__VA_ARGS__)
+#define YDBPY_KEY_incr(...)			      YDBPY_KEY_FIRST(__VA_ARGS__)
+#define YDBPY_KEY_lock_decr(VARNAME, SUBS_USED, SUBSARRAY) VARNAME, SUBS_USED, SUBSARRAY
+#define YDBPY_KEY_lock_incr(TIMEOUT_NSEC, ...)	      YDBPY_KEY_FIRST(__VA_ARGS__, 0)
+#define YDBPY_KEY_message(...)			      YDBPY_NO_KEY
+#define YDBPY_KEY_node_next(...)		      YDBPY_KEY_FIRST(__VA_ARGS__)
+#define YDBPY_KEY_node_previous(...)		      YDBPY_KEY_FIRST(__VA_ARGS__)
+#define YDBPY_KEY_set(...)			      YDBPY_KEY_FIRST(__VA_ARGS__)
+#define YDBPY_KEY_str2zwr(...)			      YDBPY_NO_KEY
+#define YDBPY_KEY_subscript_next(...)		      YDBPY_KEY_FIRST(__VA_ARGS__)
+#define YDBPY_KEY_subscript_previous(...)	      YDBPY_KEY_FIRST(__VA_ARGS__)
+#define YDBPY_KEY_zwr2str(...)			      YDBPY_NO_KEY
+
+/* Make THREADED_CALL or SIMPLE_CALL depending on whether the threaded API is in use, as described for YDBPY_CALL(),
+ * evaluating BEFORE and AFTER immediately around the call, i.e. while the GIL is released in threaded mode.
+ */
+#define YDBPY_CALL_API(STATUS, THREADED_CALL, SIMPLE_CALL, BEFORE, AFTER)                                     \
+	{                                                                                                     \
+		if (threaded_api) {                                                                           \
+			ydb_buffer_t *errstr;                                                                 \
+                                                                                                              \
+			errstr = reset_errstr();                                                              \
+			Py_BEGIN_ALLOW_THREADS;                                                               \
+			BEFORE;                                                                               \
+			STATUS = THREADED_CALL;                                                               \
+			AFTER;                                                                                \
+			Py_END_ALLOW_THREADS;                                                                 \
+		} else {                                                                                      \
+			simple_api_used = TRUE;                                                               \
+			BEFORE;                                                                               \
+			STATUS = SIMPLE_CALL;                                                                 \
+			AFTER;                                                                                \
+		}                                                                                             \
+	}
+
+/* As YDBPY_CALL_API(), also recording the call under operation OP if stats are enabled by enable_stats() or calls are
+ * traced by enable_trace(). BYTES gives the number of bytes passed to and received from YottaDB and KEY the node the call
+ * is made on, as expanded from the YDBPY_BYTES_<FUNC>() and YDBPY_KEY_<FUNC>() macros. When neither is enabled, this only
+ * adds a test of `calls_timed` to the call.
+ */
+#define YDBPY_CALL_COUNTED(STATUS, OP, THREADED_CALL, SIMPLE_CALL, BYTES, KEY)                                              \
+	{                                                                                                                   \
+		if (calls_timed) {                                                                                          \
+			unsigned long long ydbpy_start, ydbpy_end;                                                          \
+                                                                                                                            \
+			YDBPY_CALL_API(STATUS, THREADED_CALL, SIMPLE_CALL, ydbpy_start = stats_clock(), ydbpy_end = stats_clock()); \
+			record_call(OP, STATUS, ydbpy_end - ydbpy_start, BYTES, KEY);                                       \
+		} else {                                                                                                    \
+			YDBPY_CALL_API(STATUS, THREADED_CALL, SIMPLE_CALL, (void)0, (void)0);                               \
+		}                                                                                                           \
+	}
+
+/* Call `ydb_<FUNC>_s()`, or `ydb_<FUNC>_st()` in threaded mode. In that case, the calling thread's tptoken and error
+ * string buffer are passed to YottaDB and the GIL is released for the duration of the call, so that other Python
+ * threads may run while this one waits on the database. The arguments must therefore only point to storage that no
+ * other thread can free or modify in the meantime, e.g. buffers borrowed from objects the caller holds references to.
+ * The arguments may be evaluated more than once, so must have no side effects.
+ */
+#define YDBPY_CALL(STATUS, FUNC, ...)                                                                              \
+	YDBPY_CALL_COUNTED(STATUS, YDBPY_OP_##FUNC, ydb_##FUNC##_st(thread_state.tptoken, errstr, __VA_ARGS__), \
+			   ydb_##FUNC##_s(__VA_ARGS__), YDBPY_BYTES_##FUNC(STATUS, __VA_ARGS__), YDBPY_KEY_##FUNC(__VA_ARGS__))
+
+/* As YDBPY_CALL(), without recording the call for stats() or enable_trace(), for calls made by those features themselves */
+#define YDBPY_CALL_UNCOUNTED(STATUS, FUNC, ...) \
+	YDBPY_CALL_API(STATUS, ydb_##FUNC##_st(thread_state.tptoken, errstr, __VA_ARGS__), ydb_##FUNC##_s(__VA_ARGS__), (void)0, (void)0)
+
+/* As YDBPY_CALL(), for the utility functions that are named `ydb_<FUNC>()` and `ydb_<FUNC>_t()` */
+#define YDBPY_CALL_UTILITY(STATUS, FUNC, ...)                                                                     \
+	YDBPY_CALL_COUNTED(STATUS, YDBPY_OP_##FUNC, ydb_##FUNC##_t(thread_state.tptoken, errstr, __VA_ARGS__), \
+			   ydb_##FUNC(__VA_ARGS__), YDBPY_BYTES_##FUNC(STATUS, __VA_ARGS__), YDBPY_KEY_##FUNC(__VA_ARGS__))
 
 #define YDB_COPY_BYTES_TO_BUFFER(BYTES, BYTES_LEN, BUFFERP, COPY_DONE) \
 	{                                                              \
@@ -122,33 +478,6 @@ typedef struct {
 		}                                                      \
 	}
 
-#define POPULATE_SUBS_USED_AND_SUBSARRAY(SUBSARRAY_PY, SUBSUSED, SUBSARRAY_YDB, RETURN_NULL)                      \
-	{                                                                                                         \
-		bool success = true;                                                                              \
-                                                                                                                  \
-		SUBSUSED = 0;                                                                                     \
-		SUBSARRAY_YDB = NULL;                                                                             \
-		if (Py_None != SUBSARRAY_PY) {                                                                    \
-			SUBSUSED = PySequence_Length(SUBSARRAY_PY);                                               \
-			SUBSARRAY_YDB = malloc(SUBSUSED * sizeof(ydb_buffer_t));                                  \
-			success = convert_py_sequence_to_ydb_buffer_array(SUBSARRAY_PY, SUBSUSED, SUBSARRAY_YDB); \
-			if (!success) {                                                                           \
-				FREE_BUFFER_ARRAY(SUBSARRAY_YDB, SUBSUSED);                                       \
-				RETURN_NULL = true;                                                               \
-			}                                                                                         \
-		}                                                                                                 \
-	}
-
-#define FREE_BUFFER_ARRAY(ARRAY, LEN)                                         \
-	{                                                                     \
-		if (NULL != ARRAY) {                                          \
-			for (int i = 0; i < (LEN); i++) {                     \
-				YDB_FREE_BUFFER(&((ydb_buffer_t *)ARRAY)[i]); \
-			}                                                     \
-			free(ARRAY);                                          \
-		}                                                             \
-	}
-
 #define FREE_STRING_ARRAY(ARRAY, LEN)                              \
 	{                                                          \
 		if (NULL != ARRAY) {                               \
@@ -166,45 +495,44 @@ typedef struct {
 		}                                                        \
 	}
 
-#define FIX_BUFFER_LENGTH(BUFFER)                           \
-	{                                                   \
-		int correct_length = BUFFER.len_used;       \
-                                                            \
-		YDB_FREE_BUFFER(&BUFFER);                   \
-		YDB_MALLOC_BUFFER(&BUFFER, correct_length); \
-	}
-
 #define RAISE_SPECIFIC_ERROR(ERROR_TYPE, MESSAGE)     \
 	{                                             \
 		assert(NULL != MESSAGE);              \
 		PyErr_SetObject(ERROR_TYPE, MESSAGE); \
 	}
 
-/* Allocate and populate a ydb_buffer_t struct from a Python AnyStr (`str` or `bytes`)
- * object and return on failure.
- */
-#define INVOKE_ANYSTR_TO_BUFFER(ANYSTR, BUFFER, IS_VARNAME)               \
-	{                                                                 \
-		int status;                                               \
-                                                                          \
-		status = anystr_to_buffer(ANYSTR, &(BUFFER), IS_VARNAME); \
-		if (YDB_OK != status) {                                   \
-			return NULL;                                      \
-		}                                                         \
+/* Release the references held on the Python bytes objects backing an array of borrowed buffers,
+ * as populated by anystr_to_borrowed_buffer() or borrow_py_sequence_as_buffer_array().
+ */
+#define RELEASE_BUFFER_OWNERS(OWNERS, LEN)        \
+	{                                         \
+		for (int i = 0; i < (LEN); i++) { \
+			Py_XDECREF((OWNERS)[i]);  \
+		}                                 \
 	}
 
-/* Allocate and populate a ydb_buffer_t array representing a set of subscripts.
- * In case of failure, free the specified CLEANUP_BUF and return.
- */
-#define INVOKE_POPULATE_SUBS_USED_AND_SUBSARRAY_AND_CLEANUP_VARNAME(SUBSARRAY_PY, SUBS_USED, SUBSARRAY_YDB, CLEANUP_BUF) \
-	{                                                                                                                \
-		int status;                                                                                              \
-                                                                                                                         \
-		status = populate_subs_used_and_subsarray(SUBSARRAY_PY, &(SUBS_USED), &(SUBSARRAY_YDB));                 \
-		if (YDB_OK != status) {                                                                                  \
-			YDB_FREE_BUFFER(&(CLEANUP_BUF));                                                                 \
-			return NULL;                                                                                     \
-		}                                                                                                        \
+/* Point a ydb_buffer_t struct at the contents of a Python AnyStr (`str` or `bytes`)
+ * object and return on failure. OWNER must be released with Py_DECREF once the buffer
+ * is no longer needed.
+ */
+#define INVOKE_ANYSTR_TO_BORROWED_BUFFER(ANYSTR, BUFFER, IS_VARNAME, OWNER)                  \
+	{                                                                                    \
+		int status;                                                                  \
+                                                                                             \
+		status = anystr_to_borrowed_buffer(ANYSTR, &(BUFFER), IS_VARNAME, &(OWNER)); \
+		if (YDB_OK != status) {                                                      \
+			return NULL;                                                         \
+		}                                                                            \
+	}
+
+/* Populate a YDBKey from a Python varname and subsarray and return on failure.
+ * KEY must be released with free_YDBKey() once it is no longer needed.
+ */
+#define INVOKE_LOAD_YDBKEY(KEY, VARNAME_PY, SUBSARRAY_PY)             \
+	{                                                             \
+		if (!load_YDBKey(&(KEY), VARNAME_PY, SUBSARRAY_PY)) { \
+			return NULL;                                  \
+		}                                                     \
 	}
 
 /* PYTHON EXCEPTION DECLARATIONS */
@@ -2,7 +2,7 @@
 #                                                               #
 # Copyright (c) 2019-2021 Peter Goss All rights reserved.       #
 #                                                               #
-# Copyright (c) 2019-2025 YottaDB LLC and/or its subsidiaries.  #
+# Copyright (c) 2019-2026 YottaDB LLC and/or its subsidiaries.  #
 # All rights reserved.                                          #
 #                                                               #
 #   This source code contains the intellectual property         #
@@ -15,6 +15,9 @@ import pytest  # type: ignore # ignore due to pytest not having type annotations
 
 import multiprocessing
 import os
+import sys
+import threading
+import uuid
 import datetime
 import time
 from decimal import Decimal
@@ -82,6 +85,21 @@ def test_get(simple_data):
         assert _yottadb.YDB_ERR_LVUNDEF == e.code()
 
 
+def test_get_default(simple_data):
+    # A default is returned instead of raising YDBError when the node is undefined
+    assert _yottadb.get("^testerror", default=None) is None
+    assert _yottadb.get("^testerror", ["sub1"], b"default") == b"default"
+    assert _yottadb.get(b"testerror", [b"sub1"], default=0) == 0
+    assert _yottadb.get(varname="testerror", subsarray=None, default="default") == "default"
+
+    # A default has no effect on defined nodes or on other errors
+    assert _yottadb.get("^test1", default=None) == b"test1value"
+    assert _yottadb.get("^test3", ["sub1", "sub2"], default=None) == b"test3value3"
+    with pytest.raises(YDBError) as e:
+        _yottadb.get("1invalid", default=None)
+    assert _yottadb.YDB_ERR_INVVARNAME == e.value.code()
+
+
 def test_set():
     # Positional arguments
     _yottadb.set("test4", value="test4value")
@@ -114,6 +132,72 @@ def test_set():
     assert _yottadb.get(b"testchinese") == bytes("你好世界", encoding="utf-8")
 
 
+def test_argument_references_released():
+    # Buffers passed to YottaDB point directly into the bytes objects passed from Python,
+    # so make sure the references held on them are released once each call completes.
+    varname = b"testrefs"
+    subsarray = (b"sub1", b"sub2")
+    value = b"testrefsvalue"
+    refcounts = [sys.getrefcount(obj) for obj in (varname, *subsarray, value)]
+
+    _yottadb.set(varname, subsarray, value)
+    assert _yottadb.get(varname, subsarray) == value
+    assert _yottadb.data(varname, subsarray) == 1
+    assert _yottadb.node_next(varname) == subsarray
+    _yottadb.lock(keys=((varname, subsarray),))
+    _yottadb.lock()
+    # Failure partway through the subscripts
+    with pytest.raises(TypeError):
+        _yottadb.get(varname, (subsarray[0], 1))
+    with pytest.raises(ValueError):
+        _yottadb.set(varname, subsarray, b"a" * (_yottadb.YDB_MAX_STR + 1))
+    _yottadb.delete(varname, delete_type=_yottadb.YDB_DEL_TREE)
+
+    assert refcounts == [sys.getrefcount(obj) for obj in (varname, *subsarray, value)]
+
+
+def test_buffer_stats():
+    # A value longer than the reusable value buffer costs at most one retry, after which the buffer fits it
+    value = b"v" * 1000
+    _yottadb.set("testbuffer", value=value)
+    _yottadb.buffer_stats(reset=True)
+    assert _yottadb.get("testbuffer") == value
+    stats = _yottadb.buffer_stats()
+    assert stats["value_buffer_len"] >= len(value)
+    assert stats["invstrlen_retries"] <= 1
+    for _ in range(10):
+        assert _yottadb.get("testbuffer") == value
+    assert _yottadb.buffer_stats(reset=True)["invstrlen_retries"] == stats["invstrlen_retries"]
+    assert _yottadb.buffer_stats()["invstrlen_retries"] == 0
+    _yottadb.delete("testbuffer")
+
+    # Each thread has its own value buffer, which is only allocated when first used
+    thread_stats = []
+    thread = threading.Thread(target=lambda: thread_stats.append(_yottadb.buffer_stats()))
+    thread.start()
+    thread.join()
+    assert thread_stats[0]["value_buffer_len"] == 0
+
+
+def test_node_next_buffer_reuse():
+    # Subscripts longer than the reusable subscript buffers cost a retry only the first time they are received
+    subsarrays = [tuple(str(uuid.UUID(int=level * 10 + i)).encode() for level in range(6)) for i in range(3)]
+    for subsarray in subsarrays:
+        _yottadb.set("testnodes", subsarray, "value")
+    _yottadb.buffer_stats(reset=True)
+    assert _yottadb.node_next("testnodes") == subsarrays[0]
+    assert _yottadb.buffer_stats(reset=True)["invstrlen_retries"] <= len(subsarrays[0])
+
+    # Once the buffers have grown to fit, traversal makes a single call per node
+    assert _yottadb.node_next("testnodes", subsarrays[0]) == subsarrays[1]
+    assert _yottadb.node_next("testnodes", subsarrays[1]) == subsarrays[2]
+    assert _yottadb.node_next("testnodes", subsarrays[2], None) is None
+    assert _yottadb.node_previous("testnodes", subsarrays[2]) == subsarrays[1]
+    assert _yottadb.buffer_stats()["invstrlen_retries"] == 0
+    assert _yottadb.scan("testnodes") == ([(subsarray, b"value") for subsarray in subsarrays], None)
+    _yottadb.delete("testnodes", delete_type=_yottadb.YDB_DEL_TREE)
+
+
 def test_delete():
     # Positional arguments
     _yottadb.set(varname="test8", value="test8value")
@@ -893,6 +977,21 @@ def test_node_previous_long_subscripts():
     assert _yottadb.node_previous("testlong", ("a" * 1025, "a" * 1026, "a")) == (b"a" * 1025, b"a" * 1026)
 
 
+def test_traversal_default(simple_data):
+    # A default is returned instead of raising YDBNodeEnd when there is no next or previous node
+    assert _yottadb.subscript_next("^test4", ("sub3",), None) is None
+    assert _yottadb.subscript_next("^test4", ("sub1",), default=b"end") == b"sub2"
+    assert _yottadb.subscript_previous(varname="^test4", subsarray=("sub1",), default=b"end") == b"end"
+    assert _yottadb.node_next("^test3", ("sub1", "sub2"), None) is None
+    assert _yottadb.node_next("^test3", default=None) == (b"sub1",)
+    assert _yottadb.node_previous("^test3", default=()) == ()
+    # Errors other than YDBNodeEnd are still raised when a default is given
+    with pytest.raises(_yottadb.YDBError):
+        _yottadb.subscript_next("1invalid", default=None)
+    with pytest.raises(_yottadb.YDBError):
+        _yottadb.node_next("1invalid", default=None)
+
+
 def test_lock_blocking_other(simple_data):
     t1 = ("^test1", ())
     t2 = ("^test2", ("sub1",))
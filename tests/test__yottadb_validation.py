@@ -704,7 +704,12 @@ def test_unsigned_int_length_bytes_overflow():
 def test_validation_exception_message(simple_data):
     t1 = yottadb.Key("^test1")
     t2 = yottadb.Key("^test2")["sub1"]
-    t3 = yottadb.Key("^test3")["sub1"]["b" * (_yottadb.YDB_MAX_STR + 1)]
+    # A Key encodes its subscripts when it is created, so an overlong subscript is reported right away
+    with pytest.raises(ValueError) as e:
+        yottadb.Key("^test3")["sub1"]["b" * (_yottadb.YDB_MAX_STR + 1)]
+    assert str(e.value) == "invalid bytes length 1048577: max 1048576"
+
+    t3 = ("^test3", ("sub1", "b" * (_yottadb.YDB_MAX_STR + 1)))
     keys_to_lock = (t1, t2, t3)
     with pytest.raises(ValueError):
         yottadb.lock(keys_to_lock)
@@ -2,7 +2,7 @@
 #                                                               #
 # Copyright (c) 2019-2021 Peter Goss All rights reserved.       #
 #                                                               #
-# Copyright (c) 2019-2024 YottaDB LLC and/or its subsidiaries.  #
+# Copyright (c) 2019-2026 YottaDB LLC and/or its subsidiaries.  #
 # All rights reserved.                                          #
 #                                                               #
 #   This source code contains the intellectual property         #
@@ -206,6 +206,380 @@ def test_release():
     assert re.match("pywr.*", release) is not None
 
 
+def test_get_default(simple_data):
+    assert yottadb.get("^test1") == b"test1value"
+    assert yottadb.get("^testerror") is None
+    assert yottadb.get("testerror", ("sub1",)) is None
+    assert yottadb.get("testerror", ("sub1",), default=b"default") == b"default"
+    with pytest.raises(yottadb.YDBError):
+        yottadb.get("1invalid", default=b"default")
+
+
+def test_get_set_data_many(simple_data):
+    keys = [("^test1",), ("^test3", ("sub1", "sub2")), yottadb.Key("^test2")["sub1"], ("^testerror", ("sub1",))]
+    assert yottadb.get_many(keys) == [b"test1value", b"test3value3", b"test2value", None]
+    assert yottadb.get_many(keys, default=b"default")[-1] == b"default"
+    assert yottadb.get_many([]) == []
+    assert yottadb.data_many(keys) == [1, 1, 1, 0]
+
+    yottadb.set_many([(("testmany", ("sub1",)), "value1"), (yottadb.Key("testmany")["sub2"], b"value2")])
+    yottadb.set_many({("testmany",): "value0", ("testmany", ("sub3",)): None})
+    assert yottadb.get_many(yottadb.Key("testmany")[sub] for sub in ("sub1", "sub2", "sub3")) == [b"value1", b"value2", b""]
+    assert yottadb.data_many([("testmany",)]) == [11]
+
+    with pytest.raises(TypeError) as terr:
+        yottadb.get_many([("^test1",), "^test1"])
+    assert re.match("'keys' argument invalid: item 1 is not a Key, list or tuple.", str(terr.value))
+    with pytest.raises(TypeError) as terr:
+        yottadb.set_many([("^test1",)])
+    assert re.match("'pairs' argument invalid: item 0 is not a [(]key, value[)] pair.", str(terr.value))
+    with pytest.raises(yottadb.YDBError):
+        yottadb.get_many([("^test1",), ("1invalid",)])
+
+
+def test_incr_many(new_db):
+    words = "the quick fox and the lazy dog and the cat".split()
+    assert yottadb.incr_many("^words", (word.encode() for word in words)) is None
+    assert yottadb.get("^words", (b"the",)) == b"3"
+    assert yottadb.get("^words", (b"and",)) == b"2"
+    assert yottadb.get("^words", (b"fox",)) == b"1"
+
+    values = yottadb.incr_many("^words", [("the",), ["dog"], (("fox",), 10), (("cat",), b"-1.5")], 2, return_values=True)
+    assert values == [b"5", b"3", b"11", b"-.5"]
+    assert yottadb.incr_many("words", [(), ("sub1", "sub2")], return_values=True, in_tp=True) == [b"1", b"1"]
+
+    # A failing increment in a transaction rolls back those before it
+    with pytest.raises(TypeError):
+        yottadb.incr_many("^words", [("the",), (("the",), None)], in_tp=True)
+    assert yottadb.get("^words", (b"the",)) == b"5"
+    with pytest.raises(TypeError):
+        yottadb.incr_many("^words", ["the"], increment=[1])
+    yottadb.delete_tree("^words")
+
+
+def test_scan(simple_data):
+    nodes, start = yottadb.scan("^test4", limit=5)
+    assert nodes == [
+        ((), b"test4"),
+        ((b"sub1",), b"test4sub1"),
+        ((b"sub1", b"subsub1"), b"test4sub1subsub1"),
+        ((b"sub1", b"subsub2"), b"test4sub1subsub2"),
+        ((b"sub1", b"subsub3"), b"test4sub1subsub3"),
+    ]
+    assert start == (b"sub1", b"subsub3")
+    nodes, start = yottadb.scan("^test4", start=start)
+    assert len(nodes) == 8
+    assert nodes[-1] == ((b"sub3", b"subsub3"), b"test4sub3subsub3")
+    assert start is None
+
+    # Only the subtree at the given subscripts is scanned
+    nodes, start = yottadb.scan("^test4", ("sub2",), limit=4)
+    assert [subs for subs, value in nodes] == [(b"sub2",), (b"sub2", b"subsub1"), (b"sub2", b"subsub2"), (b"sub2", b"subsub3")]
+    assert yottadb.scan("^test4", ("sub2",), limit=4, start=start) == ([], None)
+    assert yottadb.scan("^test6") == ([((b"sub6", b"subsub6"), b"test6value")], None)
+    assert yottadb.scan("^test6", ("sub6", "nonexistent")) == ([], None)
+    with pytest.raises(ValueError):
+        yottadb.scan("^test4", limit=0)
+
+    # A scan ends before the node given by `stop` and its descendants
+    nodes, start = yottadb.scan("^test4", start=("sub1", "subsub3"), stop=("sub3",))
+    assert [subs for subs, value in nodes] == [(b"sub2",), (b"sub2", b"subsub1"), (b"sub2", b"subsub2"), (b"sub2", b"subsub3")]
+    assert start is None
+    # The stop node need not exist: the scan ends before the first node past it
+    nodes, start = yottadb.scan("^test4", start=("sub1", "subsub3"), stop=("sub2a",))
+    assert nodes[-1][0] == (b"sub2", b"subsub3")
+    assert start is None
+    nodes, start = yottadb.scan("^test4", stop=("sub1", "subsub1a"))
+    assert [subs for subs, value in nodes] == [(), (b"sub1",), (b"sub1", b"subsub1")]
+
+
+def test_scan_range(new_db):
+    for i in range(1, 21):
+        yottadb.set("^range", ("idx", str(i)), f"value{i}")
+    yottadb.set("^range", ("idx", "a", "sub"), "")
+    yottadb.set("^range", ("idx", "b"), "b")
+
+    # Subscripts are returned in collation order, with numbers before strings
+    page, token = yottadb.scan_range("^range", ("idx",), start="5", stop="12")
+    assert page == [(str(i).encode(), f"value{i}".encode()) for i in range(5, 12)]
+    assert token is None
+    # The bounds need not exist
+    page, token = yottadb.scan_range("^range", ("idx",), start="4.5", stop="6.5")
+    assert [subscript for subscript, value in page] == [b"5", b"6"]
+    page, token = yottadb.scan_range("^range", ("idx",), start="19")
+    assert page == [(b"19", b"value19"), (b"20", b"value20"), (b"a", None), (b"b", b"b")]
+    page, token = yottadb.scan_range("^range", ("idx",), start="8", stop="5", reverse=True)
+    assert [subscript for subscript, value in page] == [b"8", b"7", b"6"]
+
+    # Pages resume after the continuation token
+    subscripts = []
+    token = None
+    while True:
+        page, token = yottadb.scan_range("^range", ("idx",), stop="a", limit=3, token=token)
+        subscripts.extend(subscript for subscript, value in page)
+        if token is None:
+            break
+        assert token == page[-1][0]
+    assert subscripts == [str(i).encode() for i in range(1, 21)]
+    page, token = yottadb.scan_range("^range", ("idx",), limit=2, reverse=True)
+    assert (page, token) == ([(b"b", b"b"), (b"a", None)], b"a")
+    assert yottadb.scan_range("^range", ("idx",), limit=2, reverse=True, token=token)[0][0] == (b"20", b"value20")
+    assert yottadb.scan_range("^range", ("none",)) == ([], None)
+    with pytest.raises(ValueError):
+        yottadb.scan_range("^range", limit=0)
+    yottadb.delete_tree("^range")
+
+
+def test_merge(new_db):
+    yottadb.set("cart", (), "root")
+    for i in range(1, 11):
+        yottadb.set("cart", ("items", str(i)), f"item{i}")
+    yottadb.set("cart", ("items", "5", "notes"), "fragile")
+    yottadb.set("cart", ("total",), "10")
+    yottadb.set("^carts", ("user1", "stale"), "kept")
+
+    # Subscripts of the source root are replaced by those of the destination, and other nodes are kept
+    assert yottadb.merge(("cart", ()), ("^carts", ("user1",))) == 13
+    assert yottadb.get("^carts", ("user1",)) == b"root"
+    assert yottadb.get("^carts", ("user1", "items", "5", "notes")) == b"fragile"
+    assert yottadb.get("^carts", ("user1", "stale")) == b"kept"
+
+    # Chunked transactions copy the same nodes as a single one
+    assert yottadb.merge(yottadb.Key("^carts")["user1"]["items"], ("^carts", ("user2", "items")), True, "MERGE", 3) == 11
+    assert yottadb.merge(("^carts", ("user1", "items")), ("^carts", ("user3", "items")), in_tp=True) == 11
+    nodes = [(subs[1:], value) for subs, value in yottadb.scan("^carts", ("user1", "items"))[0]]
+    assert [(subs[1:], value) for subs, value in yottadb.scan("^carts", ("user2", "items"))[0]] == nodes
+    assert [(subs[1:], value) for subs, value in yottadb.scan("^carts", ("user3", "items"))[0]] == nodes
+
+    # Merging a node into itself does nothing, and into its own subtree is an error
+    assert yottadb.merge(("^carts", ("user1",)), ("^carts", ("user1",))) == 0
+    with pytest.raises(ValueError):
+        yottadb.merge(("^carts", ("user1",)), ("^carts", ("user1", "copy")))
+    with pytest.raises(ValueError):
+        yottadb.merge(("^carts", ("user1", "items")), ("^carts", ()))
+    assert yottadb.merge(("^nosuchvar", ()), ("^carts", ("user4",))) == 0
+    assert yottadb.data("^carts", ("user4",)) == 0
+    yottadb.delete_tree("^carts")
+    yottadb.delete_tree("cart")
+
+
+def test_export_zwr(new_db, tmp_path):
+    yottadb.set("^export", (), "root")
+    yottadb.set("^export", ("a", "1"), "value")
+    yottadb.set("^export", ("a", "2"), 'say "hi"')
+    yottadb.set("^export", ("a", "10"), "42")
+    yottadb.set("^export", ("b\x01",), "tab\tend")
+    yottadb.set("^exportz", (), "not exported")
+    expected = [
+        '^export="root"',
+        '^export("a",1)="value"',
+        '^export("a",2)="say ""hi"""',
+        '^export("a",10)=42',
+        '^export("b"_$C(1))="tab"_$C(9)_"end"',
+    ]
+
+    # A small buffer is written out several times, with the same result
+    path = tmp_path / "export.zwr"
+    with open(path, "w") as f:
+        f.write("header\n")
+        assert yottadb.export_zwr("^export", (), f, chunk_size=7) == 5
+    assert path.read_text().splitlines() == ["header"] + expected
+
+    fd = os.open(tmp_path / "subtree.zwr", os.O_WRONLY | os.O_CREAT)
+    try:
+        assert yottadb.export_zwr("^export", ("a",), fd) == 3
+        assert yottadb.export_zwr("^export", ("none",), fd) == 0
+    finally:
+        os.close(fd)
+    assert (tmp_path / "subtree.zwr").read_text().splitlines() == expected[1:4]
+
+    with pytest.raises(ValueError):
+        yottadb.export_zwr("^export", (), 1, chunk_size=0)
+    yottadb.delete_tree("^export")
+    yottadb.delete_tree("^exportz")
+
+
+def test_import_zwr(new_db, tmp_path):
+    path = tmp_path / "import.zwr"
+    lines = [
+        "YottaDB MUPIP EXTRACT",
+        "16-OCT-2026 10:00:00 ZWR",
+        '^import="root"',
+        '^import("a",1)="value"',
+        '^import("a",2)="say ""hi"", (twice)"',
+        "",
+        '^import("a",10)=42',
+        '^import("b"_$C(1),"c,d")="tab"_$C(9)_"end"',
+        'local("x")=""',
+    ]
+    path.write_text("\r\n".join(lines))
+    with open(path) as f:
+        assert yottadb.import_zwr(f, batch=2) == 6
+    assert yottadb.get("^import") == b"root"
+    assert yottadb.get("^import", ("a", "2")) == b'say "hi", (twice)'
+    assert yottadb.get("^import", ("a", "10")) == b"42"
+    assert yottadb.get("^import", ("b\x01", "c,d")) == b"tab\tend"
+    assert yottadb.get("local", ("x",)) == b""
+
+    # A round trip through export_zwr() gives back the same nodes
+    with open(path, "w") as f:
+        yottadb.export_zwr("^import", (), f)
+    yottadb.delete_tree("^import")
+    fd = os.open(path, os.O_RDONLY)
+    try:
+        assert yottadb.import_zwr(fd, batch=0) == 5
+    finally:
+        os.close(fd)
+    assert yottadb.get("^import", ("b\x01", "c,d")) == b"tab\tend"
+
+    # Batches before an invalid line are kept, while its own is rolled back
+    yottadb.delete_tree("^import")
+    path.write_text('^import(1)=1\n^import(2)=2\n^import(3)=3\n^import(4=4\n')
+    with open(path) as f:
+        with pytest.raises(ValueError, match="line 4"):
+            yottadb.import_zwr(f, batch=2)
+    assert [subs for subs, value in yottadb.scan("^import")[0]] == [(b"1",), (b"2",)]
+    yottadb.delete_tree("^import")
+
+
+def test_parallel_scan(simple_data):
+    nodes, start = yottadb.scan("^test4")
+    for workers in (1, 2, 3, 8):
+        chunks = list(yottadb.parallel_scan("^test4", workers=workers, limit=2))
+        assert sorted(node for chunk in chunks for node in chunk) == sorted(nodes)
+        assert all(len(chunk) <= 2 for chunk in chunks)
+    assert sum(yottadb.parallel_scan("^test4", ("sub2",), workers=2, fn=len)) == 4
+    assert list(yottadb.parallel_scan("^nonexistent", workers=2)) == []
+
+    # Boundaries are sampled from numeric and string subscripts alike, and the ranges cover each node once
+    for i in range(-50, 50):
+        yottadb.set("^parallel", (str(i),), str(i))
+        yottadb.set("^parallel", (f"key{i:03}", "sub"), str(i))
+    yottadb.set("^parallel", ("1.5",), "1.5")
+    boundaries = yottadb._sample_boundaries("^parallel", (), 3)
+    assert len(boundaries) == 3
+    assert len(set(boundaries)) == 3
+    nodes, start = yottadb.scan("^parallel", limit=1000)
+    for workers in (2, 4, 8):
+        chunks = list(yottadb.parallel_scan("^parallel", workers=workers, limit=7))
+        assert sorted(node for chunk in chunks for node in chunk) == sorted(nodes)
+    yottadb.delete_tree("^parallel")
+
+    # Numbers with more than 18 significant digits are collated as strings
+    for digit in "123456789":
+        yottadb.set("^parallel", (digit * 19,), digit)
+    for letter in "abcdefghijklmnopqrstuvwxyz":
+        yottadb.set("^parallel", (letter,), letter)
+    subscripts = list(yottadb.subscripts("^parallel", ("",)))
+    for count in (3, 7, 15):
+        indexes = [subscripts.index(boundary) for boundary in yottadb._sample_boundaries("^parallel", (), count)]
+        assert indexes == sorted(indexes) and len(indexes) == len(set(indexes))
+    nodes, start = yottadb.scan("^parallel", limit=1000)
+    chunks = list(yottadb.parallel_scan("^parallel", workers=4, limit=7))
+    assert sorted(node for chunk in chunks for node in chunk) == sorted(nodes)
+    yottadb.delete_tree("^parallel")
+    with pytest.raises(YDBError):
+        list(yottadb.parallel_scan("^test4", workers=2, fn=lambda chunk: yottadb.get("1invalid")))
+    with pytest.raises(SystemExit):
+        list(yottadb.parallel_scan("^test4", workers=2, fn=lambda chunk: sys.exit(3)))
+    with pytest.raises(RuntimeError):
+        list(yottadb.parallel_scan("^test4", workers=2, fn=lambda chunk: os._exit(3)))
+    with pytest.raises(ValueError):
+        list(yottadb.parallel_scan("^test4", workers=0))
+
+
+# The threaded API can only be used by a process that has not yet called YottaDB, so run the threads in a new one
+THREADED_SCRIPT = """
+import threading
+import yottadb
+
+yottadb.enable_threads()
+
+def count(num):
+    yottadb.incr("^threads", (str(num), "count"))
+    return yottadb.YDB_OK
+
+def transfer(num):
+    yottadb.incr("^threads", ("total",), -1)
+    # A nested transaction takes part in the one of the same thread
+    return yottadb.tp(count, args=(num,))
+
+def work(num):
+    for i in range(100):
+        yottadb.incr("^threads", ("total",))
+        yottadb.set("^threads", (str(num), str(i)), str(i * num))
+        yottadb.lock_incr("^threads", (str(num),))
+        yottadb.lock_decr("^threads", (str(num),))
+        if i % 2:
+            yottadb.tp(transfer, args=(num,))
+
+threads = [threading.Thread(target=work, args=(num,)) for num in range(4)]
+for thread in threads:
+    thread.start()
+for thread in threads:
+    thread.join()
+print(yottadb.get("^threads", ("total",)).decode(), yottadb.get("^threads", ("3", "99")).decode())
+try:
+    yottadb.get("1invalid")
+except yottadb.YDBError as e:
+    print(e.code() == yottadb.YDB_ERR_INVVARNAME, "INVVARNAME" in str(e))
+print(yottadb.get("^threads", ("2", "count")).decode())
+try:
+    yottadb.tp(lambda: yottadb.get("1invalid"))
+except yottadb.YDBError as e:
+    print(e.code() == yottadb.YDB_ERR_INVVARNAME)
+"""
+
+
+def test_enable_threads(new_db):
+    # Too late for this process, which has already used the Simple API
+    yottadb.delete_tree("^threads")
+    with pytest.raises(yottadb.YDBPythonError):
+        yottadb.enable_threads()
+
+    stdout, stderr = execute(sys.executable + " -c '" + THREADED_SCRIPT + "'")
+    assert stderr == ""
+    assert stdout.split("\n") == ["200 297", "True True", "50", "True"]
+    yottadb.delete_tree("^threads")
+
+
+AIO_SCRIPT = """
+import asyncio
+import yottadb
+import yottadb.aio
+
+async def main():
+    # Calls issued by concurrent coroutines are made in batches by the worker thread
+    await asyncio.gather(*(yottadb.aio.set("^aio", (str(i),), str(i)) for i in range(10)))
+    values = await asyncio.gather(*(yottadb.aio.get("^aio", (str(i),)) for i in range(10)))
+    print(values == [str(i).encode() for i in range(10)])
+    print(await yottadb.aio.incr("^aio", ("count",), 5), await yottadb.aio.data("^aio"))
+    print(await yottadb.aio.get("^aio", ("undefined",), b"default"))
+    nodes, start = await yottadb.aio.scan("^aio", limit=3)
+    print(nodes == [((b"0",), b"0"), ((b"1",), b"1"), ((b"2",), b"2")])
+    # An error only fails the call that caused it
+    results = await asyncio.gather(yottadb.aio.get("1invalid"), yottadb.aio.get("^aio", ("1",)), return_exceptions=True)
+    print(isinstance(results[0], yottadb.YDBError), results[1])
+
+for i in range(2):  # The worker thread serves any event loop
+    asyncio.run(main())
+    yottadb.delete_tree("^aio")
+"""
+
+
+def test_aio(new_db):
+    import asyncio
+    import yottadb.aio
+
+    # The worker thread needs the threaded API, which this process can no longer switch to
+    with pytest.raises(yottadb.YDBPythonError):
+        asyncio.run(yottadb.aio.get("^aio"))
+
+    stdout, stderr = execute(sys.executable + " -c '" + AIO_SCRIPT + "'")
+    assert stderr == ""
+    assert stdout.split("\n") == ["True", "b'5' 10", "b'default'", "True", "True b'1'"] * 2
+
+
 def test_Key_object(simple_data):
     # Key creation, varname only
     key = yottadb.Key("^test1")
@@ -369,6 +743,28 @@ def test_Key_subsarray(simple_data):
         pass
 
 
+def test_Key_hashable(simple_data):
+    key = yottadb.Key("^test3")["sub1"]["sub2"]
+    # Keys created from a subsarray and through a parent represent the same node
+    assert key == yottadb.Key("^test3", subsarray=["sub1", "sub2"])
+    assert hash(key) == hash(yottadb.Key("^test3", subsarray=("sub1", "sub2")))
+    assert key.parent == yottadb.Key("^test3", subsarray=["sub1"])["sub2"].parent
+    assert key.subsarray_keys == [yottadb.Key("^test3")["sub1"], key]
+    assert key.value == yottadb.Key("^test3", subsarray=["sub1", "sub2"]).value
+
+    nodes = {key: "a", yottadb.Key("^test3")["sub1"]: "b"}
+    assert nodes[yottadb.Key("^test3", subsarray=["sub1", "sub2"])] == "a"
+    assert nodes[yottadb.Key("^test3")["sub1"]] == "b"
+    assert len({yottadb.Key("^test3"), yottadb.Key("^test3"), yottadb.Key(b"^test3")}) == 2
+
+    # The node a Key represents cannot be changed
+    with pytest.raises(AttributeError):
+        key.name = "sub3"
+    with pytest.raises(AttributeError):
+        key.extra = "attribute"
+    assert key.subsarray == ["sub1", "sub2"]
+
+
 def test_Key_varname(simple_data):
     assert yottadb.Key("^test3").varname == "^test3"
     assert yottadb.Key("^test3")["sub1"].varname == "^test3"
@@ -909,6 +1305,139 @@ def test_module_zwr2str(input, output1, output2):
     assert yottadb.zwr2str(input) == output1
 
 
+def test_module_str2zwr_many():
+    # Converting many strings at once gives the same results as one at a time, including results longer than
+    # any before them
+    inputs = [input for input, output1, output2 in str2zwr_tests] + [b"\x01" * 1000, "", "plain"]
+    zwr = yottadb.str2zwr_many(inputs)
+    assert zwr == [yottadb.str2zwr(input) for input in inputs]
+    assert yottadb.zwr2str_many(zwr) == [yottadb.zwr2str(output) for output in zwr]
+    assert yottadb.zwr2str_many(iter(zwr[-2:])) == [b"", b"plain"]
+    assert yottadb.str2zwr_many(()) == []
+    with pytest.raises(TypeError):
+        yottadb.str2zwr_many(["ok", 1])
+
+    key = yottadb.Key("^test")["sub1"][b"\xff"]["1"]
+    assert str(key) == '^test("sub1",$C(255),1)'
+    assert repr(key) == "Key(\"^test\")['sub1'][b'\\xff']['1']"
+    assert eval(repr(key), {"Key": yottadb.Key}) == key
+
+
+def test_stats(new_db):
+    yottadb.stats(reset=True)
+    yottadb.enable_stats()
+    try:
+        yottadb.set("^test", ("stats",), "value")
+        assert yottadb.get("^test", ("stats",)) == b"value"
+        assert yottadb.get("^test", ("missing",)) is None
+        yottadb.tp(lambda: yottadb.set("^test", ("tp",), "1") or yottadb.YDB_OK)
+    finally:
+        yottadb.enable_stats(False)
+    # Calls made while disabled are not counted
+    yottadb.get("^test", ("stats",))
+
+    stats = yottadb.stats(reset=True)
+    assert set(stats) == {"get", "set", "tp"}
+    assert stats["get"]["calls"] == 2
+    assert stats["get"]["errors"] == 1
+    assert stats["get"]["statuses"] == {yottadb._yottadb.YDB_ERR_GVUNDEF: 1}
+    assert stats["get"]["bytes_out"] == len(b"value")
+    assert stats["set"]["calls"] == 2
+    assert stats["set"]["bytes_in"] == len(b"value") + len(b"1")
+    assert stats["tp"]["calls"] == 1
+    assert stats["tp"]["errors"] == 0
+    for op_stats in stats.values():
+        assert sum(count for start, end, count in op_stats["latency"]) == op_stats["calls"]
+        assert all(start < end for start, end, count in op_stats["latency"])
+        assert op_stats["total_ns"] >= sum(start * count for start, end, count in op_stats["latency"])
+    assert yottadb.stats() == {}
+
+
+def test_trace(new_db):
+    yottadb.drain_trace()
+    # Record every call
+    yottadb.enable_trace(threshold_ns=0, size=4)
+    try:
+        yottadb.set("^test", ("trace", "1"), "value")
+        assert yottadb.get("^test", ("missing", "x" * 200)) is None
+        yottadb.tp(lambda: yottadb.YDB_OK)
+    finally:
+        yottadb.enable_trace(enable=False)
+    yottadb.get("^test", ("trace", "1"))
+
+    calls, dropped = yottadb.drain_trace()
+    assert dropped == 0
+    assert [call["op"] for call in calls] == ["set", "get", "tp"]
+    assert calls[0]["varname"] == "^test"
+    assert calls[0]["subs"] == '"trace",1'
+    assert calls[0]["status"] == yottadb._yottadb.YDB_OK
+    assert calls[1]["subs"] == '"missing","' + "x" * (128 - len("missing")) + '",...'
+    assert calls[1]["status"] == yottadb._yottadb.YDB_ERR_GVUNDEF
+    assert calls[2]["varname"] == calls[2]["subs"] == ""
+    assert all(call["duration_ns"] >= 0 and call["time_ns"] > 0 for call in calls)
+    assert yottadb.drain_trace() == ([], 0)
+
+    # Once the ring buffer is full, the oldest calls are overwritten
+    yottadb.enable_trace(threshold_ns=0, size=2)
+    try:
+        for i in range(5):
+            yottadb.set("^test", (str(i),), "value")
+    finally:
+        yottadb.enable_trace(enable=False)
+    calls, dropped = yottadb.drain_trace()
+    assert [call["subs"] for call in calls] == ["3", "4"]
+    assert dropped == 3
+
+    # Draining makes no traced calls of its own, even while tracing is enabled
+    yottadb.enable_trace(threshold_ns=0, size=4)
+    try:
+        yottadb.get("^test", ("trace", "1"))
+        calls, dropped = yottadb.drain_trace()
+        assert [(call["op"], call["subs"]) for call in calls] == [("get", '"trace",1')]
+        assert yottadb.drain_trace() == ([], 0)
+    finally:
+        yottadb.enable_trace(enable=False)
+    with pytest.raises(ValueError):
+        yottadb.enable_trace(size=0)
+
+
+def test_tp_stats(new_db):
+    attempts = []
+
+    def callback(restarts: int) -> int:
+        attempts.append(1)
+        yottadb.set("^test", ("tp",), str(len(attempts)))
+        if len(attempts) <= restarts:
+            raise yottadb.YDBTPRestart
+        return yottadb.YDB_OK
+
+    def rollback() -> int:
+        return yottadb._yottadb.YDB_TP_ROLLBACK
+
+    yottadb.tp_stats(reset=True)
+    yottadb.enable_stats()
+    try:
+        assert yottadb.tp(callback, args=(2,), transid="T1", return_restarts=True) == (yottadb.YDB_OK, 2)
+        attempts.clear()
+        assert yottadb.tp(callback, args=(0,), transid="T1") == yottadb.YDB_OK
+        with pytest.raises(yottadb.YDBTPRollback):
+            yottadb.tp(rollback)
+    finally:
+        yottadb.enable_stats(False)
+    yottadb.stats(reset=True)
+
+    tp_stats = yottadb.tp_stats(reset=True)
+    assert set(tp_stats) == {"T1", ""}
+    assert tp_stats["T1"]["attempts"] == 4
+    assert tp_stats["T1"]["restarts"] == 2
+    assert tp_stats["T1"]["commits"] == 2
+    assert tp_stats["T1"]["rollbacks"] == tp_stats["T1"]["errors"] == 0
+    assert tp_stats["T1"]["callback_ns"] > 0
+    assert tp_stats[""]["rollbacks"] == 1
+    assert tp_stats[""]["commits"] == 0
+    assert yottadb.tp_stats() == {}
+
+
 def test_module_node_next(simple_data):
     assert yottadb.node_next("^test3") == (b"sub1",)
     assert yottadb.node_next("^test3", subsarray=("sub1",)) == (b"sub1", b"sub2")
@@ -1531,6 +2060,43 @@ def test_Key_load_tree(simple_data):
     assert repr(test4_dict) == "{}"
 
 
+def test_load_tree(new_db):
+    tree = yottadb.Key("^tree")
+    tree.value = "root"
+    tree["10"].value = "ten"
+    tree["2"]["a"]["x"].value = "2ax"
+    tree["2"]["b"].value = ""
+    tree["abc"].value = "abc"
+    tree["abc"]["1"].value = "abc1"
+    yottadb.set("^treez", ("outside",), "not loaded")
+
+    # Nodes without a value still get a dictionary, and subscripts are in collation order
+    expected = {
+        "value": "root",
+        "2": {"a": {"x": {"value": "2ax"}}, "b": {"value": ""}},
+        "10": {"value": "ten"},
+        "abc": {"value": "abc", "1": {"value": "abc1"}},
+    }
+    loaded = tree.load_tree()
+    assert loaded == expected
+    assert list(loaded.keys()) == ["value", "2", "10", "abc"]
+    assert list(loaded["abc"].keys()) == ["value", "1"]
+    assert tree["2"].load_tree() == expected["2"]
+
+    # Without `first_call`, the value of the root is left out, and `child_subs` nests the subtree in `result`
+    del expected["value"]
+    assert yottadb.load_tree(tree) == expected
+    assert yottadb.load_tree(tree["2"], ["prefix"], {"other": {}}) == {"other": {}, "prefix": expected["2"]}
+    assert yottadb.Key("^treenone").load_tree() == {}
+
+    # Subscripts and values must be valid UTF-8
+    tree["bad"].value = b"\xff"
+    with pytest.raises(UnicodeDecodeError):
+        tree.load_tree()
+    tree.delete_tree()
+    yottadb.delete_tree("^treez")
+
+
 def test_Key_save_tree(simple_data):
     test4 = yottadb.Key("^test4")
     test4_dict = test4.load_tree()
@@ -1564,6 +2130,73 @@ def test_Key_save_tree(simple_data):
     assert test4_sub1["subsub3"].value == b"test4sub1subsub3"
 
 
+def test_replace_tree(new_db):
+    key = yottadb.Key("^replace")
+    tree = {"value": "root", "1": {"value": "one", "a": {"value": "1a"}}, "value2": {"value": None}}
+    key.save_tree(tree)
+    key["old"].value = "old"
+    assert key.load_tree() == {**tree, "value2": {"value": ""}, "old": {"value": "old"}}
+
+    # A "value" key holding a dictionary is a subscript like any other
+    key.replace_tree({"x": {"value": {"value": "x value"}}}, in_tp=True)
+    assert key.load_tree() == {"x": {"value": {"value": "x value"}}}
+    assert key["x"]["value"].value == b"x value"
+
+    # An invalid tree raises an exception, and with `in_tp` leaves the existing tree untouched
+    with pytest.raises(TypeError):
+        key.replace_tree({"y": {"value": "y"}, "z": "not a dict"}, in_tp=True)
+    assert key.load_tree() == {"x": {"value": {"value": "x value"}}}
+    with pytest.raises(TypeError):
+        yottadb.replace_tree({"y": {"value": "y"}, "z": "not a dict"}, key)
+    assert key.load_tree() == {"y": {"value": "y"}}
+    key.delete_tree()
+
+
+def test_save_json(new_db):
+    document = {
+        "name": "widget",
+        "count": 12,
+        "price": 1.5,
+        "zip": "02134",
+        "numeric_string": "12",
+        "flags": [True, False, None],
+        "empty": [],
+        "nested": [{"id": 1, "tags": ["a", "b"]}, {"id": 2, "tags": []}],
+        "matrix": [[1, 2], [3, 4, 5, 6, 7, 8, 9, 10, 11, 12]],
+    }
+    key = yottadb.Key("^json")["doc"]
+    key.save_json(document)
+    assert key["name"].value == b"widget"
+    assert key["name"]["\\s"].data == 1
+    assert key["count"].value == b"12"
+    assert key["count"].data == 1
+    assert key["empty"]["\\l"].data == 1
+    assert key["nested"]["2"]["tags"]["\\l"].data == 1
+    assert key.load_json() == document
+
+    # Raw JSON text is parsed before being stored
+    other = yottadb.Key("^json")["raw"]
+    other.save_json(json.dumps(document).encode())
+    assert other.load_json() == document
+    assert yottadb.Key("^json").load_json(key=key) == document
+
+    # Scalars may be stored at the root of the subtree
+    other.delete_tree()
+    other.save_json("text")
+    assert other.load_json() == "text"
+    other.delete_tree()
+    other.save_json(3.25)
+    assert other.load_json() == 3.25
+
+    # Subscripts of an array must be its indices
+    key["matrix"]["1"]["4"].value = "4"
+    with pytest.raises(ValueError):
+        key.load_json()
+    with pytest.raises(yottadb.YDBError):
+        yottadb.Key("^json")["missing"].load_json()
+    yottadb.delete_tree("^json")
+
+
 def test_deserialize_JSON(new_db):
     response = requests.get("https://rxnav.nlm.nih.gov/REST/relatedndc.json?relation=product&ndc=0069-3060")
     json_data = json.loads(response.content)
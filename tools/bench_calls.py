@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+#################################################################
+#                                                               #
+# Copyright (c) 2026 YottaDB LLC and/or its subsidiaries.       #
+# All rights reserved.                                          #
+#                                                               #
+#   This source code contains the intellectual property         #
+#   of its copyright holder(s), and is made available           #
+#   under a license.  If you do not know the terms of           #
+#   the license, please stop and do not read further.           #
+#                                                               #
+#################################################################
+"""
+Measure the per-call cost of the most frequently used _yottadb wrappers.
+
+Each operation is timed with both positional and keyword arguments, since the argument parsing
+path differs between the two. Results are reported in nanoseconds per call, alongside the cost of
+a call to a no-op Python function as a point of reference. To compare two builds of YDBPython, run
+this script against each build and compare the output, e.g.:
+
+    python3 tools/bench_calls.py --output before.txt
+    # rebuild with the change under test
+    python3 tools/bench_calls.py --output after.txt
+
+Only local variables are used, so no database needs to be configured for this script. Run both builds
+on an otherwise idle machine, against the same libyottadb, and repeat each run a few times: differences
+smaller than the spread between repeated runs of the same build are noise.
+"""
+import argparse
+import sys
+import timeit
+
+import _yottadb
+
+
+VARNAME = "benchcalls"
+SUBSARRAY = ("sub1", "sub2")
+
+
+def noop(varname, subsarray=None):
+    return None
+
+
+def setup():
+    _yottadb.delete(VARNAME, delete_type=_yottadb.YDB_DEL_TREE)
+    _yottadb.set(VARNAME, SUBSARRAY, "value")
+    _yottadb.set(VARNAME, ("sub1", "sub3"), "value")
+    _yottadb.set("benchcounter", value="0")
+
+
+BENCHMARKS = (
+    ("python no-op function", lambda: noop(VARNAME, SUBSARRAY)),
+    ("get", lambda: _yottadb.get(VARNAME, SUBSARRAY)),
+    ("get (keywords)", lambda: _yottadb.get(varname=VARNAME, subsarray=SUBSARRAY)),
+    ("set", lambda: _yottadb.set(VARNAME, SUBSARRAY, "value")),
+    ("set (keywords)", lambda: _yottadb.set(varname=VARNAME, subsarray=SUBSARRAY, value="value")),
+    ("data", lambda: _yottadb.data(VARNAME, SUBSARRAY)),
+    ("data (keywords)", lambda: _yottadb.data(varname=VARNAME, subsarray=SUBSARRAY)),
+    ("incr", lambda: _yottadb.incr("benchcounter")),
+    ("incr (keywords)", lambda: _yottadb.incr(varname="benchcounter", increment="1")),
+    ("subscript_next", lambda: _yottadb.subscript_next(VARNAME, SUBSARRAY)),
+    ("subscript_next (keywords)", lambda: _yottadb.subscript_next(varname=VARNAME, subsarray=SUBSARRAY)),
+    ("node_next", lambda: _yottadb.node_next(VARNAME, SUBSARRAY)),
+    ("node_next (keywords)", lambda: _yottadb.node_next(varname=VARNAME, subsarray=SUBSARRAY)),
+    ("str2zwr", lambda: _yottadb.str2zwr("value")),
+    ("str2zwr (keywords)", lambda: _yottadb.str2zwr(input="value")),
+)
+
+
+def run(number: int, repeat: int) -> list:
+    results = []
+    for name, function in BENCHMARKS:
+        # Take the best of several runs to minimize the effect of scheduling noise
+        best = min(timeit.repeat(function, number=number, repeat=repeat))
+        results.append((name, best / number * 1e9))
+    return results
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-n", "--number", type=int, default=200_000, help="calls per timing run (default: %(default)s)")
+    parser.add_argument("-r", "--repeat", type=int, default=5, help="timing runs per operation (default: %(default)s)")
+    parser.add_argument("-o", "--output", help="also write results to this file")
+    args = parser.parse_args()
+
+    setup()
+    lines = [f"{name:<28} {nsec:8.1f} ns/call" for name, nsec in run(args.number, args.repeat)]
+    _yottadb.delete(VARNAME, delete_type=_yottadb.YDB_DEL_TREE)
+    _yottadb.delete("benchcounter")
+
+    output = "\n".join(lines) + "\n"
+    sys.stdout.write(output)
+    if args.output is not None:
+        with open(args.output, "w") as file:
+            file.write(output)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -2,7 +2,7 @@
 #                                                               #
 # Copyright (c) 2019-2021 Peter Goss All rights reserved.       #
 #                                                               #
-# Copyright (c) 2019-2025 YottaDB LLC and/or its subsidiaries.  #
+# Copyright (c) 2019-2026 YottaDB LLC and/or its subsidiaries.  #
 # All rights reserved.                                          #
 #                                                               #
 #   This source code contains the intellectual property         #
@@ -21,11 +21,15 @@ __version__ = "1.1.1"
 __author__ = "YottaDB LLC"
 __credits__ = "Peter Goss"
 
-from typing import Optional, List, Union, Generator, AnyStr, Any, Callable, NewType, Tuple, Mapping
-import copy
+from typing import Optional, List, Union, Generator, AnyStr, Any, Callable, NewType, Tuple, Mapping, Dict, Iterable, IO
 import struct
 from builtins import property
 import sys, os
+import multiprocessing
+import queue
+import decimal
+import re
+import json as json_module
 
 # Need to do future proof name resolution as the encryption plugin tries to
 # resolve symbols in libyottadb.so, and cannot find them unless RTLD_GLOBAL is
@@ -93,22 +97,28 @@ def adjust_stdout_stderr() -> None:
     return _yottadb.adjust_stdout_stderr()
 
 
-def get(varname: AnyStr, subsarray: Tuple[AnyStr] = ()) -> Optional[bytes]:
+def get(varname: AnyStr, subsarray: Tuple[AnyStr] = (), default: Any = None) -> Any:
     """
     Retrieve the value of the local or global variable node specified by the `varname` and `subsarray` pair.
 
     :param varname: A bytes-like object representing a YottaDB local or global variable name.
     :param subsarray: A tuple of bytes-like objects representing an array of YottaDB subscripts.
-    :returns: If the specified node has a value, returns it as a bytes object. If not, returns None.
+    :param default: The value to return if the specified node has no value.
+    :returns: If the specified node has a value, returns it as a bytes object. If not, returns `default`.
     """
-    try:
-        return _yottadb.get(varname, subsarray)
-    except YDBError as e:
-        ecode = e.code()
-        if _yottadb.YDB_ERR_LVUNDEF == ecode or _yottadb.YDB_ERR_GVUNDEF == ecode:
-            return None
-        else:
-            raise e
+    return _yottadb.get(varname, subsarray, default)
+
+
+def get_many(keys: Iterable[Union[Key, Tuple[AnyStr, Tuple[AnyStr]]]], default: Any = None) -> List[Any]:
+    """
+    Retrieve the values of several local or global variable nodes in a single call.
+
+    :param keys: An iterable of `Key` objects or `(varname, subsarray)` tuples specifying the nodes to retrieve.
+    :param default: The value to return for any of the specified nodes that has no value.
+    :returns: A list of the values of the specified nodes as bytes objects, in the same order as `keys`,
+        with `default` for each node that has no value.
+    """
+    return _yottadb.get_many(keys, default)
 
 
 def set(varname: AnyStr, subsarray: Tuple[AnyStr] = (), value: AnyStr = "") -> None:
@@ -124,6 +134,19 @@ def set(varname: AnyStr, subsarray: Tuple[AnyStr] = (), value: AnyStr = "") -> N
     return None
 
 
+def set_many(pairs: Union[Iterable[Tuple[Union[Key, Tuple[AnyStr, Tuple[AnyStr]]], AnyStr]], Mapping]) -> None:
+    """
+    Set several local or global variable nodes in a single call. The nodes are set in order, so if an
+    error occurs, the nodes preceding the one that caused it will have been set.
+
+    :param pairs: An iterable of `(key, value)` pairs, or a dictionary mapping keys to values, where each key
+        is a `Key` object or a `(varname, subsarray)` tuple and each value is a bytes-like object.
+    :returns: None.
+    """
+    _yottadb.set_many(pairs)
+    return None
+
+
 def ci(routine: AnyStr, args: Tuple[Any] = (), has_retval: bool = False) -> Any:
     """
     Call an M routine specified in a YottaDB call-in table using the specified arguments, if any.
@@ -192,6 +215,124 @@ def release() -> str:
     return "pywr " + "v0.10.0 " + _yottadb.release()
 
 
+def buffer_stats(reset: bool = False) -> Dict[str, int]:
+    """
+    Report statistics on the buffers used to receive values from YottaDB.
+
+    Values are received into a buffer that is reused by each thread and grows to fit the
+    longest value that thread has received. When a value does not fit, the buffer is grown
+    and the YottaDB call is repeated, so once a thread has warmed up, each call should reach
+    the database only once.
+
+    :param reset: If True, reset the retry count to zero after reading it.
+    :returns: A dictionary containing the number of YottaDB calls repeated because a buffer was
+        too short ("invstrlen_retries") and the current size of the calling thread's value buffer
+        ("value_buffer_len").
+    """
+    return _yottadb.buffer_stats(reset)
+
+
+def enable_stats(enable: bool = True) -> None:
+    """
+    Start counting and timing the calls made to YottaDB, as reported by stats() and, for transactions, by tp_stats(), or
+    stop if `enable` is False.
+
+    Each call is timed from just before it enters YottaDB to just after it returns, so that the difference between
+    the time spent in a Python function of this module and the time reported by stats() is spent in the binding.
+    While disabled, the overhead on each call is that of testing a flag.
+
+    :param enable: If True, start counting calls, otherwise stop. The counters are kept either way.
+    :returns: None
+    """
+    return _yottadb.enable_stats(enable)
+
+
+def tp_stats(reset: bool = False) -> Dict[str, Dict[str, int]]:
+    """
+    Report the calls to tp() made while stats were enabled by enable_stats(), for each transid. Calls with no transid
+    are reported under "".
+
+    For each transid, the report holds the number of times callbacks were run ("attempts"), of those that followed a
+    restart, whether requested by the callback or by YottaDB after a conflict ("restarts"), and of transactions rolled
+    back ("rollbacks"), committed ("commits") and failed otherwise ("errors"), as well as the total time in nanoseconds
+    spent in callbacks ("callback_ns") and in YottaDB otherwise, mostly committing transactions ("commit_ns").
+
+    :param reset: If True, reset all counters after reading them.
+    :returns: A dictionary mapping each transid to a dictionary of its counters.
+    """
+    return _yottadb.tp_stats(reset)
+
+
+def enable_trace(threshold_ns: int = 1000000, size: int = 1024, enable: bool = True) -> None:
+    """
+    Start recording the calls made to YottaDB that take at least `threshold_ns` nanoseconds, or stop if `enable` is
+    False. Calls are recorded in a ring buffer of `size` entries, which are returned in bulk by drain_trace(). Once the
+    ring buffer is full, each new call overwrites the oldest one. Changing the size discards the calls recorded so far.
+
+    While disabled, the overhead on each call is that of testing a flag, as for enable_stats().
+
+    :param threshold_ns: The minimum duration of the calls to record, in nanoseconds.
+    :param size: The number of calls that the ring buffer holds.
+    :param enable: If True, start recording calls, otherwise stop. The calls recorded so far are kept either way.
+    :returns: None
+    """
+    return _yottadb.enable_trace(threshold_ns, size, enable)
+
+
+def drain_trace() -> Tuple[List[Dict[str, Any]], int]:
+    """
+    Return the calls recorded as set up by enable_trace() since the last call to this function, emptying the ring buffer.
+
+    Each call is described by a dictionary holding the name of the operation ("op"), e.g. "get", the variable name
+    of the node the call was made on ("varname"), its subscripts as comma-separated ZWR format strings ("subs"), the
+    status returned by YottaDB ("status"), the duration of the call in nanoseconds ("duration_ns") and the wall clock
+    time at which it returned, in nanoseconds since the epoch ("time_ns"). Only the first 128 bytes of subscripts are
+    kept, in which case "subs" ends with "...". Calls not made on a node, e.g. tp(), have an empty "varname" and "subs".
+
+    :returns: A tuple of the list of calls recorded, oldest first, and the number of calls that were overwritten
+        because the ring buffer was full.
+    """
+    return _yottadb.drain_trace()
+
+
+def stats(reset: bool = False) -> Dict[str, Dict[str, Any]]:
+    """
+    Report the calls made to YottaDB while enabled by enable_stats(), for each operation, e.g. "get", "set" or "tp".
+    Operations that were not called are omitted.
+
+    For each operation, the report holds the number of calls ("calls"), of failed calls ("errors"), a dictionary of the
+    number of failed calls by YottaDB error code for up to 8 distinct codes ("statuses"), the number of value bytes passed
+    to and received from YottaDB ("bytes_in" and "bytes_out"), the total time in nanoseconds ("total_ns") and a latency
+    histogram ("latency"). The histogram lists a `(start_ns, end_ns, count)` tuple for each range of durations that at
+    least one call fell into, with ranges four to each power of two of nanoseconds. Note that iteration over a node
+    counts its final YDB_ERR_NODEEND as an error, and a tp() call includes the time spent in its callback.
+
+    :param reset: If True, reset all counters to zero after reading them.
+    :returns: A dictionary mapping the name of each operation called to a dictionary of its counters.
+    """
+    return _yottadb.stats(reset)
+
+
+def enable_threads() -> None:
+    """
+    Switch to the threaded API of YottaDB for all subsequent calls. The Python Global Interpreter Lock (GIL)
+    is then released for the duration of each call to YottaDB, so that other Python threads keep running while
+    one waits on the database, e.g. on a disk read or a lock.
+
+    YottaDB does not allow a process to use both its Simple API and its threaded API, so this function must be
+    called before any other call to YottaDB in the process, e.g. at program startup. In threaded mode, cip() behaves
+    as ci().
+
+    YottaDB runs only one TP transaction at a time in a process: a tp() started in another thread waits until the
+    current transaction commits or rolls back, while threads making calls outside of a transaction keep running.
+    Within a transaction, the calls made by its callback are associated with it through the calling thread, so the
+    callback must not hand work that should take part in the transaction over to other threads.
+
+    :returns: None
+    """
+    return _yottadb.enable_threads()
+
+
 def open_ci_table(filename: AnyStr) -> int:
     """
     Open the YottaDB call-in table at the specified location. Once opened,
@@ -236,6 +377,16 @@ def data(varname: AnyStr, subsarray: Tuple[AnyStr] = ()) -> int:
     return _yottadb.data(varname, subsarray)
 
 
+def data_many(keys: Iterable[Union[Key, Tuple[AnyStr, Tuple[AnyStr]]]]) -> List[int]:
+    """
+    Get the status of several local or global variable nodes in a single call, as reported by `data()`.
+
+    :param keys: An iterable of `Key` objects or `(varname, subsarray)` tuples specifying the nodes to check.
+    :returns: A list of 0, 1, 10, or 11 for each of the specified nodes, in the same order as `keys`.
+    """
+    return _yottadb.data_many(keys)
+
+
 def delete_node(varname: AnyStr, subsarray: Tuple[AnyStr] = ()) -> None:
     """
     Deletes the value at the local or global variable node specified by the `varname` and `subsarray` pair.
@@ -284,6 +435,63 @@ def incr(varname: AnyStr, subsarray: Tuple[AnyStr] = (), increment: Union[int, f
     return _yottadb.incr(varname, subsarray, increment)
 
 
+def incr_many(
+    varname: AnyStr,
+    subscripts: Iterable[Union[AnyStr, Tuple[AnyStr], Tuple[Tuple[AnyStr], Union[int, float, str, bytes]]]],
+    increment: Union[int, float, str, bytes] = "1",
+    return_values: bool = False,
+    in_tp: bool = False,
+    transid: str = "",
+) -> Optional[List[bytes]]:
+    """
+    Increments several nodes of the local or global variable specified by `varname` in a single call.
+
+    :param varname: A bytes-like object representing a YottaDB local or global variable name.
+    :param subscripts: An iterable specifying the nodes to increment. Each item is either a tuple of bytes-like
+        objects representing an array of YottaDB subscripts, a single bytes-like subscript, or a pair of a
+        subscript array and a numeric value specifying the amount by which to increment that node.
+    :param increment: A numeric value specifying the amount by which to increment nodes not paired with their own.
+    :param return_values: Whether to return the new values of the nodes.
+    :param in_tp: Whether to perform all increments in a single transaction, such that either all or none
+        of them take effect.
+    :param transid: The transaction ID to use if `in_tp` is True.
+    :returns: If `return_values` is True, a list of the new values of the nodes as bytes objects, in the same order
+        as `subscripts`. Otherwise, None.
+    """
+    return _yottadb.incr_many(varname, subscripts, increment, return_values, in_tp, transid)
+
+
+def merge(
+    src_key: Union[Key, Tuple[AnyStr, Tuple[AnyStr]]],
+    dst_key: Union[Key, Tuple[AnyStr, Tuple[AnyStr]]],
+    in_tp: bool = False,
+    transid: str = "",
+    chunk_size: int = 0,
+) -> int:
+    """
+    Copies the subtree of the node specified by `src_key` to the node specified by `dst_key`, as done by the M MERGE
+    command. Each node of the source subtree, including its root, is set at the same subscripts relative to the
+    destination node, while any other nodes under the destination are left in place. For example, to snapshot a
+    local variable into a global variable:
+
+        merge(("cart", ()), ("^carts", (user_id,)))
+
+    Merging a node into itself does nothing, while merging it into one of its descendants or ancestors raises a
+    ValueError.
+
+    :param src_key: A `Key` object, or a tuple of a YottaDB local or global variable name and a tuple of subscripts,
+        representing the node to copy.
+    :param dst_key: A `Key` object, or a tuple of a YottaDB local or global variable name and a tuple of subscripts,
+        representing the node to copy to.
+    :param in_tp: Whether to copy the nodes in transactions.
+    :param transid: The transaction ID to use if `in_tp` is True.
+    :param chunk_size: The number of nodes to copy per transaction if `in_tp` is True, so that large subtrees can be
+        merged without exceeding the limits of a single transaction, or 0 to copy the whole subtree in one transaction.
+    :returns: The number of nodes copied.
+    """
+    return _yottadb.merge(src_key, dst_key, in_tp, transid, chunk_size)
+
+
 def subscript_next(varname: AnyStr, subsarray: Tuple[AnyStr] = ()) -> bytes:
     """
     Retrieves the next subscript at the given subscript level of the local or global variable node
@@ -332,6 +540,286 @@ def node_previous(varname: AnyStr, subsarray: Tuple[AnyStr] = ()) -> Tuple[bytes
     return _yottadb.node_previous(varname, subsarray)
 
 
+def scan(
+    varname: AnyStr, subsarray: Tuple[AnyStr] = (), limit: int = 1024, start: Tuple[AnyStr] = None, stop: Tuple[AnyStr] = None
+) -> Tuple[List[Tuple[Tuple[bytes, ...], bytes]], Optional[Tuple[bytes, ...]]]:
+    """
+    Read the nodes of the subtree of the local or global variable node specified by the `varname` and
+    `subsarray` pair in chunks of up to `limit` nodes, retrieving the subscripts and value of each node
+    in a single call. The scan starts at the root of the subtree, or after the node specified by `start`
+    if given, and ends before the node specified by `stop` and its descendants if given. For example:
+
+        start = None
+        while True:
+            nodes, start = scan("^x", ("sub1",), start=start)
+            for subsarray, value in nodes:
+                ...
+            if start is None:
+                break
+
+    :param varname: A bytes-like object representing a YottaDB local or global variable name.
+    :param subsarray: A tuple of bytes-like objects representing an array of YottaDB subscripts.
+    :param limit: The maximum number of nodes to return.
+    :param start: A tuple of bytes-like objects representing the subscript array of the node after
+        which to resume the scan, as returned by a previous call.
+    :param stop: A tuple of bytes-like objects representing the subscript array of a node, before which
+        to end the scan. The node need not exist: the scan ends before the first node at or past it.
+    :returns: A tuple of a list of `(subsarray, value)` pairs, one for each node with a value, and the
+        subscript array to pass as `start` to resume the scan, or None if there are no more nodes.
+    """
+    return _yottadb.scan(varname, subsarray, limit, start, stop)
+
+
+def scan_range(
+    varname: AnyStr,
+    subs_prefix: Tuple[AnyStr] = (),
+    start: AnyStr = None,
+    stop: AnyStr = None,
+    limit: int = 1024,
+    reverse: bool = False,
+    token: AnyStr = None,
+) -> Tuple[List[Tuple[bytes, Optional[bytes]]], Optional[bytes]]:
+    """
+    Page through the subscripts at the level below the local or global variable node specified by the
+    `varname` and `subs_prefix` pair, from `start`, inclusive, to `stop`, exclusive, in YottaDB collation
+    order, e.g. numeric subscripts in numeric order. The bounds need not exist in the database. Each call
+    returns up to `limit` subscripts along with the value of each node, and a continuation token to pass
+    to the next call to get the following page. For example, to read the nodes of a time-based index
+    for a given day:
+
+        token = None
+        while True:
+            page, token = scan_range("^index", ("2024-01-31",), start="09:00", stop="17:00", token=token)
+            for subscript, value in page:
+                ...
+            if token is None:
+                break
+
+    :param varname: A bytes-like object representing a YottaDB local or global variable name.
+    :param subs_prefix: A tuple of bytes-like objects representing an array of YottaDB subscripts.
+    :param start: The first subscript of the range, or None to start at the first subscript of the level.
+    :param stop: The subscript at which the range ends, or None to end at the last subscript of the level.
+    :param limit: The maximum number of subscripts to return.
+    :param reverse: If True, return the subscripts in reverse collation order, from `start` down to `stop`.
+    :param token: The continuation token returned by the previous call, to get the next page of the range.
+    :returns: A tuple of a list of `(subscript, value)` pairs, with a value of None for nodes that only
+        have descendants, and the continuation token, or None if there are no more subscripts in the range.
+    """
+    return _yottadb.scan_range(varname, subs_prefix, start, stop, limit, reverse, token)
+
+
+def export_zwr(varname: AnyStr, subsarray: Tuple[AnyStr], file: Union[int, IO], chunk_size: int = 1 << 20) -> int:
+    """
+    Writes the subtree of the local or global variable node specified by the `varname` and `subsarray` pair to `file`
+    in ZWR format, i.e. one line per node with a value, such as `^g("a",1)="value"`, in YottaDB collation order. The
+    lines are formatted by the `_yottadb` extension into a buffer of `chunk_size` bytes, which is written to the file
+    descriptor of `file` each time it is full, so that the memory used does not depend on the size of the subtree.
+
+    :param varname: A bytes-like object representing a YottaDB local or global variable name.
+    :param subsarray: A tuple of bytes-like objects representing an array of YottaDB subscripts.
+    :param file: A file descriptor, or a file object with a `fileno()` method, which is flushed before writing.
+    :param chunk_size: The size in bytes of the buffer used to write to `file`.
+    :returns: The number of nodes written.
+    """
+    return _yottadb.export_zwr(varname, subsarray, file, chunk_size)
+
+
+def import_zwr(file: Union[int, IO], batch: int = 1000, transid: str = "BATCH") -> int:
+    """
+    Sets the nodes read from `file` in ZWR format, i.e. one line per node such as `^g("a",1)="value"`, as written by
+    `export_zwr()` or MUPIP EXTRACT, whose header lines are skipped. The lines are read and parsed by the `_yottadb`
+    extension, with subscripts and values decoded by `zwr2str()`.
+
+    The nodes are set in transactions of `batch` records each, so that each batch is either set in full or not at all.
+    If a line is invalid or cannot be set, a ValueError or YDBError is raised, and the batches before its own remain set.
+
+    :param file: A file descriptor, or a file object with a `fileno()` method, from whose current position to read.
+        Since the file descriptor is read directly, any data already read into the buffer of a file object is skipped.
+    :param batch: The number of records to set per transaction, or 0 to set them without transactions.
+    :param transid: The transaction ID to use for each transaction. The default, "BATCH", lets transactions
+        commit without waiting for the journal to be written to disk.
+    :returns: The number of nodes set.
+    """
+    return _yottadb.import_zwr(file, batch, transid)
+
+
+def _parallel_scan_worker(index, varname, subsarray, start, stop, limit, fn, results) -> None:
+    try:
+        while True:
+            nodes, start = _yottadb.scan(varname, subsarray, limit, start, stop)
+            if nodes:
+                results.put((True, nodes if fn is None else fn(nodes)))
+            if start is None:
+                break
+    except BaseException as e:
+        results.put((False, e))
+    finally:
+        # The end marker tells parallel_scan() that this worker has sent all of its results
+        results.put(index)
+
+
+# Canonical numbers, which YottaDB collates before all other subscripts if they have few enough significant digits
+_CANONICAL_NUMBER = re.compile(rb"-?(?:[1-9][0-9]*(?:\.[0-9]*[1-9])?|\.[0-9]*[1-9])|0")
+# Maximum number of significant digits of a subscript collated as a number, longer numbers are collated as strings
+_MAX_NUMERIC_SUBSCRIPT_DIGITS = 18
+# Seconds parallel_scan() waits for a result before checking whether any worker process died
+_PARALLEL_SCAN_POLL_INTERVAL = 1.0
+# Number of subscript_next() probes made by parallel_scan() for each range boundary
+_PARALLEL_SCAN_PROBES_PER_BOUNDARY = 8
+
+
+def _collates_as_number(subscript: bytes) -> bool:
+    if not _CANONICAL_NUMBER.fullmatch(subscript):
+        return False
+    return len(subscript.lstrip(b"-").replace(b".", b"").strip(b"0")) <= _MAX_NUMERIC_SUBSCRIPT_DIGITS
+
+
+def _numeric_probes(low: bytes, high: bytes, count: int) -> List[bytes]:
+    # Canonical numbers spread evenly between two others, rounded to fewer digits than YottaDB keeps
+    low_value, high_value = decimal.Decimal(low.decode()), decimal.Decimal(high.decode())
+    probes = []
+    with decimal.localcontext() as context:
+        context.prec = 15
+        for i in range(1, count + 1):
+            probe = format((low_value + (high_value - low_value) * i / (count + 1)).normalize(), "f")
+            if "." in probe:
+                probe = probe.rstrip("0").rstrip(".")
+            probe = probe.replace("-0.", "-.").encode()
+            if probe.startswith(b"0."):
+                probe = probe[1:]
+            if _collates_as_number(probe):
+                probes.append(probe)
+    return probes
+
+
+def _string_probes(low: bytes, high: bytes, count: int) -> List[bytes]:
+    # Strings spread evenly between two others in byte order, interpolated over the first 8 bytes after their common prefix
+    prefix = os.path.commonprefix([low, high])
+    low, high = low[len(prefix) : len(prefix) + 8].ljust(8, b"\0"), high[len(prefix) : len(prefix) + 8].ljust(8, b"\0")
+    low_value, high_value = int.from_bytes(low, "big"), int.from_bytes(high, "big")
+    probes = []
+    for i in range(1, count + 1):
+        probe = prefix + (low_value + (high_value - low_value) * i // (count + 1)).to_bytes(8, "big").rstrip(b"\0")
+        # A probe that looks like a number would be collated with the numbers, out of order
+        if probe and not _collates_as_number(probe):
+            probes.append(probe)
+    return probes
+
+
+def _sample_boundaries(varname: AnyStr, subsarray: Tuple[AnyStr], count: int) -> List[bytes]:
+    """
+    Return up to `count` first-level subscripts of the subtree of the node specified by the `varname` and `subsarray`
+    pair, in collation order and spread over the range of its subscripts, to split it into ranges for parallel_scan().
+
+    Rather than walking every subscript, the range from the first to the last subscript is sampled with a bounded
+    number of subscript_next() calls, from probes spread evenly over it in collation order: numbers for the canonical
+    numbers, which YottaDB collates first, and strings for the others.
+    """
+    first = _yottadb.subscript_next(varname, subsarray + (b"",), None)
+    if first is None or count <= 0:
+        return []
+    last = _yottadb.subscript_previous(varname, subsarray + (b"",), None)
+    # The smallest string subscript, which is collated after all numbers
+    string_start = b"\0"
+    segments = []
+    if _collates_as_number(first):
+        last_number = last
+        if not _collates_as_number(last):
+            last_number = _yottadb.subscript_previous(varname, subsarray + (string_start,))
+        segments.append((_numeric_probes, first, last_number))
+    if not _collates_as_number(last):
+        first_string = first
+        if _collates_as_number(first):
+            first_string = _yottadb.subscript_next(varname, subsarray + (string_start,))
+        segments.append((_string_probes, first_string, last))
+
+    probes_per_segment = count * _PARALLEL_SCAN_PROBES_PER_BOUNDARY // len(segments)
+    samples = []
+    for make_probes, low, high in segments:
+        for probe in make_probes(low, high, probes_per_segment):
+            # Probes are in collation order, so their next subscripts are too, and any duplicates are adjacent
+            sample = _yottadb.subscript_next(varname, subsarray + (probe,), None)
+            if sample is not None and sample != first and (not samples or sample != samples[-1]):
+                samples.append(sample)
+    if len(samples) <= count:
+        return samples
+    return [samples[len(samples) * i // (count + 1)] for i in range(1, count + 1)]
+
+
+def parallel_scan(
+    varname: AnyStr, subsarray: Tuple[AnyStr] = (), workers: int = None, fn: Callable = None, limit: int = 1024
+) -> Generator[Any, None, None]:
+    """
+    Read the nodes of the subtree of the local or global variable node specified by the `varname` and
+    `subsarray` pair using several worker processes, as done by scan(). The first-level subscripts of the
+    subtree are split into up to `workers` ranges at boundaries sampled with a bounded number of calls to
+    subscript_next(), spread evenly over the range of the subscripts in collation order, and each range is
+    scanned by its own process. The ranges are therefore balanced when the subscripts are evenly spread.
+    Each chunk of up to `limit` nodes is passed to `fn` in the worker process, and the results are yielded
+    as they arrive, in no particular order. For example, to count the nodes of a global:
+
+        total = sum(parallel_scan("^x", fn=len))
+
+    Since the results are sent back from the worker processes, `fn` should reduce each chunk to a small
+    result where possible. When the worker processes are not started by forking, `fn` must be picklable.
+    An exception raised in a worker process is raised again here, and RuntimeError is raised if a worker
+    process dies before it has finished its range.
+
+    :param varname: A bytes-like object representing a YottaDB local or global variable name.
+    :param subsarray: A tuple of bytes-like objects representing an array of YottaDB subscripts.
+    :param workers: The number of worker processes to use, by default the number of CPUs.
+    :param fn: A function called with each chunk, a list of `(subsarray, value)` pairs as returned by scan().
+        If None, the chunks themselves are yielded.
+    :param limit: The maximum number of nodes in each chunk.
+    :returns: A generator yielding the result of `fn` for each chunk.
+    """
+    if workers is None:
+        workers = os.cpu_count()
+    if workers <= 0:
+        raise ValueError(f"invalid number of workers {workers}: must be greater than 0")
+    subsarray = tuple(subsarray)
+
+    # Split the first-level subscripts into ranges, each of which starts at one of the boundaries
+    boundaries = _sample_boundaries(varname, subsarray, workers - 1)
+    # Each range is scanned after the last node preceding its boundary, up to the boundary of the next range
+    starts = [None] + [_yottadb.node_previous(varname, subsarray + (boundary,)) for boundary in boundaries]
+    stops = [subsarray + (boundary,) for boundary in boundaries] + [None]
+
+    results = multiprocessing.Queue()
+    processes = [
+        multiprocessing.Process(target=_parallel_scan_worker, args=(index, varname, subsarray, start, stop, limit, fn, results))
+        for index, (start, stop) in enumerate(zip(starts, stops))
+    ]
+    for process in processes:
+        process.start()
+    try:
+        # Indexes of the workers whose end marker has not arrived yet. Note that set() is shadowed by yottadb.set().
+        running = list(range(len(processes)))
+        exited = []
+        while running:
+            try:
+                result = results.get(timeout=_PARALLEL_SCAN_POLL_INTERVAL)
+            except queue.Empty:
+                # A worker that had already exited before this wait would have sent its end marker by now
+                for index in exited:
+                    if index in running:
+                        exitcode = processes[index].exitcode
+                        raise RuntimeError(f"parallel_scan() worker process exited with code {exitcode} before finishing its range")
+                exited = [index for index in running if processes[index].exitcode is not None]
+                continue
+            if isinstance(result, int):
+                running.remove(result)
+            elif result[0]:
+                yield result[1]
+            else:
+                raise result[1]
+    finally:
+        for process in processes:
+            if process.is_alive():
+                process.terminate()
+            process.join()
+
+
 def lock_incr(varname: AnyStr, subsarray: Tuple[AnyStr] = (), timeout_nsec: int = 0) -> None:
     """
     Without releasing any locks held by the process attempt to acquire a lock on the local or global
@@ -381,7 +869,36 @@ def zwr2str(string: AnyStr) -> bytes:
     return _yottadb.zwr2str(string)
 
 
-def tp(callback: object, args: tuple = None, transid: str = "", varnames: Tuple[AnyStr] = None, **kwargs) -> int:
+def str2zwr_many(strings: Iterable[AnyStr]) -> List[bytes]:
+    """
+    Converts each of the given bytes-like objects into YottaDB $ZWRITE format, in a single call to the
+    `_yottadb` extension.
+
+    :param strings: An iterable of bytes-like objects representing arbitrary strings.
+    :returns: A list of bytes-like objects representing each of `strings` in YottaDB $ZWRITE format.
+    """
+    return _yottadb.str2zwr_many(strings)
+
+
+def zwr2str_many(strings: Iterable[AnyStr]) -> List[bytes]:
+    """
+    Converts each of the given bytes-like objects from YottaDB $ZWRITE format into a regular character string,
+    in a single call to the `_yottadb` extension.
+
+    :param strings: An iterable of bytes-like objects representing strings in YottaDB $ZWRITE format.
+    :returns: A list of bytes-like objects representing each of `strings` as a character string.
+    """
+    return _yottadb.zwr2str_many(strings)
+
+
+def tp(
+    callback: object,
+    args: tuple = None,
+    transid: str = "",
+    varnames: Tuple[AnyStr] = None,
+    return_restarts: bool = False,
+    **kwargs,
+) -> Union[int, Tuple[int, int]]:
     """
     Calls the function referenced by `callback` passing it the arguments specified by `args` using YottaDB Transaction Processing.
 
@@ -402,9 +919,12 @@ def tp(callback: object, args: tuple = None, transid: str = "", varnames: Tuple[
         while removing the guarantee of Durability from ACID transactions.
     :param varnames: A tuple of YottaDB local or global variable names to restore to their original values when the
         transaction is restarted
-    :returns: A bytes-like object representing the YottaDB $ZWRITE formatted `string` as a character string.
+    :param return_restarts: If True, also return the number of times the transaction was restarted, whether by the
+        callback or by YottaDB.
+    :returns: YDB_OK once the transaction is committed or, if `return_restarts` is True, a tuple of YDB_OK and the
+        number of restarts.
     """
-    return _yottadb.tp(callback, args, kwargs, transid, varnames)
+    return _yottadb.tp(callback, args, kwargs, transid, varnames, return_restarts)
 
 
 def node_to_dict(key: Tuple[AnyStr, Tuple[AnyStr]], child_subs: List[AnyStr], result: dict) -> Mapping:
@@ -442,7 +962,7 @@ def node_to_dict(key: Tuple[AnyStr, Tuple[AnyStr]], child_subs: List[AnyStr], re
     return result
 
 
-def save_tree(tree: dict, key: Key):
+def save_tree(tree: dict, key: Key, in_tp: bool = False, transid: str = "") -> None:
     """
     Stores data from a nested Python dictionary in YottaDB under the node represented by`key`.
 
@@ -469,19 +989,14 @@ def save_tree(tree: dict, key: Key):
 
     :param tree: A Python dictionary representing a YottaDB tree or subtree.
     :param key: A YottaDB `Key` object representing a YottaDB database node
+    :param in_tp: Whether to store the whole tree in a single transaction, such that other processes
+        never see part of it.
+    :param transid: The transaction ID to use if `in_tp` is True.
     """
-    # Recurse through each key in the dictionary and, when a leaf node is encountered,
-    # store the value in the database.
-    for sub, value in tree.items():
-        if isinstance(value, dict):
-            save_tree(value, key[sub])
-        elif sub == "value":
-            key.value = value
-        else:
-            assert False
+    _yottadb.save_tree(key.varname, key.subsarray, tree, False, in_tp, transid)
 
 
-def replace_tree(tree: dict, key: Key):
+def replace_tree(tree: dict, key: Key, in_tp: bool = False, transid: str = "") -> None:
     """
     Stores data from a nested Python dictionary in YottaDB under the node represented by`key`,
     replacing the existing tree and deleting any pre-existing values from the database that
@@ -510,41 +1025,37 @@ def replace_tree(tree: dict, key: Key):
 
     :param tree: A Python dictionary representing a YottaDB tree or subtree.
     :param key: A YottaDB `Key` object representing a YottaDB database node
+    :param in_tp: Whether to delete the existing tree and store the new one in a single transaction,
+        such that other processes see either the existing tree or the new one, but never a mix of both
+        or a partially written tree.
+    :param transid: The transaction ID to use if `in_tp` is True.
     """
-    key.delete_tree()
-    key.save_tree(tree)
+    _yottadb.save_tree(key.varname, key.subsarray, tree, True, in_tp, transid)
 
 
 def load_tree(key: Key, child_subs: List[AnyStr] = None, result: dict = None, first_call: bool = False) -> dict:
     """
     Converts a `Key` object into a Python dictionary object representing the full YottaDB subtree under the
-    database node specified by `key`.
+    database node specified by `key`. The subtree is read in a single ordered traversal of the database by
+    the `_yottadb` extension, which builds the dictionaries as it goes.
 
     :param key: A `Key` object representing a YottaDB database node.
-    :param child_subs: A list of subscripts describing a child node under the node
-        represented by `key`.
+    :param child_subs: A list of subscripts under which to nest the subtree in `result`.
     :param result: A dictionary object representing a partial YottaDB subtree under the
-        database node specified by `key`. This dictionary is incrementally populated through
-        recursive calls to `load_tree()`. If not supplied, a new dictionary is returned.
-    :param first_call: A flag signalling whether the given call to `load_tree()` is the first
-        of a series of recursive calls to `load_tree()`.
+        database node specified by `key`, to which the subtree is added. If not supplied, a
+        new dictionary is returned.
+    :param first_call: A flag signalling whether to store the value of the node specified
+        by `key` itself in the dictionary.
     :returns: A dictionary object representing the full YottaDB subtree under the
         database node specified by `key`.
     """
     if result is None:
         result = {}
-    if child_subs is None:
-        child_subs = []
-    varname = key.varname
-    subsarray = [] if key.subsarray is None else list(key.subsarray)
-    if first_call and (key.data == 1 or key.data == 11):
-        # Store the value of the root database node before recursively retrieving its
-        # child nodes.
-        result["value"] = key.value.decode("utf-8")
-    for sub in subscripts(varname, subsarray + [""]):
-        sub = sub.decode("utf-8")
-        node_to_dict((varname, subsarray), tuple(child_subs + [sub]), result)
-        load_tree(key[sub], child_subs + [sub], result)
+    # Nest the subtree under the dictionaries of `child_subs`, as done by `node_to_dict()`
+    tree = result
+    for sub in [] if child_subs is None else child_subs:
+        tree = tree.setdefault(sub, {})
+    _yottadb.load_tree(key.varname, key.subsarray, tree, first_call)
     return result
 
 
@@ -583,18 +1094,20 @@ class SubscriptsIter:
 
         :returns: A bytes object representing the next subscript relative to the current local or global variable node.
         """
-        try:
-            if len(self.subsarray) > 0:
-                sub_next = subscript_next(self.varname, self.subsarray)
-                self.subsarray[-1] = sub_next
-            else:
-                # There are no subscripts and this is a variable-level iteration,
-                # so do not modify subsarray (it is empty), but update the variable
-                # name to the next variable instead.
-                sub_next = subscript_next(self.varname)
-                self.varname = sub_next
-        except YDBNodeEnd:
-            raise StopIteration
+        # Pass a default of None to signal the end of the iteration without the cost of raising YDBNodeEnd
+        if len(self.subsarray) > 0:
+            sub_next = _yottadb.subscript_next(self.varname, self.subsarray, None)
+            if sub_next is None:
+                raise StopIteration
+            self.subsarray[-1] = sub_next
+        else:
+            # There are no subscripts and this is a variable-level iteration,
+            # so do not modify subsarray (it is empty), but update the variable
+            # name to the next variable instead.
+            sub_next = _yottadb.subscript_next(self.varname, (), None)
+            if sub_next is None:
+                raise StopIteration
+            self.varname = sub_next
         return sub_next
 
     def __reversed__(self) -> list:
@@ -607,18 +1120,17 @@ class SubscriptsIter:
         """
         result = []
         while True:
-            try:
-                sub_next = subscript_previous(self.varname, self.subsarray)
-                if len(self.subsarray) != 0:
-                    self.subsarray[-1] = sub_next
-                else:
-                    # There are no subscripts and this is a variable-level iteration,
-                    # so do not modify subsarray (it is empty), but update the variable
-                    # name to the next variable instead.
-                    self.varname = sub_next
-                result.append(sub_next)
-            except YDBNodeEnd:
+            sub_next = _yottadb.subscript_previous(self.varname, self.subsarray, None)
+            if sub_next is None:
                 break
+            if len(self.subsarray) != 0:
+                self.subsarray[-1] = sub_next
+            else:
+                # There are no subscripts and this is a variable-level iteration,
+                # so do not modify subsarray (it is empty), but update the variable
+                # name to the next variable instead.
+                self.varname = sub_next
+            result.append(sub_next)
         return result
 
 
@@ -677,10 +1189,10 @@ class NodesIter:
             status = data(self.varname)
             if 0 == len(self.subsarray) and (1 == status or 11 == status):
                 return tuple(self.subsarray)
-        try:
-            self.subsarray = node_next(self.varname, self.subsarray)
-        except YDBNodeEnd:
+        next_subsarray = _yottadb.node_next(self.varname, self.subsarray, None)
+        if next_subsarray is None:
             raise StopIteration
+        self.subsarray = next_subsarray
         return self.subsarray
 
     def __reversed__(self):
@@ -743,19 +1255,20 @@ class NodesIterReversed:
             if 0 < data(self.varname, self.subsarray):
                 self.reversed.append("")
             while not self.initialized:
-                try:
-                    # If there is another subscript level, add its last subscript to the subscript list
-                    self.reversed.insert(len(self.reversed) - 1, subscript_previous(self.varname, self.reversed))
-                except YDBNodeEnd:
+                sub_prev = _yottadb.subscript_previous(self.varname, self.reversed, None)
+                if sub_prev is not None:
+                    # There is another subscript level, so add its last subscript to the subscript list
+                    self.reversed.insert(len(self.reversed) - 1, sub_prev)
+                else:
                     # Remove "" subscript now that the search for the last node is complete
                     self.reversed.pop()
                     self.initialized = True
             return tuple(self.reversed)
 
-        try:
-            self.reversed = node_previous(self.varname, self.reversed)
-        except YDBNodeEnd:
+        prev_subsarray = _yottadb.node_previous(self.varname, self.reversed, None)
+        if prev_subsarray is None:
             raise StopIteration
+        self.reversed = prev_subsarray
 
         return self.reversed
 
@@ -782,57 +1295,23 @@ def nodes(varname: AnyStr, subsarray: Tuple[AnyStr] = ()) -> NodesIter:
     return NodesIter(varname, subsarray)
 
 
-class Key:
+class Key(_yottadb.Key):
     """
     A class that represents a single YottaDB local or global variable node and supplies methods
     for performing various database operations on or relative to that node.
-    """
 
-    name: AnyStr
-    parent: Key
-    next_subsarray: List
+    The node's varname and subscripts are encoded once, when the `Key` is created, and reused by every
+    subsequent operation on it. Since the node a `Key` represents never changes, `Key` objects are hashable
+    and may be used as dictionary keys or set members. Keys are created by passing either a varname and
+    optional subscript array, or a subscript name and a parent `Key`:
 
-    def __init__(self, name: AnyStr, parent: Key = None, subsarray: List = None) -> Key:
-        """
-        Creates a `Key` class object from the local or global variable node specified
-        by the `varname` and `subsarray` pair.
+        Key(name: AnyStr, parent: Key = None, subsarray: List = None)
 
-        :param name: A bytes-like object representing a YottaDB local or global variable name, or subscript name.
-        :param parent: A `Key` object representing a valid YottaDB local or global variable node.
-        :returns: A `Key` object.
-        """
-        if isinstance(name, str) or isinstance(name, bytes):
-            self.name = name
-        else:
-            raise TypeError("'name' must be an instance of str or bytes")
-
-        if subsarray is not None:
-            assert parent is None
-            # Set the parent Key be creating a new key from the recieved variable name
-            # and subscripts by omitting the last subscript from the list received.
-            if len(subsarray) > 1:
-                self.parent = Key(name, subsarray=subsarray[:-1])
-            else:
-                self.parent = Key(name)
-        else:
-            # Set the parent of the Key to the one specified by the caller
-            self.parent = parent
-            if parent is not None:
-                if subsarray is not None:
-                    raise ValueError("Cannot create Key from both a parent key and a subsarray. Please specify one or the other.")
-                if not isinstance(parent, Key):
-                    raise TypeError("'parent' must be of type Key")
-        if _yottadb.YDB_MAX_SUBS < len(self.subsarray):
-            raise ValueError(f"Cannot create Key with {len(self.subsarray)} subscripts (max: {_yottadb.YDB_MAX_SUBS})")
-
-        # Initialize subsarray for use with Key.subscript_next()/Key.subscript_previous() methods
-        if [] == self.subsarray:
-            self.next_subsarray = [""]
-        else:
-            # Shallow copy the subscript array so that it is not mutated by Key.subscript_next()/Key.subscript_previous()
-            self.next_subsarray = copy.copy(self.subsarray)
-            self.next_subsarray.pop()
-            self.next_subsarray.append("")
+    The basic node operations (`get()`, `set()`, `incr()`, `data`, `value`, etc.) are implemented by
+    `_yottadb.Key`. This class adds the higher-level operations built on them.
+    """
+
+    __slots__ = ()
 
     def __repr__(self) -> str:
         """
@@ -840,10 +1319,7 @@ class Key:
 
         :returns: A string representation of the current `Key` object for passage to `eval()`.
         """
-        result = f'{self.__class__.__name__}("{self.varname}")'
-        for subscript in self.subsarray:
-            result += f'["{subscript}"]'
-        return result
+        return f'{self.__class__.__name__}("{self.varname}")' + "".join([f"[{subscript!r}]" for subscript in self.subsarray])
 
     def __str__(self) -> str:
         """
@@ -851,34 +1327,10 @@ class Key:
 
         :returns: A human-readable string representation of the current `Key` object.
         """
-        # Convert to ZWRITE format to allow decoding of binary blobs into `str` objects
-        subscripts = ",".join([str2zwr(sub).decode("ascii") for sub in self.subsarray])
-        if subscripts == "":
+        # Convert to ZWRITE format to allow decoding of binary blobs into `str` objects, all subscripts at once
+        if not self.subsarray:
             return self.varname
-        else:
-            return f"{self.varname}({subscripts})"
-
-    def __setitem__(self, item: AnyStr, value: AnyStr) -> None:
-        """
-        Sets the value of the local or global variable node specified by the current `Key` object with
-        `item` appended to its subscript array to the value specified by `value`. This is done by creating
-        a new `Key` object from the current one in combination with the subscript name specified by `item`.
-
-        :param item: A bytes-like object representing a YottaDB subscript name.
-        :param value: A bytes-like object representing the value of a YottaDB local or global variable node.
-        :returns: None.
-        """
-        Key(name=item, parent=self).value = value
-
-    def __getitem__(self, item):
-        """
-        Creates a new `Key` object representing the local or global variable node specified by the current
-        `Key` object with `item` appended to its subscript array.
-
-        :param item: A bytes-like object representing a YottaDB subscript name.
-        :returns: A new `Key` object.
-        """
-        return Key(name=item, parent=self)
+        return f"{self.varname}({b','.join(_yottadb.str2zwr_many(self.subsarray)).decode('utf-8')})"
 
     def __iadd__(self, num: Union[int, float, str, bytes]) -> Key:
         """
@@ -905,18 +1357,6 @@ class Key:
             self.incr(-int(num))
         return self
 
-    def __eq__(self, other) -> bool:
-        """
-        Evaluates whether the current `Key` object represents the same YottaDB local or global variable name as `other`.
-
-        :param other: A `Key` object representing a valid YottaDB local or global variable node.
-        :returns: True if the two `Key`s represent the same node, or False otherwise.
-        """
-        if isinstance(other, Key):
-            return self.varname == other.varname and self.subsarray == other.subsarray
-        else:
-            return self.value == other
-
     def __iter__(self) -> Generator:
         """
         A Generator that returns the a `Key` object representing the node at the next subscript relative to the local or
@@ -930,12 +1370,11 @@ class Key:
             subscript_subsarray: List[AnyStr] = []
         subscript_subsarray.append("")
         while True:
-            try:
-                sub_next = subscript_next(self.varname, subscript_subsarray)
-                subscript_subsarray[-1] = sub_next
-                yield Key(sub_next, self)
-            except YDBNodeEnd:
+            sub_next = _yottadb.subscript_next(self.varname, subscript_subsarray, None)
+            if sub_next is None:
                 return
+            subscript_subsarray[-1] = sub_next
+            yield Key(sub_next, self)
 
     def __reversed__(self) -> Generator:
         """
@@ -950,111 +1389,11 @@ class Key:
             subscript_subsarray: List[AnyStr] = []
         subscript_subsarray.append("")
         while True:
-            try:
-                sub_next = subscript_previous(self.varname, subscript_subsarray)
-                subscript_subsarray[-1] = sub_next
-                yield Key(sub_next, self)
-            except YDBNodeEnd:
+            sub_next = _yottadb.subscript_previous(self.varname, subscript_subsarray, None)
+            if sub_next is None:
                 return
-
-    def get(self) -> Optional[bytes]:
-        """
-        Retrieve the value of the local or global variable node represented by the current `Key` object.
-
-        :returns: If the specified node has a value, returns it as a bytes object. If not, returns None.
-        """
-        return get(self.varname, self.subsarray)
-
-    def set(self, value: AnyStr = "") -> None:
-        """
-        Set the local or global variable node represented by the current `Key` object.
-
-        :param value: A bytes-like object representing the value of a YottaDB local or global variable node.
-        :returns: None.
-        """
-        return set(self.varname, self.subsarray, value)
-
-    @property
-    def data(self) -> int:
-        """
-        Get the following information about the status of the local or global variable node represented
-        by the current `Key` object.
-
-        0: There is neither a value nor a subtree, i.e., it is undefined.
-        1: There is a value, but no subtree
-        10: There is no value, but there is a subtree.
-        11: There are both a value and a subtree.
-
-        :returns: 0, 1, 10, or 11, representing the various possible statuses of the specified node.
-        """
-        return data(self.varname, self.subsarray)
-
-    def delete_node(self) -> None:
-        """
-        Deletes the value at the local or global variable node represented by the current `Key` object.
-
-        :returns: None.
-        """
-        delete_node(self.varname, self.subsarray)
-
-    def delete_tree(self) -> None:
-        """
-        Deletes the value and any subtree of the local or global variable node represented by the current `Key` object.
-
-        :returns: None.
-        """
-        delete_tree(self.varname, self.subsarray)
-
-    def incr(self, increment: Union[int, float, str, bytes] = "1") -> bytes:
-        """
-        Increments the value of the local or global variable node represented by the current `Key` object
-        by the amount specified by `increment`.
-
-        :param increment: A numeric value specifying the amount by which to increment the given node.
-        :returns: The new value of the node as a bytes object.
-        """
-        # incr() will enforce increment type
-        return incr(self.varname, self.subsarray, increment)
-
-    def subscript_next(self, reset: bool = False) -> bytes:
-        """
-        Iterate over the subscripts at the given subscript level of the local or global variable node
-        represented by the current `Key` object. When all subscripts are exhausted this method will
-        raise `YDBNodeEnd` until the iteration is reset by passing a value of `True` to the `reset`
-        parameter.
-
-        :param reset: A boolean value indicating whether or not to reset subscripts iteration to the original node.
-        :returns: The next subscript at the given subscript level as a bytes object.
-        """
-        if reset:
-            self.next_subsarray.pop()
-            self.next_subsarray.append("")
-
-        next_sub = subscript_next(self.varname, self.next_subsarray)
-        self.next_subsarray.pop()
-        self.next_subsarray.append(next_sub)
-
-        return next_sub
-
-    def subscript_previous(self, reset: bool = False) -> bytes:
-        """
-        Iterate over the subscripts at the given subscript level of the local or global variable node
-        represented by the current `Key` object in reverse order. When all subscripts are exhausted
-        this method will raise `YDBNodeEnd` until the iteration is reset by passing a value of `True` to
-        the `reset` parameter.
-
-        :param reset: A boolean value indicating whether or not to reset subscripts iteration to the original node.
-        :returns: The previous subscript at the given subscript level as a bytes object.
-        """
-        if reset:
-            self.next_subsarray.pop()
-            self.next_subsarray.append("")
-
-        prev_sub = subscript_previous(self.varname, self.next_subsarray)
-        self.next_subsarray.pop()
-        self.next_subsarray.append(prev_sub)
-
-        return prev_sub
+            subscript_subsarray[-1] = sub_next
+            yield Key(sub_next, self)
 
     def lock(self, timeout_nsec: int = 0) -> None:
         """
@@ -1069,32 +1408,10 @@ class Key:
         """
         return lock((self,), timeout_nsec)
 
-    def lock_incr(self, timeout_nsec: int = 0) -> None:
-        """
-        Without releasing any locks held by the process attempt to acquire a lock on the local or global
-        variable node represented by the current `Key` object, incrementing it if already held.
-
-        :param timeout_nsec: The time in nanoseconds that the function waits to acquire the requested lock.
-        :returns: None.
-        """
-        return lock_incr(self.varname, self.subsarray, timeout_nsec)
-
-    def lock_decr(self) -> None:
-        """
-        Decrements the lock count held by the process on the local or global variable node represented by
-        the current `Key` object.
-
-        If the lock count goes from 1 to 0 the lock is released. If the specified lock is not held by the
-        process calling `lock_decr()`, the call is ignored.
-
-        :returns: None.
-        """
-        return lock_decr(self.varname, self.subsarray)
-
     def load_tree(self) -> dict:
         return load_tree(self, first_call=True)
 
-    def save_tree(self, tree: dict, key: Key = None):
+    def save_tree(self, tree: dict, key: Key = None, in_tp: bool = False, transid: str = ""):
         """
         Stores data from a nested Python dictionary in YottaDB. The dictionary must have been previously created using the
         `Key.load_tree()` method, or otherwise match the format used by that method.
@@ -1102,247 +1419,60 @@ class Key:
         :param tree: A Python dictionary representing a YottaDB tree or subtree.
         :param key: A `Key` object representing the YottaDB database node that is the root of the tree
             structure represented by `tree`.
+        :param in_tp: Whether to store the whole tree in a single transaction.
+        :param transid: The transaction ID to use if `in_tp` is True.
         """
         if key is None:
             key = self
-        # Recurse through each key in the dictionary and, when a leaf node is encountered,
-        # store the value in the database.
-        for sub, value in tree.items():
-            if isinstance(value, dict):
-                self.save_tree(value, key[sub])
-            elif sub == "value":
-                key.value = value
-            else:
-                assert False
+        save_tree(tree, key, in_tp, transid)
 
-    def replace_tree(self, tree: dict):
+    def replace_tree(self, tree: dict, in_tp: bool = False, transid: str = ""):
         """
-        Stores data from a nested Python dictionary in YottaDB. The dictionary must have been previously created using the
-        `Key.load_tree()` method, or otherwise match the format used by that method.
+        Stores data from a nested Python dictionary in YottaDB, after deleting the existing subtree. The dictionary must
+        have been previously created using the `Key.load_tree()` method, or otherwise match the format used by that method.
 
         :param tree: A Python dictionary representing a YottaDB tree or subtree.
-        :param key: A `Key` object representing the YottaDB database node that is the root of the tree
-            structure represented by `tree`.
+        :param in_tp: Whether to delete the existing subtree and store the new one in a single transaction, such that
+            other processes never see a partially written tree.
+        :param transid: The transaction ID to use if `in_tp` is True.
         """
-        self.delete_tree()
-        self.save_tree(tree)
+        replace_tree(tree, self, in_tp, transid)
 
     def save_json(self, json: object, key: Key = None):
         """
         Saves JSON data stored in a Python object under the YottaDB node represented by the calling `Key` object.
 
+        Objects are stored with each of their members under a subscript named after the member, and arrays with each
+        of their elements under its index, starting from 1, with a `"\\l"` node marking an empty array. Strings are stored
+        along with a `"\\s"` node, to tell them apart from numbers, booleans and `None`, which are stored as their string
+        representation.
+
         :param self: A YottaDB `Key` object.
-        :param json: A Python object representing a JSON object.
+        :param json: A Python object representing a JSON object, or a bytes-like object containing raw JSON text.
+        :param key: A `Key` object representing the YottaDB database node under which to store the JSON data,
+            instead of the calling `Key` object.
         """
-        # Recurse through each item in the JSON object and,
-        # when a leaf node is encountered, store the value in the database.
         if key is None:
             key = self
-        if isinstance(json, dict):
-            for sub, value in json.items():
-                # There is another level of nested data, continue recursing.
-                self.save_json(value, key[sub])
-        elif isinstance(json, list):
-            # The value is an array, store it in the database piecemeal by index,
-            # starting from 1.
-            if len(json) == 0:
-                key["\\l"].value = ""
-            else:
-                for index, item in enumerate(json, start=1):
-                    i = str(index)
-                    self.save_json(json[index - 1], key[i])
-        else:
-            # No more nested data, save the value in the database.
-            if not isinstance(json, str):
-                json = str(json)
-            else:
-                key["\\s"].value = ""
-            key.value = json
-            # print(f"{key}={key.value}")
+        if isinstance(json, (bytes, bytearray)):
+            json = json_module.loads(json)
+        _yottadb.save_json(key.varname, key.subsarray, json)
 
     def load_json(self, key: Key = None, spaces: str = "") -> object:
         """
-        Retrieves JSON data stored under the YottaDB database node represented by the calling `Key` object,
-        and returns it as a Python object.
+        Retrieves JSON data stored under the YottaDB database node represented by the calling `Key` object by
+        `Key.save_json()`, and returns it as a Python object. The data is read in a single ordered traversal of the
+        database by the `_yottadb` extension.
 
         :param self: A YottaDB `Key` object.
-        :param result: A Python object containing JSON data loaded from the database.
+        :param key: A `Key` object representing the YottaDB database node from which to load the JSON data,
+            instead of the calling `Key` object.
+        :param spaces: Unused, retained for compatibility.
         :returns: A Python object representing a JSON object.
         """
-        result = None
         if key is None:
             key = self
-        # Check whether the current node is a value (i.e. a leaf node), or if it has a subtree.
-        key_status = key.data
-        if key["\\l"].data == 1:
-            # The value is an empty JSON array, so just return an empty list.
-            return []
-        # print(f"{spaces}key_status: {key_status}\t\\s: {slash_s}")
-        if key_status == 10:
-            # The node has a subtree, which represents a JSON array or a JSON object.
-            for index, sub in enumerate(key.subscripts, start=1):
-                sub = sub.decode("utf-8")
-                # print(f"{spaces}{key[sub]}")
-                # print(f"{spaces}index: {index}\tsub: {sub}")
-                if str(index) == sub:
-                    # The subtree represents a JSON array. This is so when the subscripts form a
-                    # series of integers starting from 1, e.g. 1, 2, 3, etc. In that case, treat them
-                    # as indices of a list such that their values or subtrees are elements of a list.
-                    if result is None:
-                        result = []
-                    result.append(self.load_json(key[sub], spaces + "\t"))
-                    # print(f"{spaces}ARRAY: list result: {result}")
-                else:
-                    # The node is a subtree, signifying a nested JSON object must be retrieved.
-                    # If necessary, assign a dictionary to store it, then add the results to the
-                    # dictionary using the current subscript.
-                    if result is None:
-                        result = {}
-                    result[sub] = self.load_json(key[sub], spaces + "\t")
-                    # print(f"{spaces}SUBTREE: {result}")
-        elif key_status == 1 or key_status == 11:
-            # The node is a value and not a subtree. So, retrieve the value, decode it into a Python string,
-            # convert it to an appropriate type, if necessary, then return it to the caller.
-            #
-            # Note that `key_status` may be 11 in the case of a string literal, due to a "\s" node
-            # stored by `Key.save_json()`. In that case, 11 is acceptable.
-            value = key.value.decode("utf-8")
-            # print(f"{spaces}value: {value}")
-            if key["\\s"].data == 1:
-                # A `"\s"` node accompanies the given value, signifying that the value is a string literal.
-                # In that case, no type conversion is necessary.
-                # print(f"{spaces}type: str")
-                return value
-            else:
-                # The value is *not* a string literal and must be converted to the appropriate type. So,
-                # infer the type here and convert accordingly.
-                assert key_status == 1
-                if value == "None":
-                    # print(f"{spaces}type: None")
-                    return None
-                try:
-                    # print(f"{spaces}type: int")
-                    return int(value)
-                except ValueError:
-                    pass
-                try:
-                    # print(f"{spaces}type: float")
-                    return float(value)
-                except ValueError:
-                    pass
-                try:
-                    # print(f"{spaces}type: bool")
-                    return bool(value)
-                except ValueError:
-                    pass
-            # print(f"{spaces}VALUE: {value}")
-            result = value
-        else:
-            # `key_status` should not be 0 since the `Key.save_json()` method
-            # should not have saved any empty nodes.
-            assert False
-
-        # print(f"{spaces}END RESULT: {result}")
-        return result
-
-    @property
-    def varname_key(self) -> Key:
-        """
-        Returns a `Key` object representing the unsubscripted local or global variable the node represented by
-        the current `Key` object falls under.
-
-        :returns: A `Key` object representing an unsubscripted local or global variable.
-        """
-        if self.parent is None:
-            return self
-        ancestor = self.parent
-        while ancestor.parent is not None:
-            ancestor = ancestor.parent
-        return ancestor
-
-    @property
-    def varname(self) -> AnyStr:
-        """
-        Returns the name of the local or global variable the node represented by the current `Key` object
-        falls under.
-
-        :returns: A bytes-like object representing a local or global variable name.
-        """
-        return self.varname_key.name  # str or bytes
-
-    @property
-    def subsarray_keys(self) -> List["Key"]:
-        """
-        Returns a list of all parent `Key`s of the current `Key` object.
-
-        :returns: A list `Key` objects representing all parents nodes of the current `Key` object.
-        """
-        if self.parent is None:
-            return []
-        subs_array = [self]
-        ancestor = self.parent
-        while ancestor.parent is not None:
-            subs_array.insert(0, ancestor)
-            ancestor = ancestor.parent
-        return subs_array
-
-    @property
-    def subsarray(self) -> List[AnyStr]:
-        """
-        Returns the names of all subscripts of the current `Key` object.
-
-        :returns: A list of bytes-like objects representing the names of all subscripts of the current `Key` object.
-        """
-        ret_list = []
-        for key in self.subsarray_keys:
-            ret_list.append(key.name)
-        return ret_list  # Returns List of str or bytes
-
-    @property
-    def value(self) -> Optional[bytes]:
-        """
-        Retrieve the value of the local or global variable node represented by the current `Key` object.
-
-        :returns: If the specified node has a value, returns it as a bytes object. If not, returns None.
-        """
-        return get(self.varname, self.subsarray)
-
-    @value.setter
-    def value(self, value: AnyStr) -> None:
-        """
-        Set the value of the local or global variable node represented by the current `Key` object.
-
-        :param value: A bytes-like object representing the value of a YottaDB local or global variable node.
-        :returns: None.
-        """
-        # Value must be str or bytes
-        set(self.varname, self.subsarray, value)
-
-    @property
-    def has_value(self):
-        """
-        Indicates whether the local or global variable node represented by the current `Key` object
-        has a value or not.
-
-        :returns: `True` if the node has a value, `False` otherwise.
-        """
-        if self.data == YDB_DATA_VALUE_NODESC or self.data == YDB_DATA_VALUE_DESC:
-            return True
-        else:
-            return False
-
-    @property
-    def has_tree(self):
-        """
-        Indicates whether the local or global variable node represented by the current `Key` object
-        has a subtree or not.
-
-        :returns: `True` if the node has a subtree, `False` otherwise.
-        """
-        if self.data == YDB_DATA_NOVALUE_DESC or self.data == YDB_DATA_VALUE_DESC:
-            return True
-        else:
-            return False
+        return _yottadb.load_json(key.varname, key.subsarray)
 
     @property
     def subscripts(self) -> Generator:
@@ -1358,12 +1488,11 @@ class Key:
             subscript_subsarray: List[AnyStr] = []
         subscript_subsarray.append("")
         while True:
-            try:
-                sub_next = subscript_next(self.varname, subscript_subsarray)
-                subscript_subsarray[-1] = sub_next
-                yield sub_next
-            except YDBNodeEnd:
+            sub_next = _yottadb.subscript_next(self.varname, subscript_subsarray, None)
+            if sub_next is None:
                 return
+            subscript_subsarray[-1] = sub_next
+            yield sub_next
 
     """
     def delete_excel(self): ...
@@ -0,0 +1,179 @@
+#################################################################
+#                                                               #
+# Copyright (c) 2026 YottaDB LLC and/or its subsidiaries.       #
+# All rights reserved.                                          #
+#                                                               #
+#   This source code contains the intellectual property         #
+#   of its copyright holder(s), and is made available           #
+#   under a license.  If you do not know the terms of           #
+#   the license, please stop and do not read further.           #
+#                                                               #
+#################################################################
+"""
+asyncio front-end for YDBPython.
+
+Each function of this module returns an awaitable for the result of the YottaDB call of the same name in the
+`yottadb` module. The calls are made by a dedicated worker thread, so that coroutines waiting on the database do not
+block the event loop. Calls issued by an event loop within the same iteration are handed to the worker together,
+which makes them in one pass and then wakes up the event loop once to deliver all of their results.
+
+YottaDB only supports calls from several threads through its threaded API, which also lets the event loop thread run
+other coroutines while the worker waits on YottaDB. The first call to this module therefore switches to the threaded
+API with `yottadb.enable_threads()`, and raises `yottadb.YDBPythonError` if the process has already used the Simple API.
+It is best to call `yottadb.enable_threads()` at program startup.
+"""
+
+import asyncio
+import queue
+import threading
+import weakref
+from typing import Any, AnyStr, Callable, List, Optional, Tuple
+
+import yottadb
+
+# Calls issued by each event loop since its last iteration, as (function, args, future) tuples
+_pending = weakref.WeakKeyDictionary()
+_worker = None
+_worker_lock = threading.Lock()
+
+
+class _Worker:
+    """
+    A thread that makes the YottaDB calls submitted by all event loops. Each batch of calls is taken from a
+    queue.SimpleQueue, which is safe to use from any thread without taking a Python-level lock.
+    """
+
+    def __init__(self):
+        self._batches = queue.SimpleQueue()
+        self._thread = threading.Thread(target=self._run, name="yottadb.aio", daemon=True)
+        self._thread.start()
+
+    def submit(self, loop: asyncio.AbstractEventLoop, batch: List[Tuple[Callable, tuple, asyncio.Future]]) -> None:
+        self._batches.put((loop, batch))
+
+    def _run(self) -> None:
+        while True:
+            loop, batch = self._batches.get()
+            results = []
+            for function, args, future in batch:
+                # Skip calls whose caller has stopped waiting for them
+                if future.cancelled():
+                    continue
+                try:
+                    results.append((future, function(*args), None))
+                except BaseException as e:
+                    # Hand any exception, even KeyboardInterrupt, to the caller, so that the worker keeps serving
+                    results.append((future, None, e))
+            try:
+                loop.call_soon_threadsafe(_complete, results)
+            except RuntimeError:
+                # The event loop was closed while the calls were being made, so nobody is waiting for the results
+                pass
+
+
+def _complete(results: List[Tuple[asyncio.Future, Any, Optional[Exception]]]) -> None:
+    for future, result, exception in results:
+        if future.cancelled():
+            continue
+        if exception is None:
+            future.set_result(result)
+        elif isinstance(exception, StopIteration):
+            # Futures do not accept StopIteration, which asyncio turns into a RuntimeError for coroutines
+            future.set_exception(RuntimeError(repr(exception)))
+        else:
+            future.set_exception(exception)
+
+
+def _start_worker() -> None:
+    global _worker
+
+    with _worker_lock:
+        if _worker is None:
+            # Raises YDBPythonError if the Simple API was already used, and does nothing if threads are already enabled
+            yottadb.enable_threads()
+            _worker = _Worker()
+
+
+def _flush(loop: asyncio.AbstractEventLoop) -> None:
+    _worker.submit(loop, _pending.pop(loop))
+
+
+def _submit(function: Callable, *args) -> asyncio.Future:
+    if _worker is None:
+        _start_worker()
+    loop = asyncio.get_running_loop()
+    future = loop.create_future()
+    batch = _pending.get(loop)
+    if batch is None:
+        # First call in this iteration of the event loop: hand over the batch at the start of the next one
+        batch = _pending[loop] = []
+        loop.call_soon(_flush, loop)
+    batch.append((function, args, future))
+    return future
+
+
+async def get(varname: AnyStr, subsarray: Tuple[AnyStr] = (), default: Any = None) -> Any:
+    """
+    Retrieve the value of the local or global variable node specified by the `varname` and `subsarray` pair.
+
+    :param varname: A bytes-like object representing a YottaDB local or global variable name.
+    :param subsarray: A tuple of bytes-like objects representing an array of YottaDB subscripts.
+    :param default: The value to return if the specified node has no value.
+    :returns: If the specified node has a value, returns it as a bytes object. If not, returns `default`.
+    """
+    return await _submit(yottadb.get, varname, subsarray, default)
+
+
+async def set(varname: AnyStr, subsarray: Tuple[AnyStr] = (), value: AnyStr = "") -> None:
+    """
+    Set the local or global variable node specified by the `varname` and `subsarray` pair.
+
+    :param varname: A bytes-like object representing a YottaDB local or global variable name.
+    :param subsarray: A tuple of bytes-like objects representing an array of YottaDB subscripts.
+    :param value: A bytes-like object representing the value of a YottaDB local or global variable node.
+    :returns: None.
+    """
+    return await _submit(yottadb.set, varname, subsarray, value)
+
+
+async def incr(varname: AnyStr, subsarray: Tuple[AnyStr] = (), increment: Any = "1") -> bytes:
+    """
+    Increment the value of the local or global variable node specified by the `varname` and `subsarray` pair,
+    as done by yottadb.incr().
+
+    :param varname: A bytes-like object representing a YottaDB local or global variable name.
+    :param subsarray: A tuple of bytes-like objects representing an array of YottaDB subscripts.
+    :param increment: The amount by which to increment the node, as an int, float, str or bytes object.
+    :returns: The new value of the node as a bytes object.
+    """
+    return await _submit(yottadb.incr, varname, subsarray, increment)
+
+
+async def data(varname: AnyStr, subsarray: Tuple[AnyStr] = ()) -> int:
+    """
+    Get the following information about the status of the local or global variable node specified
+    by the `varname` and `subsarray` pair, as done by yottadb.data().
+
+    :param varname: A bytes-like object representing a YottaDB local or global variable name.
+    :param subsarray: A tuple of bytes-like objects representing an array of YottaDB subscripts.
+    :returns: 0, 1, 10 or 11, depending on whether the node has a value and whether it has a subtree.
+    """
+    return await _submit(yottadb.data, varname, subsarray)
+
+
+async def scan(
+    varname: AnyStr, subsarray: Tuple[AnyStr] = (), limit: int = 1024, start: Tuple[AnyStr] = None
+) -> Tuple[List[Tuple[Tuple[bytes, ...], bytes]], Optional[Tuple[bytes, ...]]]:
+    """
+    Read up to `limit` nodes of the subtree of the local or global variable node specified by the `varname`
+    and `subsarray` pair, as done by yottadb.scan().
+
+    :param varname: A bytes-like object representing a YottaDB local or global variable name.
+    :param subsarray: A tuple of bytes-like objects representing an array of YottaDB subscripts.
+    :param limit: The maximum number of nodes to return.
+    :param start: A tuple of bytes-like objects representing the subscript array of the node after
+        which to resume the scan, as returned by a previous call.
+    :returns: A tuple of a list of `(subsarray, value)` pairs, one for each node with a value, and the
+        subscript array to pass as `start` to resume the scan, or None if there are no more nodes.
+    """
+    return await _submit(yottadb.scan, varname, subsarray, limit, start)